@@ -45,6 +45,7 @@
 #include <common/buf_rc.h>
 #include <common/copy.h>
 #include <common/dim.h>
+#include <common/stride_eval.h>
 #include <common/function.h>
 
 #include <common/functor_foreach.h>
@@ -0,0 +1,165 @@
+/* Copyright (C) 2017 haniu (niuhao.cn@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef __IEXP_PACKET__
+#define __IEXP_PACKET__
+
+////////////////////////////////////////////////////////////
+// import header files
+////////////////////////////////////////////////////////////
+
+#include <common/common.h>
+
+IEXP_NS_BEGIN
+
+namespace packet {
+
+////////////////////////////////////////////////////////////
+// macro definition
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// type definition
+////////////////////////////////////////////////////////////
+
+// argument of a functor on doubles: the expression itself when its scalar
+// is double, otherwise the expression cast to double
+template <typename T, bool = TYPE_IS(typename T::Scalar, double)>
+struct double_arg
+{
+    using type = T;
+
+    static const T &get(const T &x)
+    {
+        return x;
+    }
+};
+
+template <typename T>
+struct double_arg<T, false>
+{
+    using type =
+        CwiseUnaryOp<internal::scalar_cast_op<typename T::Scalar, double>,
+                     const T>;
+
+    static type get(const T &x)
+    {
+        return type(x);
+    }
+};
+
+////////////////////////////////////////////////////////////
+// global variants
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// interface declaration
+////////////////////////////////////////////////////////////
+
+// eigen 3.3 has no packet comparison, these return, lane by lane,
+// (x < y) ? a : b and (x <= y) ? a : b. a nan in x or y selects b,
+// which is what a scalar "if (x < y)" does
+
+template <typename Packet>
+inline Packet pselect_lt(const Packet &x,
+                         const Packet &y,
+                         const Packet &a,
+                         const Packet &b)
+{
+    using Scalar = typename internal::unpacket_traits<Packet>::type;
+    enum
+    {
+        N = internal::unpacket_traits<Packet>::size
+    };
+
+    Scalar vx[N], vy[N], va[N], vb[N];
+    internal::pstoreu(vx, x);
+    internal::pstoreu(vy, y);
+    internal::pstoreu(va, a);
+    internal::pstoreu(vb, b);
+    for (int i = 0; i < N; ++i) {
+        va[i] = vx[i] < vy[i] ? va[i] : vb[i];
+    }
+    return internal::ploadu<Packet>(va);
+}
+
+template <typename Packet>
+inline Packet pselect_le(const Packet &x,
+                         const Packet &y,
+                         const Packet &a,
+                         const Packet &b)
+{
+    using Scalar = typename internal::unpacket_traits<Packet>::type;
+    enum
+    {
+        N = internal::unpacket_traits<Packet>::size
+    };
+
+    Scalar vx[N], vy[N], va[N], vb[N];
+    internal::pstoreu(vx, x);
+    internal::pstoreu(vy, y);
+    internal::pstoreu(va, a);
+    internal::pstoreu(vb, b);
+    for (int i = 0; i < N; ++i) {
+        va[i] = vx[i] <= vy[i] ? va[i] : vb[i];
+    }
+    return internal::ploadu<Packet>(va);
+}
+
+#ifdef EIGEN_VECTORIZE_SSE2
+inline internal::Packet2d pselect_lt(const internal::Packet2d &x,
+                                     const internal::Packet2d &y,
+                                     const internal::Packet2d &a,
+                                     const internal::Packet2d &b)
+{
+    __m128d m = _mm_cmplt_pd(x, y);
+    return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b));
+}
+
+inline internal::Packet2d pselect_le(const internal::Packet2d &x,
+                                     const internal::Packet2d &y,
+                                     const internal::Packet2d &a,
+                                     const internal::Packet2d &b)
+{
+    __m128d m = _mm_cmple_pd(x, y);
+    return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b));
+}
+#endif
+
+#ifdef EIGEN_VECTORIZE_AVX
+inline internal::Packet4d pselect_lt(const internal::Packet4d &x,
+                                     const internal::Packet4d &y,
+                                     const internal::Packet4d &a,
+                                     const internal::Packet4d &b)
+{
+    return _mm256_blendv_pd(b, a, _mm256_cmp_pd(x, y, _CMP_LT_OQ));
+}
+
+inline internal::Packet4d pselect_le(const internal::Packet4d &x,
+                                     const internal::Packet4d &y,
+                                     const internal::Packet4d &a,
+                                     const internal::Packet4d &b)
+{
+    return _mm256_blendv_pd(b, a, _mm256_cmp_pd(x, y, _CMP_LE_OQ));
+}
+#endif
+}
+
+IEXP_NS_END
+
+#endif /* __IEXP_PACKET__ */
@@ -0,0 +1,138 @@
+/* Copyright (C) 2017 haniu (niuhao.cn@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef __IEXP_PARALLEL__
+#define __IEXP_PARALLEL__
+
+////////////////////////////////////////////////////////////
+// import header files
+////////////////////////////////////////////////////////////
+
+#include <common/common.h>
+
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+IEXP_NS_BEGIN
+
+namespace parallel {
+
+////////////////////////////////////////////////////////////
+// macro definition
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// type definition
+////////////////////////////////////////////////////////////
+
+using task_func = std::function<void(size_t task)>;
+
+////////////////////////////////////////////////////////////
+// global variants
+////////////////////////////////////////////////////////////
+
+inline std::atomic<unsigned int> &concurrency_setting()
+{
+    static std::atomic<unsigned int> s_n(0);
+    return s_n;
+}
+
+////////////////////////////////////////////////////////////
+// interface declaration
+////////////////////////////////////////////////////////////
+
+// number of threads used by parallel algorithms, the hardware
+// concurrency unless set
+inline unsigned int concurrency()
+{
+    unsigned int n = concurrency_setting().load();
+    if (n == 0) {
+        n = std::thread::hardware_concurrency();
+    }
+    return n > 0 ? n : 1;
+}
+
+// 0 restores the default
+inline void concurrency(unsigned int n)
+{
+    concurrency_setting().store(n);
+}
+
+// runs f(0) ... f(n - 1) on up to "thread" threads, the calling thread
+// being one of them. tasks are handed out one by one so uneven tasks are
+// balanced, the first exception thrown by a task is rethrown here after
+// all threads have stopped
+inline void run(size_t n, const task_func &f, unsigned int thread = 0)
+{
+    if (thread == 0) {
+        thread = concurrency();
+    }
+    if (thread > n) {
+        thread = (unsigned int)n;
+    }
+    if (thread <= 1) {
+        for (size_t i = 0; i < n; ++i) {
+            f(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    std::exception_ptr error;
+    std::mutex error_lock;
+    auto worker = [&]() {
+        for (;;) {
+            size_t i = next.fetch_add(1);
+            if (i >= n) {
+                break;
+            }
+            try {
+                f(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> l(error_lock);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                // no more tasks
+                next.store(n);
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(thread - 1);
+    for (unsigned int i = 0; i < thread - 1; ++i) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto &t : pool) {
+        t.join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+}
+
+IEXP_NS_END
+
+#endif /* __IEXP_PARALLEL__ */
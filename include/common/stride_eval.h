@@ -0,0 +1,134 @@
+/* Copyright (C) 2017 haniu (niuhao.cn@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef __IEXP_STRIDE_EVAL__
+#define __IEXP_STRIDE_EVAL__
+
+////////////////////////////////////////////////////////////
+// import header files
+////////////////////////////////////////////////////////////
+
+IEXP_NS_BEGIN
+
+////////////////////////////////////////////////////////////
+// macro definition
+////////////////////////////////////////////////////////////
+
+#define IS_DIRECT_ACCESS(t)                                                    \
+    ((Eigen::internal::traits<t>::Flags & DirectAccessBit) != 0)
+
+////////////////////////////////////////////////////////////
+// type definition
+////////////////////////////////////////////////////////////
+
+// data pointer, element stride and size of an expression, in the layout
+// expected by gsl functions taking (data, stride, n).
+//
+// expressions with direct access whose elements are evenly spaced in
+// memory are not copied: plain objects, maps with inner stride, segments,
+// rows of column major matrices, columns of row major ones and so on.
+// other expressions, including blocks of several rows and columns, are
+// evaluated into a temporary as type_eval would do
+template <typename T, bool direct = IS_DIRECT_ACCESS(T)>
+class stride_eval
+{
+  public:
+    using Scalar = typename T::Scalar;
+
+    stride_eval(const DenseBase<T> &x)
+        : m_data(nullptr)
+        , m_stride(1)
+        , m_size((size_t)x.size())
+    {
+        const T &d = x.derived();
+        Index inner = d.innerSize(), outer = d.outerSize();
+
+        if ((outer <= 1) || (inner <= 1) ||
+            (d.outerStride() == inner * d.innerStride())) {
+            m_data = d.data();
+            m_stride = (size_t)(inner > 1 || outer <= 1 ? d.innerStride()
+                                                        : d.outerStride());
+        } else {
+            m_copy = d;
+            m_data = m_copy.data();
+        }
+    }
+
+    const Scalar *data() const
+    {
+        return m_data;
+    }
+
+    size_t stride() const
+    {
+        return m_stride;
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+  private:
+    const Scalar *m_data;
+    size_t m_stride;
+    size_t m_size;
+    typename T::PlainObject m_copy;
+};
+
+template <typename T>
+class stride_eval<T, false>
+{
+  public:
+    using Scalar = typename T::Scalar;
+
+    stride_eval(const DenseBase<T> &x)
+        : m_x(x.eval())
+    {
+    }
+
+    const Scalar *data() const
+    {
+        return m_x.data();
+    }
+
+    size_t stride() const
+    {
+        return 1;
+    }
+
+    size_t size() const
+    {
+        return (size_t)m_x.size();
+    }
+
+  private:
+    typename type_eval<T>::type m_x;
+};
+
+////////////////////////////////////////////////////////////
+// global variants
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// interface declaration
+////////////////////////////////////////////////////////////
+
+IEXP_NS_END
+
+#endif /* __IEXP_STRIDE_EVAL__ */
@@ -0,0 +1,306 @@
+/* Copyright (C) 2017 haniu (niuhao.cn@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef __IEXP_HIST_BIN__
+#define __IEXP_HIST_BIN__
+
+////////////////////////////////////////////////////////////
+// import header files
+////////////////////////////////////////////////////////////
+
+#include <common/common.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+IEXP_NS_BEGIN
+
+////////////////////////////////////////////////////////////
+// macro definition
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// type definition
+////////////////////////////////////////////////////////////
+
+// bin lookup of one histogram axis.
+//
+// an axis built from (n, min, max) computes the bin arithmetically and
+// corrects it by one against the range array, so that the result is
+// exactly the bin the binary search of gsl would find, rounding of the
+// range array included. other axes fall back to a binary search
+class hist_axis
+{
+  public:
+    // arbitrary ranges
+    hist_axis()
+        : m_n(0)
+        , m_min(0)
+        , m_scale(0)
+    {
+    }
+
+    // n uniform bins over [min, max)
+    hist_axis(size_t n, double min, double max)
+        : m_n(n)
+        , m_min(min)
+        , m_scale(n / (max - min))
+    {
+    }
+
+    bool uniform() const
+    {
+        return m_n > 0;
+    }
+
+    // bin of x in range[0, n], false if x is out of range or nan
+    bool find(const double range[], size_t n, double x, size_t &i) const
+    {
+        if (!(x >= range[0]) || !(x < range[n])) {
+            return false;
+        }
+
+        if (m_n == 0) {
+            i = search(range, n, x);
+            return true;
+        }
+
+        size_t k = (size_t)((x - m_min) * m_scale);
+        if (k >= n) {
+            k = n - 1;
+        }
+        if (x < range[k]) {
+            --k;
+        } else if (x >= range[k + 1]) {
+            ++k;
+        }
+        i = k;
+        return true;
+    }
+
+  private:
+    static size_t search(const double range[], size_t n, double x)
+    {
+        size_t lo = 0, hi = n;
+        while (hi - lo > 1) {
+            size_t mid = (lo + hi) / 2;
+            if (x >= range[mid]) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    size_t m_n;
+    double m_min, m_scale;
+};
+
+// bulk accumulation into a bin array.
+//
+// when a sample lands in the bin of the previous one, its add has to
+// wait for the store of the previous add, which serializes fills of
+// peaked distributions. large fills count into LANE interleaved copies
+// of the bins instead, consecutive samples going to different copies,
+// and sum the copies into the bins at the end
+class hist_lanes
+{
+  public:
+    enum
+    {
+        LANE = 4,
+    };
+
+    // bin[0, n), count being the number of samples to come
+    hist_lanes(double bin[], size_t n, size_t count)
+        : m_bin(bin)
+        , m_n(n)
+        , m_lane(count >= n * LANE ? LANE : 1)
+    {
+        if (m_lane > 1) {
+            m_copy.assign(n * LANE, 0);
+        }
+        m_acc = m_lane > 1 ? m_copy.data() : bin;
+    }
+
+    ~hist_lanes()
+    {
+        if (m_lane > 1) {
+            for (size_t i = 0; i < m_n; ++i) {
+                const double *a = &m_copy[i * LANE];
+                m_bin[i] += (a[0] + a[1]) + (a[2] + a[3]);
+            }
+        }
+    }
+
+    // weight w of the k-th sample in bin i
+    void add(size_t k, size_t i, double w)
+    {
+        m_acc[i * m_lane + (k & (m_lane - 1))] += w;
+    }
+
+  private:
+    hist_lanes(const hist_lanes &) = delete;
+    hist_lanes &operator=(const hist_lanes &) = delete;
+
+    double *m_bin;
+    size_t m_n, m_lane;
+    std::vector<double> m_copy;
+    double *m_acc;
+};
+
+// data and stride of an input of a fill, walked in the storage order of
+// T so that it pairs element by element with a T walked by stride_eval
+template <typename T, typename U>
+class hist_input
+{
+  public:
+    hist_input(const DenseBase<U> &x)
+        : m_eval(x)
+    {
+        if ((x.rows() > 1) && (x.cols() > 1) &&
+            ((T::Flags ^ U::Flags) & RowMajorBit)) {
+            m_copy = x;
+            m_data = m_copy.data();
+            m_stride = 1;
+        } else {
+            m_data = m_eval.data();
+            m_stride = m_eval.stride();
+        }
+    }
+
+    const double *data() const
+    {
+        return m_data;
+    }
+
+    size_t stride() const
+    {
+        return m_stride;
+    }
+
+  private:
+    using Plain = Matrix<double,
+                         Dynamic,
+                         Dynamic,
+                         (T::Flags & RowMajorBit) ? RowMajor : ColMajor>;
+
+    stride_eval<U> m_eval;
+    Plain m_copy;
+    const double *m_data;
+    size_t m_stride;
+};
+
+// alias table of a discrete distribution, built by vose's method.
+//
+// every bin of the table holds a probability and an alias: a uniform
+// picks a bin of the table, and a second comparison picks the bin itself
+// or its alias, in O(1) whatever the number of bins. the fraction of the
+// uniform left after both choices is uniform again and is returned to
+// place the sample inside its bin, so a draw costs one uniform as in
+// gsl_histogram_pdf_sample
+class hist_alias
+{
+  public:
+    // weights w[0, n), non negative and not all zero
+    hist_alias(const double w[], size_t n)
+        : m_entry(n)
+    {
+        double s = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (!(w[i] >= 0)) {
+                RETURN_OR_THROW(std::runtime_error("hist_alias"));
+            }
+            s += w[i];
+        }
+        if (!(s > 0)) {
+            RETURN_OR_THROW(std::runtime_error("hist_alias"));
+        }
+
+        std::vector<double> p(n);
+        std::vector<size_t> small, large;
+        for (size_t i = 0; i < n; ++i) {
+            p[i] = w[i] / s * n;
+            (p[i] < 1 ? small : large).push_back(i);
+        }
+        while (!small.empty() && !large.empty()) {
+            size_t l = small.back(), g = large.back();
+            small.pop_back();
+            m_entry[l].prob = p[l];
+            m_entry[l].alias = g;
+            p[g] = (p[g] + p[l]) - 1;
+            if (p[g] < 1) {
+                large.pop_back();
+                small.push_back(g);
+            }
+        }
+        // left overs are 1 up to rounding
+        for (size_t i : large) {
+            m_entry[i].prob = 1;
+            m_entry[i].alias = i;
+        }
+        for (size_t i : small) {
+            m_entry[i].prob = 1;
+            m_entry[i].alias = i;
+        }
+    }
+
+    // bin drawn by u in [0, 1), t being set to the position in the bin
+    size_t pick(double u, double &t) const
+    {
+        double k = u * m_entry.size();
+        size_t i = std::min((size_t)k, m_entry.size() - 1);
+        double f = k - i;
+
+        const entry &e = m_entry[i];
+        if (f < e.prob) {
+            t = f / e.prob;
+            return i;
+        }
+        t = (f - e.prob) / (1 - e.prob);
+        return e.alias;
+    }
+
+    size_t size() const
+    {
+        return m_entry.size();
+    }
+
+  private:
+    struct entry
+    {
+        double prob;
+        size_t alias;
+    };
+
+    std::vector<entry> m_entry;
+};
+
+////////////////////////////////////////////////////////////
+// global variants
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// interface declaration
+////////////////////////////////////////////////////////////
+
+IEXP_NS_END
+
+#endif /* __IEXP_HIST_BIN__ */
@@ -0,0 +1,261 @@
+/* Copyright (C) 2017 haniu (niuhao.cn@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef __IEXP_HIST_CONCURRENT__
+#define __IEXP_HIST_CONCURRENT__
+
+////////////////////////////////////////////////////////////
+// import header files
+////////////////////////////////////////////////////////////
+
+#include <common/common.h>
+#include <common/parallel.h>
+
+#include <histogram/hist.h>
+#include <histogram/hist2.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+IEXP_NS_BEGIN
+
+////////////////////////////////////////////////////////////
+// macro definition
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// type definition
+////////////////////////////////////////////////////////////
+
+// bins which many threads add to at once.
+//
+// there is no lock: every thread adds to one of several shards of the
+// bins, picked by a per thread number, and bins are atomics updated by
+// compare and swap. threads only contend when they share a shard and hit
+// the same bin at the same time. shards start on cache line boundaries
+// and are padded to whole lines, so no two shards share a line
+class hist_shards
+{
+  public:
+    enum
+    {
+        // doubles per cache line
+        LINE = 8,
+        // bytes per cache line
+        LINE_SIZE = LINE * sizeof(double),
+    };
+
+    // n bins, shard = 0 makes two shards per thread of parallel::run
+    hist_shards(size_t n, size_t shard = 0)
+        : m_n(n)
+        , m_stride((n + LINE - 1) / LINE * LINE)
+        , m_shard(shard > 0 ? shard : 2 * parallel::concurrency())
+        , m_raw(new char[m_stride * m_shard * sizeof(double) + LINE_SIZE])
+    {
+        // new only guarantees the alignment of double
+        uintptr_t p = (uintptr_t)m_raw.get();
+        p = (p + LINE_SIZE - 1) / LINE_SIZE * LINE_SIZE;
+        m_bin = (std::atomic<double> *)p;
+        for (size_t i = 0; i < m_stride * m_shard; ++i) {
+            new (&m_bin[i]) std::atomic<double>(0);
+        }
+    }
+
+    void reset()
+    {
+        for (size_t i = 0; i < m_stride * m_shard; ++i) {
+            m_bin[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void add(size_t i, double w)
+    {
+        std::atomic<double> &b = m_bin[shard() * m_stride + i];
+        double v = b.load(std::memory_order_relaxed);
+        while (!b.compare_exchange_weak(v, v + w, std::memory_order_relaxed)) {
+        }
+    }
+
+    // sum of bin i over shards
+    double get(size_t i) const
+    {
+        double s = 0;
+        for (size_t k = 0; k < m_shard; ++k) {
+            s += m_bin[k * m_stride + i].load(std::memory_order_relaxed);
+        }
+        return s;
+    }
+
+    size_t size() const
+    {
+        return m_n;
+    }
+
+  private:
+    hist_shards(const hist_shards &) = delete;
+    hist_shards &operator=(const hist_shards &) = delete;
+
+    size_t shard() const
+    {
+        static std::atomic<size_t> s_next(0);
+        static thread_local size_t s_id = s_next.fetch_add(1);
+        return s_id % m_shard;
+    }
+
+    size_t m_n, m_stride, m_shard;
+    std::unique_ptr<char[]> m_raw;
+    // m_raw aligned to a cache line
+    std::atomic<double> *m_bin;
+};
+
+// histogram filled by any number of producer threads, e.g.
+//   concurrent_hist c(hist(100, 0, 1));
+//   // in each thread
+//   c << x;
+//   // once producers are done
+//   hist h = c.get();
+// get() may also be called while producers run, the result then misses
+// samples which are being added
+class concurrent_hist
+{
+  public:
+    // bins and ranges of h, its values are ignored
+    concurrent_hist(const hist &h, size_t shard = 0)
+        : m_hist(h)
+        , m_bin(h.size(), shard)
+    {
+        m_hist.reset();
+    }
+
+    concurrent_hist &operator<<(double x)
+    {
+        return add(x);
+    }
+
+    concurrent_hist &add(double x, double weight = 1.0)
+    {
+        size_t i = m_hist.find(x);
+        if (i != (size_t)-1) {
+            m_bin.add(i, weight);
+        }
+        return *this;
+    }
+
+    template <typename T>
+    concurrent_hist &add(const DenseBase<T> &x)
+    {
+        static_assert(TYPE_IS(typename T::Scalar, double),
+                      "must be double type");
+
+        stride_eval<T> m_x(x);
+        for (size_t k = 0; k < m_x.size(); ++k) {
+            add(m_x.data()[k * m_x.stride()]);
+        }
+        return *this;
+    }
+
+    concurrent_hist &reset()
+    {
+        m_bin.reset();
+        return *this;
+    }
+
+    hist get() const
+    {
+        hist h(m_hist);
+        for (size_t i = 0; i < m_bin.size(); ++i) {
+            h.m_gh->bin[i] = m_bin.get(i);
+        }
+        return h;
+    }
+
+  private:
+    hist m_hist;
+    hist_shards m_bin;
+};
+
+class concurrent_hist2
+{
+  public:
+    // bins and ranges of h, its values are ignored
+    concurrent_hist2(const hist2 &h, size_t shard = 0)
+        : m_hist(h)
+        , m_bin(h.xsize() * h.ysize(), shard)
+    {
+        m_hist.reset();
+    }
+
+    concurrent_hist2 &add(double x, double y, double weight = 1.0)
+    {
+        size_t i, j;
+        if (m_hist.find(x, y, i, j)) {
+            m_bin.add(i * m_hist.ysize() + j, weight);
+        }
+        return *this;
+    }
+
+    template <typename T, typename U>
+    concurrent_hist2 &add(const DenseBase<T> &x, const DenseBase<U> &y)
+    {
+        static_assert(TYPE_IS(typename T::Scalar, double),
+                      "T must be double type");
+        static_assert(TYPE_IS(typename U::Scalar, double),
+                      "U must be double type");
+
+        eigen_assert((x.rows() == y.rows()) && (x.cols() == y.cols()));
+        stride_eval<T> m_x(x);
+        hist_input<T, U> m_y(y);
+        for (size_t k = 0; k < m_x.size(); ++k) {
+            add(m_x.data()[k * m_x.stride()], m_y.data()[k * m_y.stride()]);
+        }
+        return *this;
+    }
+
+    concurrent_hist2 &reset()
+    {
+        m_bin.reset();
+        return *this;
+    }
+
+    hist2 get() const
+    {
+        hist2 h(m_hist);
+        for (size_t i = 0; i < m_bin.size(); ++i) {
+            h.m_gh2->bin[i] = m_bin.get(i);
+        }
+        return h;
+    }
+
+  private:
+    hist2 m_hist;
+    hist_shards m_bin;
+};
+
+////////////////////////////////////////////////////////////
+// global variants
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// interface declaration
+////////////////////////////////////////////////////////////
+
+IEXP_NS_END
+
+#endif /* __IEXP_HIST_CONCURRENT__ */
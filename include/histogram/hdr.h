@@ -0,0 +1,378 @@
+/* Copyright (C) 2017 haniu (niuhao.cn@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef __IEXP_HIST_HDR__
+#define __IEXP_HIST_HDR__
+
+////////////////////////////////////////////////////////////
+// import header files
+////////////////////////////////////////////////////////////
+
+#include <common/common.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+IEXP_NS_BEGIN
+
+////////////////////////////////////////////////////////////
+// macro definition
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// type definition
+////////////////////////////////////////////////////////////
+
+// high dynamic range histogram of positive values, e.g. latencies.
+//
+// bins are log-linear: every power of 2 between lowest and highest is
+// split into 2^m equal bins, m being the smallest number of mantissa bits
+// giving the requested significant decimal digits. the bin of a double is
+// its bit pattern without the low 52 - m mantissa bits, minus the one of
+// lowest: exponent and leading mantissa bits in one shift, no search and
+// no logarithm. counts are atomics, so any thread may record at any time
+// without a lock. values below lowest or above highest are counted in
+// the first or last bin, but min() and max() are exact
+class hdr_hist
+{
+  public:
+    hdr_hist(double lowest, double highest, int digits = 3)
+        : m_lowest(lowest)
+        , m_highest(highest)
+        , m_digits(digits)
+    {
+        eigen_assert((lowest > 0) && (highest > lowest));
+        eigen_assert((digits >= 1) && (digits <= 5));
+
+        int bits = (int)std::ceil(digits * std::log2(10.0));
+        m_shift = 52 - bits;
+        m_base = key(lowest);
+        m_size = (size_t)(key(highest) - m_base) + 1;
+        m_count.reset(new std::atomic<uint64_t>[m_size]);
+        reset();
+    }
+
+    hdr_hist(const hdr_hist &h)
+        : hdr_hist(h.m_lowest, h.m_highest, h.m_digits)
+    {
+        merge(h);
+    }
+
+    // the bins of h are taken too, not only its counts
+    hdr_hist &operator=(const hdr_hist &h)
+    {
+        if (&h == this) {
+            return *this;
+        }
+
+        if (!same_bins(h)) {
+            m_shift = h.m_shift;
+            m_base = h.m_base;
+            m_size = h.m_size;
+            m_count.reset(new std::atomic<uint64_t>[m_size]);
+        }
+        m_lowest = h.m_lowest;
+        m_highest = h.m_highest;
+        m_digits = h.m_digits;
+        reset();
+        return merge(h);
+    }
+
+    hdr_hist &reset()
+    {
+        for (size_t i = 0; i < m_size; ++i) {
+            m_count[i].store(0, std::memory_order_relaxed);
+        }
+        m_total.store(0, std::memory_order_relaxed);
+        m_min.store(std::numeric_limits<double>::infinity(),
+                    std::memory_order_relaxed);
+        m_max.store(-std::numeric_limits<double>::infinity(),
+                    std::memory_order_relaxed);
+        return *this;
+    }
+
+    // thread safe, nan is ignored
+    hdr_hist &record(double x, uint64_t n = 1)
+    {
+        if (std::isnan(x)) {
+            return *this;
+        }
+
+        m_count[index(x)].fetch_add(n, std::memory_order_relaxed);
+        m_total.fetch_add(n, std::memory_order_relaxed);
+        update_min(m_min, x);
+        update_max(m_max, x);
+        return *this;
+    }
+
+    hdr_hist &operator<<(double x)
+    {
+        return record(x);
+    }
+
+    template <typename T>
+    hdr_hist &add(const DenseBase<T> &x)
+    {
+        stride_eval<T> m_x(x);
+        const typename T::Scalar *data = m_x.data();
+        for (size_t i = 0; i < m_x.size(); ++i) {
+            record((double)data[i * m_x.stride()]);
+        }
+        return *this;
+    }
+
+    // adds the counts of a histogram of the same bins
+    hdr_hist &merge(const hdr_hist &h)
+    {
+        eigen_assert(same_bins(h));
+
+        for (size_t i = 0; i < m_size; ++i) {
+            uint64_t c = h.m_count[i].load(std::memory_order_relaxed);
+            if (c > 0) {
+                m_count[i].fetch_add(c, std::memory_order_relaxed);
+            }
+        }
+        m_total.fetch_add(h.count(), std::memory_order_relaxed);
+        update_min(m_min, h.m_min.load(std::memory_order_relaxed));
+        update_max(m_max, h.m_max.load(std::memory_order_relaxed));
+        return *this;
+    }
+
+    hdr_hist &operator+=(const hdr_hist &h)
+    {
+        return merge(h);
+    }
+
+    // value at or below which p percent of the recorded values lie, within
+    // the precision of the bins
+    double percentile(double p) const
+    {
+        double r;
+        percentile_impl(&p, 1, &r);
+        return r;
+    }
+
+    // several percentiles from one pass over the bins
+    template <typename T>
+    VectorXd percentile(const DenseBase<T> &p) const
+    {
+        VectorXd m_p = p.derived().template cast<double>(), r(p.size());
+        percentile_impl(m_p.data(), m_p.size(), r.data());
+        return r;
+    }
+
+    double median() const
+    {
+        return percentile(50);
+    }
+
+    uint64_t count() const
+    {
+        return m_total.load(std::memory_order_relaxed);
+    }
+
+    double min() const
+    {
+        return count() > 0 ? m_min.load(std::memory_order_relaxed)
+                           : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    double max() const
+    {
+        return count() > 0 ? m_max.load(std::memory_order_relaxed)
+                           : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    // mean and standard deviation of bin middles
+    double mean() const
+    {
+        double s = 0, n = 0;
+        for (size_t i = 0; i < m_size; ++i) {
+            double c = (double)m_count[i].load(std::memory_order_relaxed);
+            s += c * middle(i);
+            n += c;
+        }
+        return n > 0 ? s / n : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    double std() const
+    {
+        double m = mean(), s = 0, n = 0;
+        for (size_t i = 0; i < m_size; ++i) {
+            double c = (double)m_count[i].load(std::memory_order_relaxed);
+            s += c * (middle(i) - m) * (middle(i) - m);
+            n += c;
+        }
+        return n > 0 ? std::sqrt(s / n)
+                     : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    // range [lower, upper) of bin i
+    void range(size_t i, double &lower, double &upper) const
+    {
+        eigen_assert(i < m_size);
+        lower = value(i);
+        upper = value(i + 1);
+    }
+
+    uint64_t get(size_t i) const
+    {
+        eigen_assert(i < m_size);
+        return m_count[i].load(std::memory_order_relaxed);
+    }
+
+    // bin of x, values out of range going to the first or last bin
+    size_t find(double x) const
+    {
+        return index(x);
+    }
+
+    // number of bins
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    double lowest() const
+    {
+        return m_lowest;
+    }
+
+    double highest() const
+    {
+        return m_highest;
+    }
+
+    int digits() const
+    {
+        return m_digits;
+    }
+
+  private:
+    uint64_t key(double x) const
+    {
+        uint64_t b;
+        std::memcpy(&b, &x, sizeof(b));
+        return b >> m_shift;
+    }
+
+    size_t index(double x) const
+    {
+        if (!(x > m_lowest)) {
+            return 0;
+        }
+        if (x >= m_highest) {
+            return m_size - 1;
+        }
+        return (size_t)(key(x) - m_base);
+    }
+
+    // lower edge of bin i
+    double value(size_t i) const
+    {
+        uint64_t b = (m_base + i) << m_shift;
+        double x;
+        std::memcpy(&x, &b, sizeof(x));
+        return x;
+    }
+
+    double middle(size_t i) const
+    {
+        return (value(i) + value(i + 1)) / 2;
+    }
+
+    bool same_bins(const hdr_hist &h) const
+    {
+        return (m_base == h.m_base) && (m_size == h.m_size) &&
+               (m_shift == h.m_shift);
+    }
+
+    static void update_min(std::atomic<double> &a, double x)
+    {
+        double v = a.load(std::memory_order_relaxed);
+        while ((x < v) &&
+               !a.compare_exchange_weak(v, x, std::memory_order_relaxed)) {
+        }
+    }
+
+    static void update_max(std::atomic<double> &a, double x)
+    {
+        double v = a.load(std::memory_order_relaxed);
+        while ((x > v) &&
+               !a.compare_exchange_weak(v, x, std::memory_order_relaxed)) {
+        }
+    }
+
+    // the upper edge of the bin where the cumulative count reaches p
+    // percent, clamped to the recorded extremes. the last bin also holds
+    // values above highest, so it ends at the maximum
+    void percentile_impl(const double p[], size_t n, double r[]) const
+    {
+        std::vector<size_t> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return p[a] < p[b];
+        });
+
+        uint64_t total = count();
+        double lo = min(), hi = max();
+        uint64_t cum = 0;
+        size_t i = 0;
+        for (size_t k : order) {
+            eigen_assert((p[k] >= 0) && (p[k] <= 100));
+
+            if (total == 0) {
+                r[k] = std::numeric_limits<double>::quiet_NaN();
+                continue;
+            }
+            double t = std::max(1.0, std::ceil(p[k] / 100 * total));
+            while ((double)cum < t && i < m_size) {
+                cum += m_count[i++].load(std::memory_order_relaxed);
+            }
+            r[k] = i < m_size ? std::max(lo, std::min(hi, value(i))) : hi;
+        }
+    }
+
+    double m_lowest, m_highest;
+    int m_digits;
+    int m_shift;
+    uint64_t m_base;
+    size_t m_size;
+    std::unique_ptr<std::atomic<uint64_t>[]> m_count;
+    std::atomic<uint64_t> m_total;
+    std::atomic<double> m_min, m_max;
+};
+
+////////////////////////////////////////////////////////////
+// global variants
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// interface declaration
+////////////////////////////////////////////////////////////
+
+IEXP_NS_END
+
+#endif /* __IEXP_HIST_HDR__ */
@@ -24,9 +24,15 @@
 ////////////////////////////////////////////////////////////
 
 #include <common/common.h>
+#include <common/parallel.h>
+
+#include <histogram/bin.h>
 
 #include <gsl/gsl_histogram.h>
 
+#include <algorithm>
+#include <vector>
+
 IEXP_NS_BEGIN
 
 ////////////////////////////////////////////////////////////
@@ -38,12 +44,26 @@ IEXP_NS_BEGIN
 ////////////////////////////////////////////////////////////
 
 class histpdf;
+class histalias;
+class kde;
+class concurrent_hist;
+class histn;
 
 class hist
 {
     friend class histpdf;
+    friend class histalias;
+    friend class kde;
+    friend class concurrent_hist;
+    friend class histn;
 
   public:
+    enum
+    {
+        // samples per thread below which parallel fills stay serial
+        PARALLEL_SLICE = 1 << 15,
+    };
+
     hist(const double range[], size_t n)
     {
         eigen_assert(n > 1);
@@ -76,7 +96,9 @@ class hist
         gsl_histogram_set_ranges(m_gh, e_r.data(), e_r.size());
     }
 
+    // uniform bins, looked up arithmetically
     hist(size_t n, double min, double max)
+        : m_axis(n, min, max)
     {
         m_gh = gsl_histogram_alloc(n);
         IEXP_NOT_NULLPTR(m_gh);
@@ -85,12 +107,14 @@ class hist
     }
 
     hist(const hist &h)
+        : m_axis(h.m_axis)
     {
         m_gh = gsl_histogram_clone(h.m_gh);
         IEXP_NOT_NULLPTR(m_gh);
     }
 
     hist(hist &&h)
+        : m_axis(h.m_axis)
     {
         m_gh = h.m_gh;
         h.m_gh = nullptr;
@@ -107,6 +131,7 @@ class hist
     {
         eigen_assert(gsl_histogram_bins(m_gh) == gsl_histogram_bins(h.m_gh));
         gsl_histogram_memcpy(m_gh, h.m_gh);
+        m_axis = h.m_axis;
         return *this;
     }
 
@@ -117,6 +142,7 @@ class hist
         }
         m_gh = h.m_gh;
         h.m_gh = nullptr;
+        m_axis = h.m_axis;
         return *this;
     }
 
@@ -133,8 +159,7 @@ class hist
 
     hist &operator<<(double x)
     {
-        gsl_histogram_increment(m_gh, x);
-        return *this;
+        return add(x);
     }
 
     template <typename T>
@@ -204,21 +229,22 @@ class hist
 
     hist &add(double x, double weight = 1.0)
     {
-        gsl_histogram_accumulate(m_gh, x, weight);
+        size_t i;
+        if (m_axis.find(m_gh->range, m_gh->n, x, i)) {
+            m_gh->bin[i] += weight;
+        }
         return *this;
     }
 
+    // samples are read in storage order, see hist_lanes
     template <typename T>
     hist &add(const DenseBase<T> &x)
     {
         static_assert(TYPE_IS(typename T::Scalar, double),
                       "must be double type");
 
-        for (Index i = 0; i < x.rows(); ++i) {
-            for (Index j = 0; j < x.cols(); ++j) {
-                gsl_histogram_accumulate(m_gh, x(i, j), 1.0);
-            }
-        }
+        stride_eval<T> m_x(x);
+        fill(m_x.data(), m_x.stride(), nullptr, 0, m_x.size());
         return *this;
     }
 
@@ -232,11 +258,45 @@ class hist
 
         eigen_assert((x.rows() == weight.rows()) &&
                      (x.cols() == weight.cols()));
-        for (Index i = 0; i < x.rows(); ++i) {
-            for (Index j = 0; j < x.cols(); ++j) {
-                gsl_histogram_accumulate(m_gh, x(i, j), weight(i, j));
-            }
-        }
+        stride_eval<T> m_x(x);
+        hist_input<T, U> m_w(weight);
+        fill(m_x.data(), m_x.stride(), m_w.data(), m_w.stride(), m_x.size());
+        return *this;
+    }
+
+    // fills thread local copies from slices of x on up to "thread"
+    // threads and adds them up
+    template <typename T>
+    hist &add_parallel(const DenseBase<T> &x, unsigned int thread = 0)
+    {
+        static_assert(TYPE_IS(typename T::Scalar, double),
+                      "must be double type");
+
+        stride_eval<T> m_x(x);
+        fill_parallel(m_x.data(), m_x.stride(), nullptr, 0, m_x.size(), thread);
+        return *this;
+    }
+
+    template <typename T, typename U>
+    hist &add_parallel(const DenseBase<T> &x,
+                       const DenseBase<U> &weight,
+                       unsigned int thread = 0)
+    {
+        static_assert(TYPE_IS(typename T::Scalar, double),
+                      "T must be double type");
+        static_assert(TYPE_IS(typename U::Scalar, double),
+                      "U must be double type");
+
+        eigen_assert((x.rows() == weight.rows()) &&
+                     (x.cols() == weight.cols()));
+        stride_eval<T> m_x(x);
+        hist_input<T, U> m_w(weight);
+        fill_parallel(m_x.data(),
+                      m_x.stride(),
+                      m_w.data(),
+                      m_w.stride(),
+                      m_x.size(),
+                      thread);
         return *this;
     }
 
@@ -263,13 +323,8 @@ class hist
 
     size_t find(double x) const
     {
-        try {
-            size_t i;
-            gsl_histogram_find(m_gh, x, &i);
-            return i;
-        } catch (...) {
-            return (size_t)-1;
-        }
+        size_t i;
+        return m_axis.find(m_gh->range, m_gh->n, x, i) ? i : (size_t)-1;
     }
 
     double max_val() const
@@ -308,7 +363,63 @@ class hist
     }
 
   private:
+    void fill(const double x[],
+              size_t xstride,
+              const double w[],
+              size_t wstride,
+              size_t n)
+    {
+        hist_lanes acc(m_gh->bin, m_gh->n, n);
+        for (size_t k = 0; k < n; ++k) {
+            size_t i;
+            if (m_axis.find(m_gh->range, m_gh->n, x[k * xstride], i)) {
+                acc.add(k, i, w != nullptr ? w[k * wstride] : 1);
+            }
+        }
+    }
+
+    void fill_parallel(const double x[],
+                       size_t xstride,
+                       const double w[],
+                       size_t wstride,
+                       size_t n,
+                       unsigned int thread)
+    {
+        if (thread == 0) {
+            thread = parallel::concurrency();
+        }
+        size_t part = std::min<size_t>(thread, n / PARALLEL_SLICE);
+        if (part <= 1) {
+            fill(x, xstride, w, wstride, n);
+            return;
+        }
+
+        std::vector<hist> local;
+        local.reserve(part);
+        for (size_t t = 0; t < part; ++t) {
+            local.emplace_back(*this);
+            local.back().reset();
+        }
+
+        size_t per = (n + part - 1) / part;
+        parallel::run(part,
+                      [&](size_t t) {
+                          size_t b = t * per, m = std::min(per, n - b);
+                          local[t].fill(x + b * xstride,
+                                        xstride,
+                                        w != nullptr ? w + b * wstride
+                                                     : nullptr,
+                                        wstride,
+                                        m);
+                      },
+                      thread);
+        for (const auto &h : local) {
+            *this += h;
+        }
+    }
+
     gsl_histogram *m_gh;
+    hist_axis m_axis;
 };
 
 ////////////////////////////////////////////////////////////
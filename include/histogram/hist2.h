@@ -24,9 +24,15 @@
 ////////////////////////////////////////////////////////////
 
 #include <common/common.h>
+#include <common/parallel.h>
+
+#include <histogram/bin.h>
 
 #include <gsl/gsl_histogram2d.h>
 
+#include <algorithm>
+#include <vector>
+
 IEXP_NS_BEGIN
 
 ////////////////////////////////////////////////////////////
@@ -38,12 +44,26 @@ IEXP_NS_BEGIN
 ////////////////////////////////////////////////////////////
 
 class hist2pdf;
+class hist2alias;
+class kde2;
+class concurrent_hist2;
+class histn;
 
 class hist2
 {
     friend class hist2pdf;
+    friend class hist2alias;
+    friend class kde2;
+    friend class concurrent_hist2;
+    friend class histn;
 
   public:
+    enum
+    {
+        // samples per thread below which parallel fills stay serial
+        PARALLEL_SLICE = 1 << 15,
+    };
+
     hist2(const double xrange[], size_t nx, const double yrange[], size_t ny)
     {
         eigen_assert((nx > 1) && (ny > 1));
@@ -94,6 +114,8 @@ class hist2
           size_t ny,
           double ymin,
           double ymax)
+        : m_xaxis(nx, xmin, xmax)
+        , m_yaxis(ny, ymin, ymax)
     {
         m_gh2 = gsl_histogram2d_alloc(nx, ny);
         IEXP_NOT_NULLPTR(m_gh2);
@@ -102,12 +124,16 @@ class hist2
     }
 
     hist2(const hist2 &h)
+        : m_xaxis(h.m_xaxis)
+        , m_yaxis(h.m_yaxis)
     {
         m_gh2 = gsl_histogram2d_clone(h.m_gh2);
         IEXP_NOT_NULLPTR(m_gh2);
     }
 
     hist2(hist2 &&h)
+        : m_xaxis(h.m_xaxis)
+        , m_yaxis(h.m_yaxis)
     {
         m_gh2 = h.m_gh2;
         h.m_gh2 = nullptr;
@@ -125,6 +151,8 @@ class hist2
         eigen_assert(gsl_histogram2d_nx(m_gh2) == gsl_histogram2d_nx(h.m_gh2));
         eigen_assert(gsl_histogram2d_ny(m_gh2) == gsl_histogram2d_ny(h.m_gh2));
         gsl_histogram2d_memcpy(m_gh2, h.m_gh2);
+        m_xaxis = h.m_xaxis;
+        m_yaxis = h.m_yaxis;
         return *this;
     }
 
@@ -135,6 +163,8 @@ class hist2
         }
         m_gh2 = h.m_gh2;
         h.m_gh2 = nullptr;
+        m_xaxis = h.m_xaxis;
+        m_yaxis = h.m_yaxis;
         return *this;
     }
 
@@ -214,10 +244,14 @@ class hist2
 
     hist2 &add(double x, double y, double weight = 1.0)
     {
-        gsl_histogram2d_accumulate(m_gh2, x, y, weight);
+        size_t i, j;
+        if (find(x, y, i, j)) {
+            m_gh2->bin[i * m_gh2->ny + j] += weight;
+        }
         return *this;
     }
 
+    // samples are read in the storage order of x, see hist_lanes
     template <typename T, typename U>
     hist2 &add(const DenseBase<T> &x, const DenseBase<U> &y)
     {
@@ -227,11 +261,15 @@ class hist2
                       "U must be double type");
 
         eigen_assert((x.rows() == y.rows()) && (x.cols() == y.cols()));
-        for (Index i = 0; i < x.rows(); ++i) {
-            for (Index j = 0; j < x.cols(); ++j) {
-                gsl_histogram2d_accumulate(m_gh2, x(i, j), y(i, j), 1.0);
-            }
-        }
+        stride_eval<T> m_x(x);
+        hist_input<T, U> m_y(y);
+        fill(m_x.data(),
+             m_x.stride(),
+             m_y.data(),
+             m_y.stride(),
+             nullptr,
+             0,
+             m_x.size());
         return *this;
     }
 
@@ -249,14 +287,71 @@ class hist2
 
         eigen_assert(MATRIX_SAME_SIZE(x, y));
         eigen_assert(MATRIX_SAME_SIZE(x, weight));
-        for (Index i = 0; i < x.rows(); ++i) {
-            for (Index j = 0; j < x.cols(); ++j) {
-                gsl_histogram2d_accumulate(m_gh2,
-                                           x(i, j),
-                                           y(i, j),
-                                           weight(i, j));
-            }
-        }
+        stride_eval<T> m_x(x);
+        hist_input<T, U> m_y(y);
+        hist_input<T, V> m_w(weight);
+        fill(m_x.data(),
+             m_x.stride(),
+             m_y.data(),
+             m_y.stride(),
+             m_w.data(),
+             m_w.stride(),
+             m_x.size());
+        return *this;
+    }
+
+    // fills thread local copies from slices of the samples on up to
+    // "thread" threads and adds them up
+    template <typename T, typename U>
+    hist2 &add_parallel(const DenseBase<T> &x,
+                        const DenseBase<U> &y,
+                        unsigned int thread = 0)
+    {
+        static_assert(TYPE_IS(typename T::Scalar, double),
+                      "T must be double type");
+        static_assert(TYPE_IS(typename U::Scalar, double),
+                      "U must be double type");
+
+        eigen_assert((x.rows() == y.rows()) && (x.cols() == y.cols()));
+        stride_eval<T> m_x(x);
+        hist_input<T, U> m_y(y);
+        fill_parallel(m_x.data(),
+                      m_x.stride(),
+                      m_y.data(),
+                      m_y.stride(),
+                      nullptr,
+                      0,
+                      m_x.size(),
+                      thread);
+        return *this;
+    }
+
+    template <typename T, typename U, typename V>
+    hist2 &add_parallel(const DenseBase<T> &x,
+                        const DenseBase<U> &y,
+                        const DenseBase<V> &weight,
+                        unsigned int thread = 0)
+    {
+        static_assert(TYPE_IS(typename T::Scalar, double),
+                      "T must be double type");
+        static_assert(TYPE_IS(typename U::Scalar, double),
+                      "U must be double type");
+        static_assert(TYPE_IS(typename V::Scalar, double),
+                      "V must be double type");
+
+        eigen_assert(MATRIX_SAME_SIZE(x, y));
+        eigen_assert(MATRIX_SAME_SIZE(x, weight));
+        stride_eval<T> m_x(x);
+        hist_input<T, U> m_y(y);
+        hist_input<T, V> m_w(weight);
+        fill_parallel(m_x.data(),
+                      m_x.stride(),
+                      m_y.data(),
+                      m_y.stride(),
+                      m_w.data(),
+                      m_w.stride(),
+                      m_x.size(),
+                      thread);
         return *this;
     }
 
@@ -304,12 +399,8 @@ class hist2
 
     bool find(double x, double y, size_t &i, size_t &j) const
     {
-        try {
-            gsl_histogram2d_find(m_gh2, x, y, &i, &j);
-            return true;
-        } catch (...) {
-            return false;
-        }
+        return m_xaxis.find(m_gh2->xrange, m_gh2->nx, x, i) &&
+               m_yaxis.find(m_gh2->yrange, m_gh2->ny, y, j);
     }
 
     double max_val() const
@@ -363,7 +454,71 @@ class hist2
     }
 
   private:
+    void fill(const double x[],
+              size_t xstride,
+              const double y[],
+              size_t ystride,
+              const double w[],
+              size_t wstride,
+              size_t n)
+    {
+        hist_lanes acc(m_gh2->bin, m_gh2->nx * m_gh2->ny, n);
+        for (size_t k = 0; k < n; ++k) {
+            size_t i, j;
+            if (find(x[k * xstride], y[k * ystride], i, j)) {
+                acc.add(k,
+                        i * m_gh2->ny + j,
+                        w != nullptr ? w[k * wstride] : 1);
+            }
+        }
+    }
+
+    void fill_parallel(const double x[],
+                       size_t xstride,
+                       const double y[],
+                       size_t ystride,
+                       const double w[],
+                       size_t wstride,
+                       size_t n,
+                       unsigned int thread)
+    {
+        if (thread == 0) {
+            thread = parallel::concurrency();
+        }
+        size_t part = std::min<size_t>(thread, n / PARALLEL_SLICE);
+        if (part <= 1) {
+            fill(x, xstride, y, ystride, w, wstride, n);
+            return;
+        }
+
+        std::vector<hist2> local;
+        local.reserve(part);
+        for (size_t t = 0; t < part; ++t) {
+            local.emplace_back(*this);
+            local.back().reset();
+        }
+
+        size_t per = (n + part - 1) / part;
+        parallel::run(part,
+                      [&](size_t t) {
+                          size_t b = t * per, m = std::min(per, n - b);
+                          local[t].fill(x + b * xstride,
+                                        xstride,
+                                        y + b * ystride,
+                                        ystride,
+                                        w != nullptr ? w + b * wstride
+                                                     : nullptr,
+                                        wstride,
+                                        m);
+                      },
+                      thread);
+        for (const auto &h : local) {
+            *this += h;
+        }
+    }
+
     gsl_histogram2d *m_gh2;
+    hist_axis m_xaxis, m_yaxis;
 };
 
 ////////////////////////////////////////////////////////////
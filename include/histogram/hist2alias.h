@@ -0,0 +1,133 @@
+/* Copyright (C) 2017 haniu (niuhao.cn@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef __IEXP_HIST2ALIAS__
+#define __IEXP_HIST2ALIAS__
+
+////////////////////////////////////////////////////////////
+// import header files
+////////////////////////////////////////////////////////////
+
+#include <histogram/bin.h>
+#include <histogram/hist2.h>
+#include <rand/rng.h>
+
+#include <vector>
+
+IEXP_NS_BEGIN
+
+////////////////////////////////////////////////////////////
+// macro definition
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// type definition
+////////////////////////////////////////////////////////////
+
+// samples of the distribution of a 2d histogram, as hist2pdf, drawn
+// through an alias table of all bins in O(1). samples are uniform inside
+// the drawn bin, the first uniform of a draw places x and the second y
+class hist2alias
+{
+  public:
+    hist2alias(const hist2 &h,
+               rand::rng::type type = DEFAULT_RNG_TYPE,
+               unsigned long seed = 0)
+        : m_xrange(h.m_gh2->xrange, h.m_gh2->xrange + h.xsize() + 1)
+        , m_yrange(h.m_gh2->yrange, h.m_gh2->yrange + h.ysize() + 1)
+        , m_alias(h.m_gh2->bin, h.xsize() * h.ysize())
+        , m_rng(type, seed)
+    {
+    }
+
+    hist2alias &seed(unsigned long seed)
+    {
+        m_rng.seed(seed);
+        return *this;
+    }
+
+    hist2alias &next(double &x, double &y)
+    {
+        double u = m_rng.uniform_double();
+        sample(u, m_rng.uniform_double(), x, y);
+        return *this;
+    }
+
+    template <typename T, typename U>
+    hist2alias &next(DenseBase<T> &x, DenseBase<U> &y)
+    {
+        static_assert(TYPE_IS(typename T::Scalar, double),
+                      "T must be double type");
+        static_assert(TYPE_IS(typename U::Scalar, double),
+                      "U must be double type");
+
+        eigen_assert(MATRIX_SAME_SIZE(x, y));
+        for (Index i = 0; i < x.rows(); ++i) {
+            for (Index j = 0; j < x.cols(); ++j) {
+                next(x(i, j), y(i, j));
+            }
+        }
+        return *this;
+    }
+
+    // the uniforms are drawn in two batches into x and y and mapped in
+    // place, so the samples differ from those of next()
+    template <typename T, typename U>
+    hist2alias &fill(DenseBase<T> &x, DenseBase<U> &y)
+    {
+        static_assert(TYPE_IS(typename T::Scalar, double),
+                      "T must be double type");
+        static_assert(TYPE_IS(typename U::Scalar, double),
+                      "U must be double type");
+
+        eigen_assert(MATRIX_SAME_SIZE(x, y));
+        double *xd = x.derived().data(), *yd = y.derived().data();
+        m_rng.uniform_double(xd, x.size());
+        m_rng.uniform_double(yd, y.size());
+        for (Index i = 0; i < x.size(); ++i) {
+            sample(xd[i], yd[i], xd[i], yd[i]);
+        }
+        return *this;
+    }
+
+  private:
+    void sample(double u, double v, double &x, double &y) const
+    {
+        double t;
+        size_t k = m_alias.pick(u, t);
+        size_t i = k / (m_yrange.size() - 1), j = k % (m_yrange.size() - 1);
+        x = m_xrange[i] + t * (m_xrange[i + 1] - m_xrange[i]);
+        y = m_yrange[j] + v * (m_yrange[j + 1] - m_yrange[j]);
+    }
+
+    std::vector<double> m_xrange, m_yrange;
+    hist_alias m_alias;
+    rand::rng m_rng;
+};
+
+////////////////////////////////////////////////////////////
+// global variants
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// interface declaration
+////////////////////////////////////////////////////////////
+
+IEXP_NS_END
+
+#endif /* __IEXP_HIST2ALIAS__ */
@@ -0,0 +1,121 @@
+/* Copyright (C) 2017 haniu (niuhao.cn@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef __IEXP_HISTALIAS__
+#define __IEXP_HISTALIAS__
+
+////////////////////////////////////////////////////////////
+// import header files
+////////////////////////////////////////////////////////////
+
+#include <histogram/bin.h>
+#include <histogram/hist.h>
+#include <rand/rng.h>
+
+#include <vector>
+
+IEXP_NS_BEGIN
+
+////////////////////////////////////////////////////////////
+// macro definition
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// type definition
+////////////////////////////////////////////////////////////
+
+// samples of the distribution of a histogram, as histpdf, drawn through
+// an alias table in O(1) instead of a search of the cumulative sums.
+// samples are uniform inside the drawn bin
+class histalias
+{
+  public:
+    histalias(const hist &h,
+              rand::rng::type type = DEFAULT_RNG_TYPE,
+              unsigned long seed = 0)
+        : m_range(h.m_gh->range, h.m_gh->range + h.size() + 1)
+        , m_alias(h.m_gh->bin, h.size())
+        , m_rng(type, seed)
+    {
+    }
+
+    histalias &seed(unsigned long seed)
+    {
+        m_rng.seed(seed);
+        return *this;
+    }
+
+    double next()
+    {
+        return sample(m_rng.uniform_double());
+    }
+
+    template <typename T>
+    histalias &next(DenseBase<T> &x)
+    {
+        static_assert(TYPE_IS(typename T::Scalar, double),
+                      "must be double type");
+
+        for (Index i = 0; i < x.rows(); ++i) {
+            for (Index j = 0; j < x.cols(); ++j) {
+                x(i, j) = next();
+            }
+        }
+        return *this;
+    }
+
+    // the uniforms are drawn in one batch into x and mapped in place, x
+    // gets the same samples as from next()
+    template <typename T>
+    histalias &fill(DenseBase<T> &x)
+    {
+        static_assert(TYPE_IS(typename T::Scalar, double),
+                      "must be double type");
+
+        double *data = x.derived().data();
+        m_rng.uniform_double(data, x.size());
+        for (Index i = 0; i < x.size(); ++i) {
+            data[i] = sample(data[i]);
+        }
+        return *this;
+    }
+
+  private:
+    double sample(double u) const
+    {
+        double t;
+        size_t i = m_alias.pick(u, t);
+        return m_range[i] + t * (m_range[i + 1] - m_range[i]);
+    }
+
+    std::vector<double> m_range;
+    hist_alias m_alias;
+    rand::rng m_rng;
+};
+
+////////////////////////////////////////////////////////////
+// global variants
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// interface declaration
+////////////////////////////////////////////////////////////
+
+IEXP_NS_END
+
+#endif /* __IEXP_HISTALIAS__ */
@@ -0,0 +1,448 @@
+/* Copyright (C) 2017 haniu (niuhao.cn@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef __IEXP_HISTN__
+#define __IEXP_HISTN__
+
+////////////////////////////////////////////////////////////
+// import header files
+////////////////////////////////////////////////////////////
+
+#include <common/common.h>
+
+#include <histogram/bin.h>
+#include <histogram/hist.h>
+#include <histogram/hist2.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+IEXP_NS_BEGIN
+
+////////////////////////////////////////////////////////////
+// macro definition
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// type definition
+////////////////////////////////////////////////////////////
+
+// ranges of one axis of a histn
+class hist_range
+{
+  public:
+    // n uniform bins with the edges of gsl_histogram_set_ranges_uniform
+    hist_range(size_t n, double min, double max)
+        : m_range(n + 1)
+        , m_axis(n, min, max)
+    {
+        eigen_assert(n > 0);
+        for (size_t i = 0; i <= n; ++i) {
+            m_range[i] = min + ((double)i / n) * (max - min);
+        }
+    }
+
+    hist_range(const std::initializer_list<double> &range)
+        : m_range(range)
+    {
+        eigen_assert(range.size() > 1);
+    }
+
+    template <typename T>
+    hist_range(const DenseBase<T> &range)
+        : m_range((size_t)range.size())
+    {
+        static_assert(TYPE_IS(typename T::Scalar, double),
+                      "must be double type");
+
+        eigen_assert(range.size() > 1);
+        Map<Matrix<double, Dynamic, Dynamic>>(m_range.data(),
+                                              range.rows(),
+                                              range.cols()) = range;
+    }
+
+    bool find(double x, size_t &i) const
+    {
+        return m_axis.find(m_range.data(), size(), x, i);
+    }
+
+    bool uniform() const
+    {
+        return m_axis.uniform();
+    }
+
+    // number of bins
+    size_t size() const
+    {
+        return m_range.size() - 1;
+    }
+
+    const double *data() const
+    {
+        return m_range.data();
+    }
+
+    double min() const
+    {
+        return m_range.front();
+    }
+
+    double max() const
+    {
+        return m_range.back();
+    }
+
+  private:
+    std::vector<double> m_range;
+    hist_axis m_axis;
+};
+
+// sparse n-dimensional histogram.
+//
+// only occupied bins are stored, in an open addressing hash table keyed
+// by the row major index of the bin among all bins, so 6 axes of 100
+// bins cost memory for the bins that are filled, not for 10^12 of them.
+// bins are found axis by axis as in hist. bulk fills take points in the
+// rows of a matrix and bin them column by column in blocks of rows
+class histn
+{
+  public:
+    enum
+    {
+        // points binned together by bulk fills
+        BLOCK = 256,
+        // initial number of slots of the hash table
+        INIT_SLOT = 64,
+    };
+
+    histn(const std::vector<hist_range> &axis)
+        : m_axis(axis)
+        , m_radix(axis.size())
+        , m_count(0)
+    {
+        eigen_assert(!axis.empty());
+
+        // the last key value is the empty slot mark, so the number of
+        // bins must stay below it
+        uint64_t cell = 1;
+        for (size_t k = axis.size(); k-- > 0;) {
+            m_radix[k] = cell;
+            eigen_assert(cell < EMPTY / axis[k].size());
+            cell *= axis[k].size();
+        }
+
+        m_key.assign(INIT_SLOT, EMPTY);
+        m_val.assign(INIT_SLOT, 0);
+    }
+
+    histn(const std::initializer_list<hist_range> &axis)
+        : histn(std::vector<hist_range>(axis))
+    {
+    }
+
+    histn &reset()
+    {
+        std::fill(m_key.begin(), m_key.end(), EMPTY);
+        std::fill(m_val.begin(), m_val.end(), 0);
+        m_count = 0;
+        return *this;
+    }
+
+    // bin of point x[0, dim), false if any coordinate is out of range
+    bool find(const double x[], size_t idx[]) const
+    {
+        for (size_t k = 0; k < m_axis.size(); ++k) {
+            if (!m_axis[k].find(x[k], idx[k])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    histn &add(const double x[], double weight = 1.0)
+    {
+        uint64_t key = 0;
+        for (size_t k = 0; k < m_axis.size(); ++k) {
+            size_t i;
+            if (!m_axis[k].find(x[k], i)) {
+                return *this;
+            }
+            key += i * m_radix[k];
+        }
+        accumulate(key, weight);
+        return *this;
+    }
+
+    // one point per row of x
+    template <typename T>
+    histn &add(const DenseBase<T> &x)
+    {
+        return add_points(x, (const VectorXd *)nullptr);
+    }
+
+    // weight holds one value per row of x
+    template <typename T, typename U>
+    histn &add(const DenseBase<T> &x, const DenseBase<U> &weight)
+    {
+        static_assert(TYPE_IS(typename U::Scalar, double),
+                      "U must be double type");
+
+        eigen_assert(IS_VEC(weight) && (weight.size() == x.rows()));
+        VectorXd m_w = weight.derived();
+        return add_points(x, &m_w);
+    }
+
+    double get(const size_t idx[]) const
+    {
+        uint64_t key = 0;
+        for (size_t k = 0; k < m_axis.size(); ++k) {
+            eigen_assert(idx[k] < m_axis[k].size());
+            key += idx[k] * m_radix[k];
+        }
+
+        size_t mask = m_key.size() - 1;
+        for (size_t s = hash(key) & mask;; s = (s + 1) & mask) {
+            if (m_key[s] == key) {
+                return m_val[s];
+            }
+            if (m_key[s] == EMPTY) {
+                return 0;
+            }
+        }
+    }
+
+    double get(const std::initializer_list<size_t> &idx) const
+    {
+        eigen_assert(idx.size() == m_axis.size());
+        return get(idx.begin());
+    }
+
+    // calls f(idx, value) for each occupied bin, in no particular order
+    template <typename F>
+    void each(F f) const
+    {
+        std::vector<size_t> idx(m_axis.size());
+        for (size_t s = 0; s < m_key.size(); ++s) {
+            if (m_key[s] != EMPTY) {
+                index(m_key[s], idx.data());
+                f((const size_t *)idx.data(), m_val[s]);
+            }
+        }
+    }
+
+    double sum() const
+    {
+        double s = 0;
+        for (size_t i = 0; i < m_key.size(); ++i) {
+            s += m_val[i];
+        }
+        return s;
+    }
+
+    // merges a histogram of the same axes
+    histn &operator+=(const histn &h)
+    {
+        eigen_assert(h.m_radix == m_radix);
+        if (&h == this) {
+            for (auto &v : m_val) {
+                v *= 2;
+            }
+            return *this;
+        }
+
+        for (size_t s = 0; s < h.m_key.size(); ++s) {
+            if (h.m_key[s] != EMPTY) {
+                accumulate(h.m_key[s], h.m_val[s]);
+            }
+        }
+        return *this;
+    }
+
+    // marginal histogram of axis k
+    hist project(size_t k) const
+    {
+        eigen_assert(k < m_axis.size());
+
+        const hist_range &a = m_axis[k];
+        hist h = a.uniform() ? hist(a.size(), a.min(), a.max())
+                             : hist(a.data(), a.size() + 1);
+        each([&](const size_t idx[], double v) {
+            h.m_gh->bin[idx[k]] += v;
+        });
+        return h;
+    }
+
+    // marginal histogram of axes k (x) and l (y)
+    hist2 project(size_t k, size_t l) const
+    {
+        eigen_assert((k < m_axis.size()) && (l < m_axis.size()) && (k != l));
+
+        const hist_range &a = m_axis[k], &b = m_axis[l];
+        hist2 h = a.uniform() && b.uniform()
+                      ? hist2(a.size(),
+                              a.min(),
+                              a.max(),
+                              b.size(),
+                              b.min(),
+                              b.max())
+                      : hist2(a.data(), a.size() + 1, b.data(), b.size() + 1);
+        size_t ny = b.size();
+        each([&](const size_t idx[], double v) {
+            h.m_gh2->bin[idx[k] * ny + idx[l]] += v;
+        });
+        return h;
+    }
+
+    size_t dim() const
+    {
+        return m_axis.size();
+    }
+
+    const hist_range &axis(size_t k) const
+    {
+        eigen_assert(k < m_axis.size());
+        return m_axis[k];
+    }
+
+    // number of occupied bins
+    size_t size() const
+    {
+        return m_count;
+    }
+
+  private:
+    enum : uint64_t
+    {
+        EMPTY = ~(uint64_t)0,
+    };
+
+    // finalizer of splitmix64: keys of neighbour bins are consecutive and
+    // would cluster under linear probing without mixing
+    static size_t hash(uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return (size_t)x;
+    }
+
+    void index(uint64_t key, size_t idx[]) const
+    {
+        for (size_t k = 0; k < m_axis.size(); ++k) {
+            idx[k] = (size_t)(key / m_radix[k]);
+            key %= m_radix[k];
+        }
+    }
+
+    void accumulate(uint64_t key, double w)
+    {
+        // load factor below 1/2
+        if ((m_count + 1) * 2 > m_key.size()) {
+            rehash(m_key.size() * 2);
+        }
+
+        size_t mask = m_key.size() - 1;
+        for (size_t s = hash(key) & mask;; s = (s + 1) & mask) {
+            if (m_key[s] == key) {
+                m_val[s] += w;
+                return;
+            }
+            if (m_key[s] == EMPTY) {
+                m_key[s] = key;
+                m_val[s] = w;
+                ++m_count;
+                return;
+            }
+        }
+    }
+
+    void rehash(size_t slot)
+    {
+        std::vector<uint64_t> key(slot, EMPTY);
+        std::vector<double> val(slot, 0);
+        size_t mask = slot - 1;
+        for (size_t i = 0; i < m_key.size(); ++i) {
+            if (m_key[i] != EMPTY) {
+                size_t s = hash(m_key[i]) & mask;
+                while (key[s] != EMPTY) {
+                    s = (s + 1) & mask;
+                }
+                key[s] = m_key[i];
+                val[s] = m_val[i];
+            }
+        }
+        m_key.swap(key);
+        m_val.swap(val);
+    }
+
+    template <typename T>
+    histn &add_points(const DenseBase<T> &x, const VectorXd *w)
+    {
+        static_assert(TYPE_IS(typename T::Scalar, double),
+                      "T must be double type");
+
+        eigen_assert((size_t)x.cols() == m_axis.size());
+        typename type_eval<T>::type e_x(x.eval());
+
+        uint64_t key[BLOCK];
+        bool in[BLOCK];
+        for (Index b = 0; b < e_x.rows(); b += BLOCK) {
+            Index m = std::min<Index>(BLOCK, e_x.rows() - b);
+            std::fill(key, key + m, 0);
+            std::fill(in, in + m, true);
+            for (size_t k = 0; k < m_axis.size(); ++k) {
+                for (Index r = 0; r < m; ++r) {
+                    size_t i;
+                    if (m_axis[k].find(e_x.coeff(b + r, k), i)) {
+                        key[r] += i * m_radix[k];
+                    } else {
+                        in[r] = false;
+                    }
+                }
+            }
+            for (Index r = 0; r < m; ++r) {
+                if (in[r]) {
+                    accumulate(key[r], w != nullptr ? (*w)[b + r] : 1);
+                }
+            }
+        }
+        return *this;
+    }
+
+    std::vector<hist_range> m_axis;
+    // key of a bin is sum(idx[k] * m_radix[k])
+    std::vector<uint64_t> m_radix;
+    std::vector<uint64_t> m_key;
+    std::vector<double> m_val;
+    size_t m_count;
+};
+
+////////////////////////////////////////////////////////////
+// global variants
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// interface declaration
+////////////////////////////////////////////////////////////
+
+IEXP_NS_END
+
+#endif /* __IEXP_HISTN__ */
@@ -0,0 +1,642 @@
+/* Copyright (C) 2017 haniu (niuhao.cn@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef __IEXP_KDE__
+#define __IEXP_KDE__
+
+////////////////////////////////////////////////////////////
+// import header files
+////////////////////////////////////////////////////////////
+
+#include <common/common.h>
+#include <common/parallel.h>
+
+#include <fft/fftw/plan_cache.h>
+#include <fft/fftw/plan_double.h>
+#include <histogram/hist.h>
+#include <histogram/hist2.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+IEXP_NS_BEGIN
+
+////////////////////////////////////////////////////////////
+// macro definition
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// type definition
+////////////////////////////////////////////////////////////
+
+// gaussian kernel density estimate on evenly spaced points.
+//
+// samples are linearly binned: each one splits its weight between the two
+// nearest points, so the estimate only depends on the binned weights and
+// any number of samples costs one pass plus a convolution over the
+// points. the convolution is a product of r2c transforms of the weights
+// and of the kernel, zero padded so that nothing wraps around. samples
+// outside [min, max] are ignored
+class kde
+{
+  public:
+    enum
+    {
+        // samples per thread below which parallel fills stay serial
+        PARALLEL_SLICE = 1 << 15,
+    };
+
+    // bandwidth selectors: silverman's rule of thumb, or the solve the
+    // equation plug-in of sheather and jones, which suits multimodal data
+    enum class bw
+    {
+        SILVERMAN,
+        SHEATHER_JONES,
+    };
+
+    // n points evenly spaced over [min, max]
+    kde(size_t n, double min, double max)
+        : m_hist(n,
+                 min - (max - min) / (n - 1) / 2,
+                 max + (max - min) / (n - 1) / 2)
+        , m_min(min)
+        , m_step((max - min) / (n - 1))
+    {
+        eigen_assert((n > 1) && (max > min));
+    }
+
+    // weights binned in h, whose bins must be uniform, the points being
+    // the middles of the bins
+    kde(const hist &h)
+        : m_hist(h)
+        , m_min((h.m_gh->range[0] + h.m_gh->range[1]) / 2)
+        , m_step((h.max() - h.min()) / h.size())
+    {
+        eigen_assert((h.size() > 1) && h.m_axis.uniform());
+    }
+
+    kde &reset()
+    {
+        m_hist.reset();
+        return *this;
+    }
+
+    kde &add(double x, double weight = 1.0)
+    {
+        bin(m_hist.m_gh->bin, x, weight);
+        return *this;
+    }
+
+    template <typename T>
+    kde &add(const DenseBase<T> &x)
+    {
+        static_assert(TYPE_IS(typename T::Scalar, double),
+                      "must be double type");
+
+        stride_eval<T> m_x(x);
+        fill(m_hist.m_gh->bin, m_x.data(), m_x.stride(), m_x.size());
+        return *this;
+    }
+
+    template <typename T, typename U>
+    kde &add(const DenseBase<T> &x, const DenseBase<U> &weight)
+    {
+        static_assert(TYPE_IS(typename T::Scalar, double),
+                      "T must be double type");
+        static_assert(TYPE_IS(typename U::Scalar, double),
+                      "U must be double type");
+
+        eigen_assert((x.rows() == weight.rows()) &&
+                     (x.cols() == weight.cols()));
+        stride_eval<T> m_x(x);
+        hist_input<T, U> m_w(weight);
+        for (size_t k = 0; k < m_x.size(); ++k) {
+            bin(m_hist.m_gh->bin,
+                m_x.data()[k * m_x.stride()],
+                m_w.data()[k * m_w.stride()]);
+        }
+        return *this;
+    }
+
+    // binning on up to "thread" threads, each into its own weights
+    template <typename T>
+    kde &add_parallel(const DenseBase<T> &x, unsigned int thread = 0)
+    {
+        static_assert(TYPE_IS(typename T::Scalar, double),
+                      "must be double type");
+
+        stride_eval<T> m_x(x);
+        const double *data = m_x.data();
+        size_t n = m_x.size(), stride = m_x.stride(), bins = size();
+
+        if (thread == 0) {
+            thread = parallel::concurrency();
+        }
+        size_t part = std::min<size_t>(thread, n / PARALLEL_SLICE);
+        if (part <= 1) {
+            fill(m_hist.m_gh->bin, data, stride, n);
+            return *this;
+        }
+
+        std::vector<double> local(part * bins, 0);
+        size_t per = (n + part - 1) / part;
+        parallel::run(part,
+                      [&](size_t t) {
+                          size_t b = t * per, m = std::min(per, n - b);
+                          fill(&local[t * bins], data + b * stride, stride, m);
+                      },
+                      thread);
+        for (size_t t = 0; t < part; ++t) {
+            for (size_t i = 0; i < bins; ++i) {
+                m_hist.m_gh->bin[i] += local[t * bins + i];
+            }
+        }
+        return *this;
+    }
+
+    double bandwidth(bw rule = bw::SILVERMAN) const
+    {
+        return select(m_hist.m_gh->bin, size(), m_step, rule, 1);
+    }
+
+    // density at the points, normalized by the binned weight
+    VectorXd density(double h) const
+    {
+        eigen_assert(h > 0);
+
+        size_t n = size(), l = support(n, h / m_step);
+        size_t m = fft_size(n + l);
+
+        VectorXd c = VectorXd::Zero(m), k = VectorXd::Zero(m);
+        std::copy(m_hist.m_gh->bin, m_hist.m_gh->bin + n, c.data());
+        kernel(k.data(), m, l, h / m_step, m_step);
+
+        VectorXd r = convolve(c, k).head(n).cwiseMax(0);
+        double w = m_hist.sum();
+        return w > 0 ? VectorXd(r / w) : r;
+    }
+
+    VectorXd density(bw rule = bw::SILVERMAN) const
+    {
+        return density(bandwidth(rule));
+    }
+
+    VectorXd points() const
+    {
+        return VectorXd::LinSpaced(size(),
+                                   m_min,
+                                   m_min + m_step * (size() - 1));
+    }
+
+    // binned weights
+    const hist &binned() const
+    {
+        return m_hist;
+    }
+
+    size_t size() const
+    {
+        return m_hist.size();
+    }
+
+  private:
+    friend class kde2;
+
+    // linear binning onto points min + i * step, i in [0, n)
+    static void bin(double c[],
+                    size_t n,
+                    double min,
+                    double scale,
+                    double x,
+                    double w)
+    {
+        double t = (x - min) * scale;
+        if (!(t >= 0) || !(t <= n - 1)) {
+            return;
+        }
+        size_t i = std::min((size_t)t, n - 2);
+        double f = t - i;
+        c[i] += w * (1 - f);
+        c[i + 1] += w * f;
+    }
+
+    void bin(double c[], double x, double w) const
+    {
+        bin(c, size(), m_min, 1 / m_step, x, w);
+    }
+
+    void fill(double c[], const double x[], size_t stride, size_t n) const
+    {
+        size_t bins = size();
+        double scale = 1 / m_step;
+        for (size_t k = 0; k < n; ++k) {
+            bin(c, bins, m_min, scale, x[k * stride], 1);
+        }
+    }
+
+    // kernel half width in points for a bandwidth of h points
+    static size_t support(size_t n, double h)
+    {
+        return std::min<size_t>(n - 1, (size_t)std::ceil(6 * h));
+    }
+
+    // smallest 2^i * {1, 3, 5} not below n
+    static size_t fft_size(size_t n)
+    {
+        size_t best = (size_t)-1;
+        for (size_t f : {1, 3, 5}) {
+            size_t m = f;
+            while (m < n) {
+                m *= 2;
+            }
+            best = std::min(best, m);
+        }
+        return best;
+    }
+
+    // gaussian of h points on [-l, l] wrapped into k[0, m), scaled to
+    // integrate to 1 over steps of "step" even when h is below a point
+    static void kernel(double k[], size_t m, size_t l, double h, double step)
+    {
+        double s = 0;
+        for (size_t j = 0; j <= l; ++j) {
+            double u = j / h;
+            k[j] = std::exp(-u * u / 2);
+            s += j > 0 ? 2 * k[j] : k[j];
+        }
+        for (size_t j = 0; j <= l; ++j) {
+            k[j] /= s * step;
+        }
+        for (size_t j = 1; j <= l; ++j) {
+            k[m - j] = k[j];
+        }
+    }
+
+    // circular convolution of a and b through r2c and c2r plans
+    static VectorXd convolve(VectorXd &a, VectorXd &b)
+    {
+        int m = (int)a.size();
+        VectorXcd fa(m / 2 + 1), fb(m / 2 + 1);
+        fftw3::get_plan(m, a.data(), fa.data(), true)
+            .fwd(m, a.data(), fa.data());
+        fftw3::get_plan(m, b.data(), fb.data(), true)
+            .fwd(m, b.data(), fb.data());
+        fa.array() *= fb.array() / (double)m;
+
+        VectorXd r(m);
+        fftw3::get_plan(m, fa.data(), r.data(), false)
+            .inv(m, fa.data(), r.data());
+        return r;
+    }
+
+    // bandwidth of binned weights c[0, n), on points step apart, for a
+    // product kernel of dim dimensions
+    static double select(const double c[],
+                         size_t n,
+                         double step,
+                         bw rule,
+                         int dim)
+    {
+        double w = 0, mean = 0, m2 = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (c[i] > 0) {
+                w += c[i];
+                double d = i * step - mean;
+                mean += d * c[i] / w;
+                m2 += c[i] * d * (i * step - mean);
+            }
+        }
+        double sd = w > 0 ? std::sqrt(m2 / w) : 0;
+        double iqr = quantile(c, n, w, 0.75) - quantile(c, n, w, 0.25);
+        double scale = std::min(sd, iqr * step / 1.349);
+        if (!(scale > 0)) {
+            scale = sd > 0 ? sd : step;
+        }
+        if (!(w > 1)) {
+            return scale;
+        }
+
+        // normal reference in dim dimensions
+        double h = dim == 1 ? 0.9 * scale * std::pow(w, -0.2)
+                            : scale * std::pow(w, -1.0 / (dim + 4));
+        if (rule == bw::SHEATHER_JONES) {
+            double sj = sheather_jones(c, n, step, w, scale);
+            if (std::isfinite(sj) && (sj > 0)) {
+                h = sj * std::pow(w, 0.2 - 1.0 / (dim + 4));
+            }
+        }
+        return h;
+    }
+
+    // position in points where the cumulative weight reaches q, each
+    // weight being spread over the half steps around its point
+    static double quantile(const double c[], size_t n, double w, double q)
+    {
+        double s = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if ((s + c[i] >= q * w) && (c[i] > 0)) {
+                return i - 0.5 + (q * w - s) / c[i];
+            }
+            s += c[i];
+        }
+        return (double)(n - 1);
+    }
+
+    // solve the equation bandwidth, as bw.SJ(method = "ste") of r, with
+    // the density functionals estimated from the binned weights: the
+    // autocorrelation of the weights is computed once by fft and each
+    // functional is then a sum over lags
+    static double sheather_jones(const double c[],
+                                 size_t n,
+                                 double step,
+                                 double w,
+                                 double scale)
+    {
+        size_t m = fft_size(2 * n);
+        VectorXd a = VectorXd::Zero(m);
+        std::copy(c, c + n, a.data());
+        VectorXcd fa(m / 2 + 1);
+        fftw3::get_plan((int)m, a.data(), fa.data(), true)
+            .fwd((int)m, a.data(), fa.data());
+        fa = fa.cwiseAbs2().cast<std::complex<double>>() / (double)m;
+        VectorXd lag(m);
+        fftw3::get_plan((int)m, fa.data(), lag.data(), false)
+            .inv((int)m, fa.data(), lag.data());
+
+        // estimate of the integral of the squared r/2-th derivative,
+        // r being 4 or 6
+        auto psi = [&](int r, double g) {
+            double s = 0;
+            for (size_t d = 0; d < n; ++d) {
+                double u = d * step / g;
+                if (u > 12) {
+                    break;
+                }
+                double u2 = u * u, p;
+                if (r == 4) {
+                    p = (u2 * u2 - 6 * u2 + 3);
+                } else {
+                    p = ((u2 - 15) * u2 + 45) * u2 - 15;
+                }
+                p *= std::exp(-u2 / 2) * lag[d];
+                s += d > 0 ? 2 * p : p;
+            }
+            return s / (w * (w - 1) * std::pow(g, r + 1) * std::sqrt(2 * M_PI));
+        };
+
+        double c1 = 1 / (2 * std::sqrt(M_PI) * w);
+        double a4 = 1.24 * scale * std::pow(w, -1.0 / 7);
+        double b6 = 1.23 * scale * std::pow(w, -1.0 / 9);
+        double td = -psi(6, b6);
+        if (!(td > 0)) {
+            return NAN;
+        }
+        double alpha2 = 1.357 * std::pow(psi(4, a4) / td, 1.0 / 7);
+        if (!std::isfinite(alpha2)) {
+            return NAN;
+        }
+        auto f = [&](double h) {
+            double g = alpha2 * std::pow(h, 5.0 / 7);
+            return std::pow(c1 / psi(4, g), 0.2) - h;
+        };
+
+        double hi = 1.144 * scale * std::pow(w, -0.2), lo = 0.1 * hi;
+        double flo = f(lo), fhi = f(hi);
+        for (int i = 0; flo * fhi > 0; ++i) {
+            if (i > 99 || !std::isfinite(flo) || !std::isfinite(fhi)) {
+                return NAN;
+            }
+            if (i % 2 == 0) {
+                hi *= 1.2;
+                fhi = f(hi);
+            } else {
+                lo /= 1.2;
+                flo = f(lo);
+            }
+        }
+        // bisection
+        while (hi - lo > 1e-6 * lo) {
+            double mid = (lo + hi) / 2, fm = f(mid);
+            if ((fm > 0) == (flo > 0)) {
+                lo = mid;
+                flo = fm;
+            } else {
+                hi = mid;
+            }
+        }
+        return (lo + hi) / 2;
+    }
+
+    hist m_hist;
+    double m_min, m_step;
+};
+
+// 2d kernel density estimate with a product gaussian kernel, the
+// bandwidth of each axis being selected from its marginal weights and
+// rescaled to the rate of 2d estimates. weights are binned bilinearly
+// onto the points and convolved by a 2d r2c and c2r transform
+class kde2
+{
+  public:
+    // nx by ny points evenly spaced over [xmin, xmax] x [ymin, ymax]
+    kde2(size_t nx,
+         double xmin,
+         double xmax,
+         size_t ny,
+         double ymin,
+         double ymax)
+        : m_hist(nx,
+                 xmin - (xmax - xmin) / (nx - 1) / 2,
+                 xmax + (xmax - xmin) / (nx - 1) / 2,
+                 ny,
+                 ymin - (ymax - ymin) / (ny - 1) / 2,
+                 ymax + (ymax - ymin) / (ny - 1) / 2)
+        , m_xmin(xmin)
+        , m_xstep((xmax - xmin) / (nx - 1))
+        , m_ymin(ymin)
+        , m_ystep((ymax - ymin) / (ny - 1))
+    {
+        eigen_assert((nx > 1) && (xmax > xmin) && (ny > 1) && (ymax > ymin));
+    }
+
+    // weights binned in h, whose bins must be uniform
+    kde2(const hist2 &h)
+        : m_hist(h)
+        , m_xmin((h.m_gh2->xrange[0] + h.m_gh2->xrange[1]) / 2)
+        , m_xstep((h.xmax() - h.xmin()) / h.xsize())
+        , m_ymin((h.m_gh2->yrange[0] + h.m_gh2->yrange[1]) / 2)
+        , m_ystep((h.ymax() - h.ymin()) / h.ysize())
+    {
+        eigen_assert((h.xsize() > 1) && (h.ysize() > 1));
+        eigen_assert(h.m_xaxis.uniform() && h.m_yaxis.uniform());
+    }
+
+    kde2 &reset()
+    {
+        m_hist.reset();
+        return *this;
+    }
+
+    kde2 &add(double x, double y, double weight = 1.0)
+    {
+        bin(m_hist.m_gh2->bin, x, y, weight);
+        return *this;
+    }
+
+    template <typename T, typename U>
+    kde2 &add(const DenseBase<T> &x, const DenseBase<U> &y)
+    {
+        static_assert(TYPE_IS(typename T::Scalar, double),
+                      "T must be double type");
+        static_assert(TYPE_IS(typename U::Scalar, double),
+                      "U must be double type");
+
+        eigen_assert((x.rows() == y.rows()) && (x.cols() == y.cols()));
+        stride_eval<T> m_x(x);
+        hist_input<T, U> m_y(y);
+        for (size_t k = 0; k < m_x.size(); ++k) {
+            bin(m_hist.m_gh2->bin,
+                m_x.data()[k * m_x.stride()],
+                m_y.data()[k * m_y.stride()],
+                1);
+        }
+        return *this;
+    }
+
+    void bandwidth(double &hx,
+                   double &hy,
+                   kde::bw rule = kde::bw::SILVERMAN) const
+    {
+        size_t nx = xsize(), ny = ysize();
+        std::vector<double> mx(nx, 0), my(ny, 0);
+        for (size_t i = 0; i < nx; ++i) {
+            for (size_t j = 0; j < ny; ++j) {
+                mx[i] += m_hist.m_gh2->bin[i * ny + j];
+                my[j] += m_hist.m_gh2->bin[i * ny + j];
+            }
+        }
+        hx = kde::select(mx.data(), nx, m_xstep, rule, 2);
+        hy = kde::select(my.data(), ny, m_ystep, rule, 2);
+    }
+
+    // density at the points, rows along x and columns along y
+    MatrixXd density(double hx, double hy) const
+    {
+        eigen_assert((hx > 0) && (hy > 0));
+
+        using Grid = Matrix<double, Dynamic, Dynamic, RowMajor>;
+        using Spectrum =
+            Matrix<std::complex<double>, Dynamic, Dynamic, RowMajor>;
+
+        size_t nx = xsize(), ny = ysize();
+        size_t lx = kde::support(nx, hx / m_xstep);
+        size_t ly = kde::support(ny, hy / m_ystep);
+        size_t mx = kde::fft_size(nx + lx), my = kde::fft_size(ny + ly);
+
+        Grid c = Grid::Zero(mx, my), k(mx, my);
+        c.topLeftCorner(nx, ny) =
+            Map<const Grid>(m_hist.m_gh2->bin, nx, ny);
+        VectorXd kx = VectorXd::Zero(mx), ky = VectorXd::Zero(my);
+        kde::kernel(kx.data(), mx, lx, hx / m_xstep, m_xstep);
+        kde::kernel(ky.data(), my, ly, hy / m_ystep, m_ystep);
+        k = kx * ky.transpose();
+
+        int n0 = (int)mx, n1 = (int)my;
+        Spectrum fc(mx, my / 2 + 1), fk(mx, my / 2 + 1);
+        fftw3::get_plan(n0, n1, c.data(), fc.data(), true)
+            .fwd(n0, n1, c.data(), fc.data());
+        fftw3::get_plan(n0, n1, k.data(), fk.data(), true)
+            .fwd(n0, n1, k.data(), fk.data());
+        fc.array() *= fk.array() / (double)(mx * my);
+        fftw3::get_plan(n0, n1, fc.data(), c.data(), false)
+            .inv(n0, n1, fc.data(), c.data());
+
+        MatrixXd r = c.topLeftCorner(nx, ny).cwiseMax(0);
+        double w = m_hist.sum();
+        return w > 0 ? MatrixXd(r / w) : r;
+    }
+
+    MatrixXd density(kde::bw rule = kde::bw::SILVERMAN) const
+    {
+        double hx, hy;
+        bandwidth(hx, hy, rule);
+        return density(hx, hy);
+    }
+
+    VectorXd xpoints() const
+    {
+        return VectorXd::LinSpaced(xsize(),
+                                   m_xmin,
+                                   m_xmin + m_xstep * (xsize() - 1));
+    }
+
+    VectorXd ypoints() const
+    {
+        return VectorXd::LinSpaced(ysize(),
+                                   m_ymin,
+                                   m_ymin + m_ystep * (ysize() - 1));
+    }
+
+    const hist2 &binned() const
+    {
+        return m_hist;
+    }
+
+    size_t xsize() const
+    {
+        return m_hist.xsize();
+    }
+
+    size_t ysize() const
+    {
+        return m_hist.ysize();
+    }
+
+  private:
+    void bin(double c[], double x, double y, double w) const
+    {
+        size_t nx = xsize(), ny = ysize();
+        double s = (x - m_xmin) / m_xstep, t = (y - m_ymin) / m_ystep;
+        if (!(s >= 0) || !(s <= nx - 1) || !(t >= 0) || !(t <= ny - 1)) {
+            return;
+        }
+        size_t i = std::min((size_t)s, nx - 2), j = std::min((size_t)t, ny - 2);
+        double f = s - i, g = t - j;
+        double *p = c + i * ny + j;
+        p[0] += w * (1 - f) * (1 - g);
+        p[1] += w * (1 - f) * g;
+        p[ny] += w * f * (1 - g);
+        p[ny + 1] += w * f * g;
+    }
+
+    hist2 m_hist;
+    double m_xmin, m_xstep, m_ymin, m_ystep;
+};
+
+////////////////////////////////////////////////////////////
+// global variants
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// interface declaration
+////////////////////////////////////////////////////////////
+
+IEXP_NS_END
+
+#endif /* __IEXP_KDE__ */
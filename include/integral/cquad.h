@@ -27,6 +27,7 @@
 
 #include <common/function.h>
 #include <integral/function.h>
+#include <integral/workspace.h>
 
 #include <gsl/gsl_integration.h>
 
@@ -54,10 +55,16 @@ class cquad_t
     {
     }
 
+    // copies the settings, the copy has its own workspace
+    cquad_t(const cquad_t &q)
+        : cquad_t(q.m_epsabs, q.m_epsrel, q.m_n)
+    {
+    }
+
     ~cquad_t()
     {
         if (m_workspace != nullptr) {
-            gsl_integration_cquad_workspace_free(m_workspace);
+            cquad_workspace_pool::release(m_workspace, m_n);
         }
     }
 
@@ -101,18 +108,17 @@ class cquad_t
     cquad_t &n(T n)
     {
         if (m_n != n) {
-            m_n = n;
             if (m_workspace != nullptr) {
-                gsl_integration_cquad_workspace_free(m_workspace);
-                m_workspace = gsl_integration_cquad_workspace_alloc(m_n);
-                IEXP_NOT_NULLPTR(m_workspace);
+                cquad_workspace_pool::release(m_workspace, m_n);
+                m_workspace = nullptr;
             }
+            m_n = n;
         }
         return *this;
     }
 
   private:
-    IEXP_NOT_COPYABLE(cquad_t)
+    cquad_t &operator=(const cquad_t &) = delete;
 
     T m_epsabs, m_epsrel;
     size_t m_n;
@@ -128,8 +134,7 @@ double cquad_t<double>::operator()(const typename unary_func<double>::type &fn,
                                    size_t *neval)
 {
     if (m_workspace == nullptr) {
-        m_workspace = gsl_integration_cquad_workspace_alloc(m_n);
-        IEXP_NOT_NULLPTR(m_workspace);
+        m_workspace = cquad_workspace_pool::acquire(m_n);
     }
 
     unary_func<double> m_fn(fn, opaque);
@@ -116,6 +116,16 @@ class monte_func
     const gsl_monte_function m_gsl_fn;
 };
 
+// integrand evaluated at many abscissae per call: y[i] = f(x[i]) for i in
+// [0, n)
+template <typename T>
+class batch_func
+{
+  public:
+    using type =
+        std::function<void(const T *x, T *y, size_t n, void *opaque)>;
+};
+
 ////////////////////////////////////////////////////////////
 // global variants
 ////////////////////////////////////////////////////////////
@@ -51,6 +51,12 @@ class glfixed_t
     {
     }
 
+    // copies the settings, the copy has its own table
+    glfixed_t(const glfixed_t &q)
+        : glfixed_t(q.m_n)
+    {
+    }
+
     ~glfixed_t()
     {
         if (m_table != nullptr) {
@@ -85,7 +91,6 @@ class glfixed_t
     }
 
   private:
-    glfixed_t(const glfixed_t &) = delete;
     glfixed_t &operator=(const glfixed_t &) = delete;
 
     size_t m_n;
@@ -0,0 +1,137 @@
+/* Copyright (C) 2017 haniu (niuhao.cn@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef __IEXP_INTEGRAL_MAP__
+#define __IEXP_INTEGRAL_MAP__
+
+////////////////////////////////////////////////////////////
+// import header files
+////////////////////////////////////////////////////////////
+
+#include <common/common.h>
+#include <common/parallel.h>
+
+#include <integral/function.h>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <utility>
+
+IEXP_NS_BEGIN
+
+namespace integral {
+
+////////////////////////////////////////////////////////////
+// macro definition
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// type definition
+////////////////////////////////////////////////////////////
+
+// one integral per parameter: result[i] = fn(q, params[i], &abserr[i]),
+// where q is a copy of integrator owned by the worker thread, e.g.
+//   integral::map(integral::qags(0, 1e-10, 1000),
+//                 strike,
+//                 [](integral::qags &q, double k, double *abserr) {
+//                     return q(..., 0, 1, nullptr, abserr);
+//                 });
+// integrators are not thread safe, so each of up to "thread" workers
+// copies the settings of integrator and integrates with its own
+// workspace. workers take the next parameter whenever they are done, so
+// integrals of different cost are balanced. only taken when fn can be
+// called so, a function of (x, p) goes to the overload below
+template <typename I, typename P, typename F>
+auto map(const I &integrator,
+         const DenseBase<P> &params,
+         const F &fn,
+         VectorXd *abserr = nullptr,
+         unsigned int thread = 0)
+    -> decltype((void)fn(std::declval<I &>(), 0.0, (double *)nullptr),
+                VectorXd())
+{
+    static_assert(TYPE_IS(typename P::Scalar, double), "must be double type");
+
+    eigen_assert(IS_VEC(params));
+    VectorXd m_p = params.derived(), r(m_p.size()), e(m_p.size());
+
+    size_t n = (size_t)m_p.size();
+    if (thread == 0) {
+        thread = parallel::concurrency();
+    }
+    size_t worker = std::min<size_t>(thread, n);
+
+    std::atomic<size_t> next(0);
+    parallel::run(worker,
+                  [&](size_t) {
+                      I q(integrator);
+                      try {
+                          for (size_t i; (i = next.fetch_add(1)) < n;) {
+                              r[i] = fn(q, m_p[i], &e[i]);
+                          }
+                      } catch (...) {
+                          // other workers stop too
+                          next.store(n);
+                          throw;
+                      }
+                  },
+                  (unsigned int)worker);
+
+    if (abserr != nullptr) {
+        abserr->swap(e);
+    }
+    return r;
+}
+
+// result[i] is the integral of fn(x, params[i]) over [a, b], for
+// integrators called as q(fn, a, b, opaque, abserr): qag, qags, qng, cquad
+template <typename I, typename P>
+VectorXd map(const I &integrator,
+             const DenseBase<P> &params,
+             const std::function<double(double x, double p)> &fn,
+             double a,
+             double b,
+             VectorXd *abserr = nullptr,
+             unsigned int thread = 0)
+{
+    return map(integrator,
+               params,
+               [&](I &q, double p, double *e) {
+                   return q([&](double x, void *) { return fn(x, p); },
+                            a,
+                            b,
+                            nullptr,
+                            e);
+               },
+               abserr,
+               thread);
+}
+
+////////////////////////////////////////////////////////////
+// global variants
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// interface declaration
+////////////////////////////////////////////////////////////
+}
+
+IEXP_NS_END
+
+#endif /* __IEXP_INTEGRAL_MAP__ */
@@ -26,6 +26,7 @@
 #include <common/common.h>
 
 #include <integral/function.h>
+#include <integral/workspace.h>
 
 #include <gsl/gsl_integration.h>
 
@@ -64,10 +65,16 @@ class qag_t
     {
     }
 
+    // copies the settings, the copy has its own workspace
+    qag_t(const qag_t &q)
+        : qag_t(q.m_epsabs, q.m_epsrel, q.m_key, q.m_limit)
+    {
+    }
+
     ~qag_t()
     {
         if (m_workspace != nullptr) {
-            gsl_integration_workspace_free(m_workspace);
+            workspace_pool::release(m_workspace, m_limit);
         }
     }
 
@@ -121,18 +128,16 @@ class qag_t
     qag_t &limit(T l)
     {
         if (m_limit != l) {
-            m_limit = l;
             if (m_workspace != nullptr) {
-                gsl_integration_workspace_free(m_workspace);
-                m_workspace = gsl_integration_workspace_alloc(m_limit);
-                IEXP_NOT_NULLPTR(m_workspace);
+                workspace_pool::release(m_workspace, m_limit);
+                m_workspace = nullptr;
             }
+            m_limit = l;
         }
         return *this;
     }
 
   private:
-    qag_t(const qag_t &) = delete;
     qag_t &operator=(const qag_t &) = delete;
 
     T m_epsabs, m_epsrel;
@@ -149,8 +154,7 @@ double qag_t<double>::operator()(const typename unary_func<double>::type &fn,
                                  double *abserr)
 {
     if (m_workspace == nullptr) {
-        m_workspace = gsl_integration_workspace_alloc(m_limit);
-        IEXP_NOT_NULLPTR(m_workspace);
+        m_workspace = workspace_pool::acquire(m_limit);
     }
 
     unary_func<double> m_fn(fn, opaque);
@@ -26,6 +26,7 @@
 #include <common/common.h>
 
 #include <integral/function.h>
+#include <integral/workspace.h>
 
 #include <gsl/gsl_integration.h>
 
@@ -57,10 +58,16 @@ class qagi_t
     {
     }
 
+    // copies the settings, the copy has its own workspace
+    qagi_t(const qagi_t &q)
+        : qagi_t(q.m_epsabs, q.m_epsrel, q.m_limit)
+    {
+    }
+
     ~qagi_t()
     {
         if (m_workspace != nullptr) {
-            gsl_integration_workspace_free(m_workspace);
+            workspace_pool::release(m_workspace, m_limit);
         }
     }
 
@@ -101,18 +108,16 @@ class qagi_t
     qagi_t &limit(T l)
     {
         if (m_limit != l) {
-            m_limit = l;
             if (m_workspace != nullptr) {
-                gsl_integration_workspace_free(m_workspace);
-                m_workspace = gsl_integration_workspace_alloc(m_limit);
-                IEXP_NOT_NULLPTR(m_workspace);
+                workspace_pool::release(m_workspace, m_limit);
+                m_workspace = nullptr;
             }
+            m_limit = l;
         }
         return *this;
     }
 
   private:
-    qagi_t(const qagi_t &) = delete;
     qagi_t &operator=(const qagi_t &) = delete;
 
     T m_epsabs, m_epsrel;
@@ -126,8 +131,7 @@ double qagi_t<double>::operator()(const typename unary_func<double>::type &fn,
                                   double *abserr)
 {
     if (m_workspace == nullptr) {
-        m_workspace = gsl_integration_workspace_alloc(m_limit);
-        IEXP_NOT_NULLPTR(m_workspace);
+        m_workspace = workspace_pool::acquire(m_limit);
     }
 
     unary_func<double> m_fn(fn, opaque);
@@ -160,10 +164,16 @@ class qagiu_t
     {
     }
 
+    // copies the settings, the copy has its own workspace
+    qagiu_t(const qagiu_t &q)
+        : qagiu_t(q.m_epsabs, q.m_epsrel, q.m_limit)
+    {
+    }
+
     ~qagiu_t()
     {
         if (m_workspace != nullptr) {
-            gsl_integration_workspace_free(m_workspace);
+            workspace_pool::release(m_workspace, m_limit);
         }
     }
 
@@ -205,18 +215,16 @@ class qagiu_t
     qagiu_t &limit(T l)
     {
         if (m_limit != l) {
-            m_limit = l;
             if (m_workspace != nullptr) {
-                gsl_integration_workspace_free(m_workspace);
-                m_workspace = gsl_integration_workspace_alloc(m_limit);
-                IEXP_NOT_NULLPTR(m_workspace);
+                workspace_pool::release(m_workspace, m_limit);
+                m_workspace = nullptr;
             }
+            m_limit = l;
         }
         return *this;
     }
 
   protected:
-    qagiu_t(const qagiu_t &) = delete;
     qagiu_t &operator=(const qagiu_t &) = delete;
 
     T m_epsabs, m_epsrel;
@@ -231,8 +239,7 @@ double qagiu_t<double>::operator()(const typename unary_func<double>::type &fn,
                                    double *abserr)
 {
     if (m_workspace == nullptr) {
-        m_workspace = gsl_integration_workspace_alloc(m_limit);
-        IEXP_NOT_NULLPTR(m_workspace);
+        m_workspace = workspace_pool::acquire(m_limit);
     }
 
     unary_func<double> m_fn(fn, opaque);
@@ -266,10 +273,16 @@ class qagil_t
     {
     }
 
+    // copies the settings, the copy has its own workspace
+    qagil_t(const qagil_t &q)
+        : qagil_t(q.m_epsabs, q.m_epsrel, q.m_limit)
+    {
+    }
+
     ~qagil_t()
     {
         if (m_workspace != nullptr) {
-            gsl_integration_workspace_free(m_workspace);
+            workspace_pool::release(m_workspace, m_limit);
         }
     }
 
@@ -311,18 +324,16 @@ class qagil_t
     qagil_t &limit(T l)
     {
         if (m_limit != l) {
-            m_limit = l;
             if (m_workspace != nullptr) {
-                gsl_integration_workspace_free(m_workspace);
-                m_workspace = gsl_integration_workspace_alloc(m_limit);
-                IEXP_NOT_NULLPTR(m_workspace);
+                workspace_pool::release(m_workspace, m_limit);
+                m_workspace = nullptr;
             }
+            m_limit = l;
         }
         return *this;
     }
 
   private:
-    qagil_t(const qagil_t &) = delete;
     qagil_t &operator=(const qagil_t &) = delete;
 
     T m_epsabs, m_epsrel;
@@ -337,8 +348,7 @@ double qagil_t<double>::operator()(const typename unary_func<double>::type &fn,
                                    double *abserr)
 {
     if (m_workspace == nullptr) {
-        m_workspace = gsl_integration_workspace_alloc(m_limit);
-        IEXP_NOT_NULLPTR(m_workspace);
+        m_workspace = workspace_pool::acquire(m_limit);
     }
 
     unary_func<double> m_fn(fn, opaque);
@@ -26,6 +26,7 @@
 #include <common/common.h>
 
 #include <integral/function.h>
+#include <integral/workspace.h>
 
 #include <gsl/gsl_integration.h>
 
@@ -53,10 +54,16 @@ class qags_t
     {
     }
 
+    // copies the settings, the copy has its own workspace
+    qags_t(const qags_t &q)
+        : qags_t(q.m_epsabs, q.m_epsrel, q.m_limit)
+    {
+    }
+
     ~qags_t()
     {
         if (m_workspace != nullptr) {
-            gsl_integration_workspace_free(m_workspace);
+            workspace_pool::release(m_workspace, m_limit);
         }
     }
 
@@ -99,18 +106,16 @@ class qags_t
     qags_t &limit(T l)
     {
         if (m_limit != l) {
-            m_limit = l;
             if (m_workspace != nullptr) {
-                gsl_integration_workspace_free(m_workspace);
-                m_workspace = gsl_integration_workspace_alloc(m_limit);
-                IEXP_NOT_NULLPTR(m_workspace);
+                workspace_pool::release(m_workspace, m_limit);
+                m_workspace = nullptr;
             }
+            m_limit = l;
         }
         return *this;
     }
 
   private:
-    qags_t(const qags_t &) = delete;
     qags_t &operator=(const qags_t &) = delete;
 
     T m_epsabs, m_epsrel;
@@ -126,8 +131,7 @@ double qags_t<double>::operator()(const typename unary_func<double>::type &fn,
                                   double *abserr)
 {
     if (m_workspace == nullptr) {
-        m_workspace = gsl_integration_workspace_alloc(m_limit);
-        IEXP_NOT_NULLPTR(m_workspace);
+        m_workspace = workspace_pool::acquire(m_limit);
     }
 
     unary_func<double> m_fn(fn, opaque);
@@ -0,0 +1,630 @@
+/* Copyright (C) 2017 haniu (niuhao.cn@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef __IEXP_INTEGRAL_QAGV__
+#define __IEXP_INTEGRAL_QAGV__
+
+////////////////////////////////////////////////////////////
+// import header files
+////////////////////////////////////////////////////////////
+
+#include <common/common.h>
+
+#include <integral/function.h>
+#include <integral/workspace.h>
+
+#include <gsl/gsl_errno.h>
+#include <gsl/gsl_integration.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+IEXP_NS_BEGIN
+
+namespace integral {
+
+////////////////////////////////////////////////////////////
+// macro definition
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// type definition
+////////////////////////////////////////////////////////////
+
+// gauss kronrod rule of 2n + 1 points on [-1, 1], extending the n point
+// gauss legendre rule. the rules of gsl are computed once instead of
+// being tabulated: the kronrod nodes are the zeros of the stieltjes
+// polynomial of P_n, found between the gauss nodes, and the weights make
+// the rule exact for polynomials up to degree 2n
+class gk_rule
+{
+  public:
+    // rule of gsl_integration_qag key k, GSL_INTEG_GAUSS15 to 61
+    static const gk_rule &get(int k)
+    {
+        static const gk_rule s_rule[] = {gk_rule(7),
+                                         gk_rule(10),
+                                         gk_rule(15),
+                                         gk_rule(20),
+                                         gk_rule(25),
+                                         gk_rule(30)};
+        eigen_assert((k >= 1) && (k <= 6));
+        return s_rule[k - 1];
+    }
+
+    // result and error estimates of the rule over an interval of half
+    // length h, y holding the integrand at the nodes, as gsl_integration_qk
+    void apply(const double y[],
+               double h,
+               double &result,
+               double &abserr,
+               double &resabs,
+               double &resasc) const
+    {
+        double rk = 0, rg = 0, ra = 0;
+        for (size_t i = 0; i < m_x.size(); ++i) {
+            rk += m_wk[i] * y[i];
+            rg += m_wg[i] * y[i];
+            ra += m_wk[i] * std::abs(y[i]);
+        }
+        double mean = rk / 2, rs = 0;
+        for (size_t i = 0; i < m_x.size(); ++i) {
+            rs += m_wk[i] * std::abs(y[i] - mean);
+        }
+
+        result = rk * h;
+        resabs = ra * std::abs(h);
+        resasc = rs * std::abs(h);
+        abserr = rescale_error((rk - rg) * h, resabs, resasc);
+    }
+
+    // nodes, ascending
+    const std::vector<double> &x() const
+    {
+        return m_x;
+    }
+
+    size_t size() const
+    {
+        return m_x.size();
+    }
+
+  private:
+    gk_rule(size_t n)
+    {
+        std::vector<double> gx, gw, qx, qw;
+        gauss(n, gx, gw);
+        // exact for the degree 3n + 1 products below
+        gauss(2 * n + 2, qx, qw);
+
+        // E = P_{n+1} + sum(e_j * P_j), j = n - 1, n - 3, ..., with
+        // int(P_n * E * P_k) = 0 for k < n + 1, which only constrains odd k
+        size_t m = (n + 1) / 2;
+        MatrixXd a = MatrixXd::Zero(m, m);
+        VectorXd b = VectorXd::Zero(m);
+        std::vector<double> p(n + 2);
+        for (size_t q = 0; q < qx.size(); ++q) {
+            legendre(n + 1, qx[q], p.data());
+            for (size_t r = 0; r < m; ++r) {
+                double t = qw[q] * p[n] * p[2 * r + 1];
+                for (size_t c = 0; c < m; ++c) {
+                    a(r, c) += t * p[n - 1 - 2 * c];
+                }
+                b[r] -= t * p[n + 1];
+            }
+        }
+        VectorXd e = a.colPivHouseholderQr().solve(b);
+
+        auto stieltjes = [&](double x) {
+            legendre(n + 1, x, p.data());
+            double s = p[n + 1];
+            for (size_t c = 0; c < m; ++c) {
+                s += e[c] * p[n - 1 - 2 * c];
+            }
+            return s;
+        };
+
+        // one kronrod node in each gap of -1, gauss nodes, 1
+        std::vector<std::pair<double, double>> node;
+        for (size_t i = 0; i < n; ++i) {
+            node.emplace_back(gx[i], gw[i]);
+        }
+        for (size_t i = 0; i <= n; ++i) {
+            double lo = i > 0 ? gx[i - 1] : -1, hi = i < n ? gx[i] : 1;
+            double flo = stieltjes(lo);
+            for (int k = 0; k < 200; ++k) {
+                double mid = (lo + hi) / 2;
+                if ((mid <= lo) || (mid >= hi)) {
+                    break;
+                }
+                double fm = stieltjes(mid);
+                if ((fm > 0) == (flo > 0)) {
+                    lo = mid;
+                    flo = fm;
+                } else {
+                    hi = mid;
+                }
+            }
+            node.emplace_back((lo + hi) / 2, 0.0);
+        }
+        std::sort(node.begin(), node.end());
+
+        size_t np = 2 * n + 1;
+        m_x.resize(np);
+        m_wg.resize(np);
+        for (size_t i = 0; i < np; ++i) {
+            m_x[i] = (node[i].first - node[np - 1 - i].first) / 2;
+            m_wg[i] = node[i].second;
+        }
+
+        // int(P_k) = sum(w_i * P_k(x_i)), k <= 2n
+        MatrixXd v(np, np);
+        p.resize(np);
+        for (size_t i = 0; i < np; ++i) {
+            legendre(np - 1, m_x[i], p.data());
+            for (size_t k = 0; k < np; ++k) {
+                v(k, i) = p[k];
+            }
+        }
+        VectorXd r = VectorXd::Zero(np);
+        r[0] = 2;
+        VectorXd w = v.fullPivLu().solve(r);
+        m_wk.resize(np);
+        for (size_t i = 0; i < np; ++i) {
+            m_wk[i] = (w[i] + w[np - 1 - i]) / 2;
+        }
+    }
+
+    // P_0(x) ... P_n(x)
+    static void legendre(size_t n, double x, double p[])
+    {
+        p[0] = 1;
+        if (n > 0) {
+            p[1] = x;
+        }
+        for (size_t k = 2; k <= n; ++k) {
+            p[k] = ((2 * k - 1) * x * p[k - 1] - (k - 1) * p[k - 2]) / k;
+        }
+    }
+
+    // n point gauss legendre rule, nodes ascending
+    static void gauss(size_t n, std::vector<double> &x, std::vector<double> &w)
+    {
+        x.resize(n);
+        w.resize(n);
+        for (size_t i = 0; i < (n + 1) / 2; ++i) {
+            double z = std::cos(M_PI * (i + 0.75) / (n + 0.5)), dp = 0;
+            for (int k = 0; k < 100; ++k) {
+                double p1 = 1, p2 = 0;
+                for (size_t j = 1; j <= n; ++j) {
+                    double p3 = p2;
+                    p2 = p1;
+                    p1 = ((2 * j - 1) * z * p2 - (j - 1) * p3) / j;
+                }
+                dp = n * (z * p1 - p2) / (z * z - 1);
+                double dz = p1 / dp;
+                z -= dz;
+                if (std::abs(dz) < 1e-17) {
+                    break;
+                }
+            }
+            x[i] = -z;
+            x[n - 1 - i] = z;
+            w[i] = w[n - 1 - i] = 2 / ((1 - z * z) * dp * dp);
+        }
+        if (n % 2 == 1) {
+            x[n / 2] = 0;
+        }
+    }
+
+    static double rescale_error(double err, double resabs, double resasc)
+    {
+        const double eps = std::numeric_limits<double>::epsilon();
+        const double tiny = std::numeric_limits<double>::min();
+
+        err = std::abs(err);
+        if ((resasc != 0) && (err != 0)) {
+            double scale = std::pow(200 * err / resasc, 1.5);
+            err = scale < 1 ? resasc * scale : resasc;
+        }
+        if (resabs > tiny / (50 * eps)) {
+            err = std::max(err, 50 * eps * resabs);
+        }
+        return err;
+    }
+
+    std::vector<double> m_x, m_wk, m_wg;
+};
+
+// adaptive gauss kronrod integration of a batch integrand.
+//
+// same algorithm, error control and workspace as qag_t, but the integrand
+// gets all abscissae of a bisection at once, both halves of the interval
+// with the nodes of the rule: 2 * (2n + 1) values per call, 2n + 1 for the
+// first estimate. integrands that are eigen expressions of the abscissae
+// then evaluate vectorized instead of point by point
+template <typename T>
+class qagv_t
+{
+  public:
+    enum class key
+    {
+        GAUSS15 = GSL_INTEG_GAUSS15,
+        GAUSS21 = GSL_INTEG_GAUSS21,
+        GAUSS31 = GSL_INTEG_GAUSS31,
+        GAUSS41 = GSL_INTEG_GAUSS41,
+        GAUSS51 = GSL_INTEG_GAUSS51,
+        GAUSS61 = GSL_INTEG_GAUSS61,
+    };
+
+    qagv_t(T epsabs, T epsrel, key k, size_t limit)
+        : m_epsabs(epsabs)
+        , m_epsrel(epsrel)
+        , m_key(k)
+        , m_limit(limit)
+        , m_workspace(nullptr)
+    {
+        static_assert(TYPE_IS(T, double), "only support double now");
+    }
+
+    // copies the settings, the copy has its own workspace
+    qagv_t(const qagv_t &q)
+        : qagv_t(q.m_epsabs, q.m_epsrel, q.m_key, q.m_limit)
+    {
+    }
+
+    ~qagv_t()
+    {
+        if (m_workspace != nullptr) {
+            workspace_pool::release(m_workspace, m_limit);
+        }
+    }
+
+    T operator()(const typename batch_func<T>::type &fn,
+                 T a,
+                 T b,
+                 void *opaque = nullptr,
+                 T *abserr = nullptr)
+    {
+        if (m_workspace == nullptr) {
+            m_workspace = workspace_pool::acquire(m_limit);
+        }
+
+        T r, e;
+        qag(fn, opaque, a, b, &r, abserr != nullptr ? abserr : &e);
+        return r;
+    }
+
+    T epsabs() const
+    {
+        return m_epsabs;
+    }
+
+    qagv_t &epsabs(T e)
+    {
+        m_epsabs = e;
+        return *this;
+    }
+
+    T epsrel() const
+    {
+        return m_epsrel;
+    }
+
+    qagv_t &epsrel(T e)
+    {
+        m_epsrel = e;
+        return *this;
+    }
+
+    key key() const
+    {
+        return m_key;
+    }
+
+    qagv_t &key(enum key k)
+    {
+        m_key = k;
+        return *this;
+    }
+
+    T limit() const
+    {
+        return m_limit;
+    }
+
+    qagv_t &limit(T l)
+    {
+        if (m_limit != l) {
+            if (m_workspace != nullptr) {
+                workspace_pool::release(m_workspace, m_limit);
+                m_workspace = nullptr;
+            }
+            m_limit = l;
+        }
+        return *this;
+    }
+
+  private:
+    qagv_t &operator=(const qagv_t &) = delete;
+
+    // abscissae of the rule over [a, b] into x
+    static void nodes(const gk_rule &q, T a, T b, T x[])
+    {
+        T c = (a + b) / 2, h = (b - a) / 2;
+        for (size_t i = 0; i < q.size(); ++i) {
+            x[i] = c + h * q.x()[i];
+        }
+    }
+
+    // gsl_integration_qag with the rule applied to batches
+    int qag(const typename batch_func<T>::type &fn,
+            void *opaque,
+            T a,
+            T b,
+            T *result,
+            T *abserr)
+    {
+        const T eps = std::numeric_limits<T>::epsilon();
+        gsl_integration_workspace *w = m_workspace;
+        const gk_rule &q = gk_rule::get(static_cast<int>(m_key));
+        size_t m = q.size();
+        m_x.resize(2 * m);
+        m_y.resize(2 * m);
+
+        *result = 0;
+        *abserr = 0;
+        if (m_limit > w->limit) {
+            GSL_ERROR("iteration limit exceeds available workspace",
+                      GSL_EINVAL);
+        }
+        if ((m_epsabs <= 0) &&
+            ((m_epsrel < 50 * eps) || (m_epsrel < 0.5e-28))) {
+            GSL_ERROR("tolerance cannot be achieved with given epsabs and "
+                      "epsrel",
+                      GSL_EBADTOL);
+        }
+
+        T result0, abserr0, resabs0, resasc0;
+        nodes(q, a, b, m_x.data());
+        fn(m_x.data(), m_y.data(), m, opaque);
+        q.apply(m_y.data(), (b - a) / 2, result0, abserr0, resabs0, resasc0);
+
+        w->size = 1;
+        w->nrmax = 0;
+        w->i = 0;
+        w->maximum_level = 0;
+        w->alist[0] = a;
+        w->blist[0] = b;
+        w->rlist[0] = result0;
+        w->elist[0] = abserr0;
+        w->order[0] = 0;
+        w->level[0] = 0;
+
+        T tolerance = std::max(m_epsabs, m_epsrel * std::abs(result0));
+        volatile T round_off = 50 * eps * resabs0;
+        if ((abserr0 <= round_off) && (abserr0 > tolerance)) {
+            *result = result0;
+            *abserr = abserr0;
+            GSL_ERROR("cannot reach tolerance because of roundoff error on "
+                      "first attempt",
+                      GSL_EROUND);
+        } else if (((abserr0 <= tolerance) && (abserr0 != resasc0)) ||
+                   (abserr0 == 0.0)) {
+            *result = result0;
+            *abserr = abserr0;
+            return GSL_SUCCESS;
+        } else if (m_limit == 1) {
+            *result = result0;
+            *abserr = abserr0;
+            GSL_ERROR("a maximum of one iteration was insufficient",
+                      GSL_EMAXITER);
+        }
+
+        T area = result0, errsum = abserr0;
+        size_t iteration = 1;
+        int roundoff_type1 = 0, roundoff_type2 = 0, error_type = 0;
+        do {
+            size_t i = w->i;
+            T a_i = w->alist[i], b_i = w->blist[i];
+            T r_i = w->rlist[i], e_i = w->elist[i];
+            T a1 = a_i, b1 = (a_i + b_i) / 2, a2 = b1, b2 = b_i;
+
+            T area1, error1, resabs1, resasc1;
+            T area2, error2, resabs2, resasc2;
+            nodes(q, a1, b1, m_x.data());
+            nodes(q, a2, b2, m_x.data() + m);
+            fn(m_x.data(), m_y.data(), 2 * m, opaque);
+            q.apply(m_y.data(), (b1 - a1) / 2, area1, error1, resabs1, resasc1);
+            q.apply(m_y.data() + m,
+                    (b2 - a2) / 2,
+                    area2,
+                    error2,
+                    resabs2,
+                    resasc2);
+
+            T area12 = area1 + area2, error12 = error1 + error2;
+            errsum += error12 - e_i;
+            area += area12 - r_i;
+
+            if ((resasc1 != error1) && (resasc2 != error2)) {
+                T delta = r_i - area12;
+                if ((std::abs(delta) <= 1.0e-5 * std::abs(area12)) &&
+                    (error12 >= 0.99 * e_i)) {
+                    ++roundoff_type1;
+                }
+                if ((iteration >= 10) && (error12 > e_i)) {
+                    ++roundoff_type2;
+                }
+            }
+
+            tolerance = std::max(m_epsabs, m_epsrel * std::abs(area));
+            if (errsum > tolerance) {
+                if ((roundoff_type1 >= 6) || (roundoff_type2 >= 20)) {
+                    error_type = 2;
+                }
+                if (subinterval_too_small(a1, a2, b2)) {
+                    error_type = 3;
+                }
+            }
+
+            update(w, a1, b1, area1, error1, a2, b2, area2, error2);
+            ++iteration;
+        } while ((iteration < m_limit) && !error_type &&
+                 (errsum > tolerance));
+
+        *result = 0;
+        for (size_t k = 0; k < w->size; ++k) {
+            *result += w->rlist[k];
+        }
+        *abserr = errsum;
+
+        if (errsum <= tolerance) {
+            return GSL_SUCCESS;
+        } else if (error_type == 2) {
+            GSL_ERROR("roundoff error prevents tolerance from being achieved",
+                      GSL_EROUND);
+        } else if (error_type == 3) {
+            GSL_ERROR("bad integrand behavior found in the integration "
+                      "interval",
+                      GSL_ESING);
+        } else if (iteration == m_limit) {
+            GSL_ERROR("maximum number of subdivisions reached", GSL_EMAXITER);
+        }
+        GSL_ERROR("could not integrate function", GSL_EFAILED);
+    }
+
+    static bool subinterval_too_small(T a1, T a2, T b2)
+    {
+        const T eps = std::numeric_limits<T>::epsilon();
+        const T tiny = std::numeric_limits<T>::min();
+
+        T tmp = (1 + 100 * eps) * (std::abs(a2) + 1000 * tiny);
+        return (std::abs(a1) <= tmp) && (std::abs(b2) <= tmp);
+    }
+
+    // replaces the interval of largest error by its halves, keeping the
+    // order of errors, as the update of gsl
+    static void update(gsl_integration_workspace *w,
+                       T a1,
+                       T b1,
+                       T area1,
+                       T error1,
+                       T a2,
+                       T b2,
+                       T area2,
+                       T error2)
+    {
+        size_t i_max = w->i, i_new = w->size;
+        size_t new_level = w->level[i_max] + 1;
+
+        if (error2 > error1) {
+            w->alist[i_max] = a2;
+            w->rlist[i_max] = area2;
+            w->elist[i_max] = error2;
+            w->level[i_max] = new_level;
+
+            w->alist[i_new] = a1;
+            w->blist[i_new] = b1;
+            w->rlist[i_new] = area1;
+            w->elist[i_new] = error1;
+            w->level[i_new] = new_level;
+        } else {
+            w->blist[i_max] = b1;
+            w->rlist[i_max] = area1;
+            w->elist[i_max] = error1;
+            w->level[i_max] = new_level;
+
+            w->alist[i_new] = a2;
+            w->blist[i_new] = b2;
+            w->rlist[i_new] = area2;
+            w->elist[i_new] = error2;
+            w->level[i_new] = new_level;
+        }
+
+        ++w->size;
+        w->maximum_level = std::max(w->maximum_level, new_level);
+        sort(w);
+    }
+
+    // qpsrt of quadpack
+    static void sort(gsl_integration_workspace *w)
+    {
+        size_t last = w->size - 1, limit = w->limit;
+        double *elist = w->elist;
+        size_t *order = w->order;
+        size_t i_nrmax = w->nrmax, i_maxerr = order[i_nrmax];
+
+        if (last < 2) {
+            order[0] = 0;
+            order[1] = 1;
+            w->i = i_maxerr;
+            return;
+        }
+
+        double errmax = elist[i_maxerr];
+        while ((i_nrmax > 0) && (errmax > elist[order[i_nrmax - 1]])) {
+            order[i_nrmax] = order[i_nrmax - 1];
+            --i_nrmax;
+        }
+
+        long top = last < (limit / 2 + 2) ? (long)last
+                                          : (long)(limit - last + 1);
+        long i = (long)i_nrmax + 1;
+        while ((i < top) && (errmax < elist[order[i]])) {
+            order[i - 1] = order[i];
+            ++i;
+        }
+        order[i - 1] = i_maxerr;
+
+        double errmin = elist[last];
+        long k = top - 1;
+        while ((k > i - 2) && (errmin >= elist[order[k]])) {
+            order[k + 1] = order[k];
+            --k;
+        }
+        order[k + 1] = last;
+
+        w->i = order[i_nrmax];
+        w->nrmax = i_nrmax;
+    }
+
+    T m_epsabs, m_epsrel;
+    enum key m_key;
+    size_t m_limit;
+    gsl_integration_workspace *m_workspace;
+    std::vector<T> m_x, m_y;
+};
+
+typedef qagv_t<double> qagv;
+
+////////////////////////////////////////////////////////////
+// global variants
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// interface declaration
+////////////////////////////////////////////////////////////
+}
+
+IEXP_NS_END
+
+#endif /* __IEXP_INTEGRAL_QAGV__ */
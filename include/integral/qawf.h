@@ -27,6 +27,7 @@
 
 #include <integral/function.h>
 #include <integral/qawo.h>
+#include <integral/workspace.h>
 
 #include <gsl/gsl_integration.h>
 
@@ -54,14 +55,20 @@ class qawf_t
     {
     }
 
+    // copies the settings, the copy has its own workspace
+    qawf_t(const qawf_t &q)
+        : qawf_t(q.m_epsabs, q.m_limit)
+    {
+    }
+
     ~qawf_t()
     {
         if (m_workspace != nullptr) {
-            gsl_integration_workspace_free(m_workspace);
+            workspace_pool::release(m_workspace, m_limit);
         }
 
         if (m_cycle_workspace != nullptr) {
-            gsl_integration_workspace_free(m_cycle_workspace);
+            workspace_pool::release(m_cycle_workspace, m_limit);
         }
     }
 
@@ -93,18 +100,20 @@ class qawf_t
     qawf_t &limit(T l)
     {
         if (m_limit != l) {
-            m_limit = l;
             if (m_workspace != nullptr) {
-                gsl_integration_workspace_free(m_workspace);
-                m_workspace = gsl_integration_workspace_alloc(m_limit);
-                IEXP_NOT_NULLPTR(m_workspace);
+                workspace_pool::release(m_workspace, m_limit);
+                m_workspace = nullptr;
+            }
+            if (m_cycle_workspace != nullptr) {
+                workspace_pool::release(m_cycle_workspace, m_limit);
+                m_cycle_workspace = nullptr;
             }
+            m_limit = l;
         }
         return *this;
     }
 
   private:
-    qawf_t(const qawf_t &) = delete;
     qawf_t &operator=(const qawf_t &) = delete;
 
     T m_epsabs;
@@ -120,13 +129,11 @@ double qawf_t<double>::operator()(const typename unary_func<double>::type &fn,
                                   double *abserr)
 {
     if (m_workspace == nullptr) {
-        m_workspace = gsl_integration_workspace_alloc(m_limit);
-        IEXP_NOT_NULLPTR(m_workspace);
+        m_workspace = workspace_pool::acquire(m_limit);
     }
 
     if (m_cycle_workspace == nullptr) {
-        m_cycle_workspace = gsl_integration_workspace_alloc(m_limit);
-        IEXP_NOT_NULLPTR(m_workspace);
+        m_cycle_workspace = workspace_pool::acquire(m_limit);
     }
 
     unary_func<double> m_fn(fn, opaque);
@@ -51,6 +51,12 @@ class qng_t
     {
     }
 
+    // copies the settings
+    qng_t(const qng_t &q)
+        : qng_t(q.m_epsabs, q.m_epsrel)
+    {
+    }
+
     T operator()(const typename unary_func<T>::type &fn,
                  T a,
                  T b,
@@ -84,7 +90,6 @@ class qng_t
     }
 
   private:
-    qng_t(const qng_t &) = delete;
     qng_t &operator=(const qng_t &) = delete;
 
     T m_epsabs, m_epsrel;
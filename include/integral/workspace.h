@@ -0,0 +1,232 @@
+/* Copyright (C) 2017 haniu (niuhao.cn@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef __IEXP_INTEGRAL_WORKSPACE__
+#define __IEXP_INTEGRAL_WORKSPACE__
+
+////////////////////////////////////////////////////////////
+// import header files
+////////////////////////////////////////////////////////////
+
+#include <common/common.h>
+
+#include <gsl/gsl_integration.h>
+
+#include <utility>
+#include <vector>
+
+IEXP_NS_BEGIN
+
+namespace integral {
+
+////////////////////////////////////////////////////////////
+// macro definition
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// type definition
+////////////////////////////////////////////////////////////
+
+template <typename W>
+class workspace_traits
+{
+};
+
+template <>
+class workspace_traits<gsl_integration_workspace>
+{
+  public:
+    static gsl_integration_workspace *alloc(size_t n)
+    {
+        return gsl_integration_workspace_alloc(n);
+    }
+
+    static void free(gsl_integration_workspace *w)
+    {
+        gsl_integration_workspace_free(w);
+    }
+};
+
+template <>
+class workspace_traits<gsl_integration_cquad_workspace>
+{
+  public:
+    static gsl_integration_cquad_workspace *alloc(size_t n)
+    {
+        return gsl_integration_cquad_workspace_alloc(n);
+    }
+
+    static void free(gsl_integration_cquad_workspace *w)
+    {
+        gsl_integration_cquad_workspace_free(w);
+    }
+};
+
+// counters of the pool of the calling thread
+struct workspace_stats
+{
+    // acquires served from the free list, and those which allocated
+    size_t hit, miss;
+    // workspaces given back, and those freed as the list was full
+    size_t release, drop;
+    // workspaces in the free list
+    size_t cached;
+};
+
+// per thread free lists of gsl integration workspaces.
+//
+// integrators take their workspace from the pool of the thread they run
+// on and give it back when destroyed, so short lived integrators reuse
+// the workspaces of previous ones instead of allocating. workspaces are
+// keyed by their size, the limit of adaptive integrators, as gsl uses the
+// whole of a cquad workspace. there is no lock: a workspace released by
+// another thread than the one which acquired it just moves to that
+// thread's list. lists are freed on thread exit
+template <typename W>
+class workspace_pool_t
+{
+  public:
+    enum
+    {
+        // workspaces kept per thread
+        CAPACITY = 8,
+    };
+
+    // a workspace of size n
+    static W *acquire(size_t n)
+    {
+        if (exited()) {
+            return alloc(n);
+        }
+
+        cache &c = local();
+        for (size_t i = c.list.size(); i-- > 0;) {
+            if (c.list[i].first == n) {
+                W *w = c.list[i].second;
+                c.list.erase(c.list.begin() + i);
+                ++c.stats.hit;
+                return w;
+            }
+        }
+        ++c.stats.miss;
+        return alloc(n);
+    }
+
+    // gives back a workspace returned by acquire(n)
+    static void release(W *w, size_t n)
+    {
+        if (exited()) {
+            workspace_traits<W>::free(w);
+            return;
+        }
+
+        cache &c = local();
+        ++c.stats.release;
+        if (c.list.size() < CAPACITY) {
+            c.list.emplace_back(n, w);
+        } else {
+            ++c.stats.drop;
+            workspace_traits<W>::free(w);
+        }
+    }
+
+    static workspace_stats stats()
+    {
+        if (exited()) {
+            return workspace_stats{0, 0, 0, 0, 0};
+        }
+
+        cache &c = local();
+        workspace_stats s = c.stats;
+        s.cached = c.list.size();
+        return s;
+    }
+
+    // frees the workspaces kept for the calling thread
+    static void clear()
+    {
+        if (!exited()) {
+            local().clear();
+        }
+    }
+
+  private:
+    class cache
+    {
+      public:
+        cache()
+            : stats{0, 0, 0, 0, 0}
+        {
+            list.reserve(CAPACITY);
+        }
+
+        ~cache()
+        {
+            clear();
+            exited() = true;
+        }
+
+        void clear()
+        {
+            for (auto &e : list) {
+                workspace_traits<W>::free(e.second);
+            }
+            list.clear();
+        }
+
+        std::vector<std::pair<size_t, W *>> list;
+        workspace_stats stats;
+    };
+
+    static W *alloc(size_t n)
+    {
+        W *w = workspace_traits<W>::alloc(n);
+        IEXP_NOT_NULLPTR(w);
+        return w;
+    }
+
+    static cache &local()
+    {
+        static thread_local cache s_cache;
+        return s_cache;
+    }
+
+    // integrators destroyed after the thread's list, e.g. static ones on
+    // the main thread, free their workspace directly
+    static bool &exited()
+    {
+        static thread_local bool s_exited = false;
+        return s_exited;
+    }
+};
+
+typedef workspace_pool_t<gsl_integration_workspace> workspace_pool;
+typedef workspace_pool_t<gsl_integration_cquad_workspace> cquad_workspace_pool;
+
+////////////////////////////////////////////////////////////
+// global variants
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// interface declaration
+////////////////////////////////////////////////////////////
+}
+
+IEXP_NS_END
+
+#endif /* __IEXP_INTEGRAL_WORKSPACE__ */
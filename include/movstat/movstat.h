@@ -0,0 +1,122 @@
+/* Copyright (C) 2017 haniu (niuhao.cn@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef __IEXP_MOVSTAT__
+#define __IEXP_MOVSTAT__
+
+////////////////////////////////////////////////////////////
+// import header files
+////////////////////////////////////////////////////////////
+
+#include <common/common.h>
+
+#include <movstat/window.h>
+
+IEXP_NS_BEGIN
+
+namespace movstat {
+
+////////////////////////////////////////////////////////////
+// macro definition
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// type definition
+////////////////////////////////////////////////////////////
+
+// pushes every element of x to a window accumulator w and stores
+// get(w) after each push
+template <typename T, typename W, typename G>
+inline VectorXd apply(const DenseBase<T> &x, W &w, G get)
+{
+    stride_eval<T> m_x(x);
+    const typename T::Scalar *data = m_x.data();
+    size_t n = m_x.size(), stride = m_x.stride();
+
+    VectorXd r(n);
+    for (size_t i = 0; i < n; ++i) {
+        w.push((double)data[i * stride]);
+        r[i] = get(w);
+    }
+    return r;
+}
+
+////////////////////////////////////////////////////////////
+// global variants
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// interface declaration
+////////////////////////////////////////////////////////////
+
+// moving statistics of a whole array. element i of the result is the
+// statistic of the trailing window x[i - window + 1, i], the first
+// window - 1 windows being truncated at the beginning of x
+
+template <typename T>
+inline VectorXd mean(const DenseBase<T> &x, size_t window)
+{
+    moments w(window);
+    return apply(x, w, [](const moments &m) { return m.mean(); });
+}
+
+template <typename T>
+inline VectorXd var(const DenseBase<T> &x, size_t window)
+{
+    moments w(window);
+    return apply(x, w, [](const moments &m) { return m.var(); });
+}
+
+template <typename T>
+inline VectorXd std(const DenseBase<T> &x, size_t window)
+{
+    moments w(window);
+    return apply(x, w, [](const moments &m) { return m.std(); });
+}
+
+template <typename T>
+inline VectorXd min(const DenseBase<T> &x, size_t window)
+{
+    minmax w(window);
+    return apply(x, w, [](const minmax &m) { return m.min(); });
+}
+
+template <typename T>
+inline VectorXd max(const DenseBase<T> &x, size_t window)
+{
+    minmax w(window);
+    return apply(x, w, [](const minmax &m) { return m.max(); });
+}
+
+template <typename T>
+inline VectorXd quantile(const DenseBase<T> &x, size_t window, double f)
+{
+    order w(window, f);
+    return apply(x, w, [](const order &o) { return o.get(); });
+}
+
+template <typename T>
+inline VectorXd median(const DenseBase<T> &x, size_t window)
+{
+    return quantile(x, window, 0.5);
+}
+}
+
+IEXP_NS_END
+
+#endif /* __IEXP_MOVSTAT__ */
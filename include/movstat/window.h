@@ -0,0 +1,392 @@
+/* Copyright (C) 2017 haniu (niuhao.cn@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef __IEXP_MOVSTAT_WINDOW__
+#define __IEXP_MOVSTAT_WINDOW__
+
+////////////////////////////////////////////////////////////
+// import header files
+////////////////////////////////////////////////////////////
+
+#include <common/common.h>
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <iterator>
+#include <limits>
+#include <set>
+#include <utility>
+#include <vector>
+
+IEXP_NS_BEGIN
+
+namespace movstat {
+
+////////////////////////////////////////////////////////////
+// macro definition
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// type definition
+////////////////////////////////////////////////////////////
+
+// the last samples pushed, at most window of them
+class ring
+{
+  public:
+    ring(size_t window)
+        : m_data(window)
+        , m_head(0)
+        , m_size(0)
+    {
+        eigen_assert(window > 0);
+    }
+
+    void reset()
+    {
+        m_head = 0;
+        m_size = 0;
+    }
+
+    bool full() const
+    {
+        return m_size == m_data.size();
+    }
+
+    // sample leaving the window on next push, the window must be full
+    double oldest() const
+    {
+        return m_data[m_head];
+    }
+
+    void push(double x)
+    {
+        m_data[m_head] = x;
+        if (++m_head == m_data.size()) {
+            m_head = 0;
+        }
+        if (m_size < m_data.size()) {
+            ++m_size;
+        }
+    }
+
+    // samples of the window, in no particular order
+    const double *data() const
+    {
+        return m_data.data();
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    size_t window() const
+    {
+        return m_data.size();
+    }
+
+    // position of the next push, 0 once every window pushes
+    size_t head() const
+    {
+        return m_head;
+    }
+
+  private:
+    std::vector<double> m_data;
+    size_t m_head, m_size;
+};
+
+// mean and variance of the last window samples in O(1) per push.
+//
+// a sample entering a full window replaces the oldest one in a single
+// welford style update. the running sums are recomputed from the window
+// every window pushes, which costs O(1) amortized and keeps rounding
+// errors from accumulating over long streams
+class moments
+{
+  public:
+    moments(size_t window)
+        : m_ring(window)
+        , m_mean(0)
+        , m_m2(0)
+    {
+    }
+
+    moments &reset()
+    {
+        m_ring.reset();
+        m_mean = 0;
+        m_m2 = 0;
+        return *this;
+    }
+
+    moments &push(double x)
+    {
+        if (!m_ring.full()) {
+            m_ring.push(x);
+            double d = x - m_mean;
+            m_mean += d / m_ring.size();
+            m_m2 += d * (x - m_mean);
+            return *this;
+        }
+
+        double old = m_ring.oldest();
+        m_ring.push(x);
+        if (m_ring.head() == 0) {
+            refresh();
+            return *this;
+        }
+
+        double mean = m_mean + (x - old) / m_ring.size();
+        m_m2 += (x - old) * (x - mean + old - m_mean);
+        m_m2 = std::max(m_m2, 0.0);
+        m_mean = mean;
+        return *this;
+    }
+
+    double mean() const
+    {
+        return m_ring.size() > 0 ? m_mean
+                                 : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    // unbiased estimate, as gsl_stats_variance
+    double var() const
+    {
+        return m_m2 / (m_ring.size() - 1.0);
+    }
+
+    double std() const
+    {
+        return std::sqrt(var());
+    }
+
+    // samples in the window
+    size_t size() const
+    {
+        return m_ring.size();
+    }
+
+    size_t window() const
+    {
+        return m_ring.window();
+    }
+
+  private:
+    void refresh()
+    {
+        Map<const ArrayXd> a(m_ring.data(), m_ring.size());
+        m_mean = a.mean();
+        m_m2 = (a - m_mean).square().sum();
+    }
+
+    ring m_ring;
+    double m_mean, m_m2;
+};
+
+// minimum and maximum of the last window samples.
+//
+// each deque holds the samples which may still become the extreme of a
+// later window, in push order and monotone in value, so the extreme is
+// at the front and every sample enters and leaves once: O(1) amortized
+class minmax
+{
+  public:
+    minmax(size_t window)
+        : m_window(window)
+        , m_count(0)
+    {
+        eigen_assert(window > 0);
+    }
+
+    minmax &reset()
+    {
+        m_min.clear();
+        m_max.clear();
+        m_count = 0;
+        return *this;
+    }
+
+    minmax &push(double x)
+    {
+        while (!m_min.empty() && !(m_min.back().second < x)) {
+            m_min.pop_back();
+        }
+        m_min.emplace_back(m_count, x);
+        while (!m_max.empty() && !(m_max.back().second > x)) {
+            m_max.pop_back();
+        }
+        m_max.emplace_back(m_count, x);
+
+        ++m_count;
+        if (m_min.front().first + m_window < m_count) {
+            m_min.pop_front();
+        }
+        if (m_max.front().first + m_window < m_count) {
+            m_max.pop_front();
+        }
+        return *this;
+    }
+
+    double min() const
+    {
+        return !m_min.empty() ? m_min.front().second
+                              : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    double max() const
+    {
+        return !m_max.empty() ? m_max.front().second
+                              : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    size_t size() const
+    {
+        return std::min(m_count, m_window);
+    }
+
+    size_t window() const
+    {
+        return m_window;
+    }
+
+  private:
+    // (push index, sample)
+    using queue = std::deque<std::pair<size_t, double>>;
+
+    size_t m_window, m_count;
+    queue m_min, m_max;
+};
+
+// quantile f of the last window samples, O(log window) per push.
+//
+// the window is split into two ordered sets: lo holds the lhs + 1
+// smallest samples and hi the others, lhs being the rank below the
+// quantile. the quantile is interpolated between the largest of lo and
+// the smallest of hi, as gsl_stats_quantile_from_sorted_data does on the
+// sorted window. samples must not be nan
+class order
+{
+  public:
+    order(size_t window, double f = 0.5)
+        : m_ring(window)
+        , m_f(f)
+    {
+        eigen_assert(f >= 0 && f <= 1);
+    }
+
+    order &reset()
+    {
+        m_ring.reset();
+        m_lo.clear();
+        m_hi.clear();
+        return *this;
+    }
+
+    order &push(double x)
+    {
+        eigen_assert(!std::isnan(x));
+
+        if (m_ring.full()) {
+            double old = m_ring.oldest();
+            if (!m_lo.empty() && !(*m_lo.rbegin() < old)) {
+                m_lo.erase(m_lo.find(old));
+            } else {
+                m_hi.erase(m_hi.find(old));
+            }
+        }
+        m_ring.push(x);
+
+        // lo may have been emptied by the eviction, then x is compared to
+        // the smallest of hi
+        bool lo = !m_lo.empty() ? !(*m_lo.rbegin() < x)
+                                : (m_hi.empty() || !(*m_hi.begin() < x));
+        if (lo) {
+            m_lo.insert(x);
+        } else {
+            m_hi.insert(x);
+        }
+
+        size_t n_lo = lhs() + 1;
+        while (m_lo.size() > n_lo) {
+            auto it = std::prev(m_lo.end());
+            m_hi.insert(*it);
+            m_lo.erase(it);
+        }
+        while (m_lo.size() < n_lo) {
+            m_lo.insert(*m_hi.begin());
+            m_hi.erase(m_hi.begin());
+        }
+        return *this;
+    }
+
+    double get() const
+    {
+        size_t n = m_ring.size();
+        if (n == 0) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+
+        double idx = m_f * (n - 1), delta = idx - lhs();
+        double a = *m_lo.rbegin();
+        if (lhs() == n - 1) {
+            return a;
+        }
+        return (1 - delta) * a + delta * (*m_hi.begin());
+    }
+
+    double fraction() const
+    {
+        return m_f;
+    }
+
+    size_t size() const
+    {
+        return m_ring.size();
+    }
+
+    size_t window() const
+    {
+        return m_ring.window();
+    }
+
+  private:
+    size_t lhs() const
+    {
+        return m_ring.size() > 0 ? (size_t)(m_f * (m_ring.size() - 1)) : 0;
+    }
+
+    ring m_ring;
+    double m_f;
+    std::multiset<double> m_lo, m_hi;
+};
+
+////////////////////////////////////////////////////////////
+// global variants
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// interface declaration
+////////////////////////////////////////////////////////////
+}
+
+IEXP_NS_END
+
+#endif /* __IEXP_MOVSTAT_WINDOW__ */
@@ -25,6 +25,7 @@
 
 #include <common/common.h>
 
+#include <rand/gamma.h>
 #include <rand/rng.h>
 
 #include <gsl/gsl_cdf.h>
@@ -76,6 +77,12 @@ class beta
             return gsl_ran_beta(m_rng.gsl(), m_a, m_b);
         }
 
+        rng &next(double x[], size_t n)
+        {
+            beta::fill(m_rng, x, n, m_a, m_b);
+            return *this;
+        }
+
       private:
         double m_a, m_b;
         rand::rng m_rng;
@@ -100,13 +107,31 @@ class beta
         static_assert(TYPE_IS(typename T::Scalar, double),
                       "only support double scalar");
 
-        double *data = x.derived().data();
-        for (Index i = 0; i < x.size(); ++i) {
-            data[i] = r.next();
-        }
+        r.next(x.derived().data(), x.size());
         return x.derived();
     }
 
+    // x / (x + y) with x ~ gamma(a, 1) and y ~ gamma(b, 1), both from the
+    // batched gamma kernel
+    static inline void fill(
+        rand::rng &r, double x[], size_t n, double a, double b)
+    {
+        double y[BLOCK];
+
+        for (size_t k = 0; k < n; k += BLOCK) {
+            size_t m = std::min<size_t>(BLOCK, n - k);
+            gamma::fill(r, &x[k], m, a, 1.0);
+            gamma::fill(r, y, m, b, 1.0);
+
+            for (size_t i = 0; i < m; ++i) {
+                double s = x[k + i] + y[i];
+                // both draws underflowed, gsl handles tiny a and b
+                x[k + i] =
+                    s > 0 ? x[k + i] / s : gsl_ran_beta(r.gsl(), a, b);
+            }
+        }
+    }
+
     // ========================================
     // distribution
     // ========================================
@@ -161,6 +186,11 @@ class beta
     }
 
   private:
+    enum
+    {
+        BLOCK = 256
+    };
+
     beta() = delete;
 
     template <typename T>
@@ -25,6 +25,8 @@
 
 #include <common/common.h>
 
+#include <common/packet.h>
+#include <math/constant.h>
 #include <rand/rng.h>
 
 #include <gsl/gsl_randist.h>
@@ -43,9 +45,6 @@ namespace rand {
 
 class cauchy
 {
-    template <typename T>
-    class pdf_functor;
-
   public:
     // ========================================
     // generator
@@ -144,41 +143,109 @@ class cauchy
         double m_a;
     };
 
-    template <typename T>
-    static inline CwiseNullaryOp<pdf_functor<T>,
-                                 typename pdf_functor<T>::ResultType>
-    pdf(const DenseBase<T> &x, double a)
+    // ========================================
+    // vectorized evaluation
+    // ========================================
+
+    class pdf_op
     {
-        using ResultType = typename pdf_functor<T>::ResultType;
-        return ResultType::NullaryExpr(x.rows(),
-                                       x.cols(),
-                                       pdf_functor<T>(x.derived(), a));
-    }
+      public:
+        pdf_op(double a)
+            : m_c(1.0 / (IEXP_PI * std::abs(a)))
+            , m_k(1.0 / a)
+        {
+        }
 
-  private:
-    cauchy() = delete;
+        double operator()(double x) const
+        {
+            double u = m_k * x;
+            return m_c / (1 + u * u);
+        }
 
-    template <typename T>
-    class pdf_functor
+        template <typename Packet>
+        Packet packetOp(const Packet &x) const
+        {
+            using namespace internal;
+            Packet u = pmul(pset1<Packet>(m_k), x);
+            Packet v = padd(pset1<Packet>(1), pmul(u, u));
+            return pdiv(pset1<Packet>(m_c), v);
+        }
+
+      private:
+        double m_c, m_k;
+    };
+
+    // atan has no packet version, p and q are scalar closed forms
+    class p_op
     {
       public:
-        using ResultType = typename dense_derive<T, double>::type;
+        p_op(double a)
+            : m_k(1.0 / a)
+        {
+        }
 
-        pdf_functor(const T &x, double a)
-            : m_x(x)
-            , m_dist(a)
+        double operator()(double x) const
+        {
+            double u = m_k * x;
+            if (u > -1) {
+                return 0.5 + std::atan(u) / IEXP_PI;
+            } else {
+                return std::atan(-1 / u) / IEXP_PI;
+            }
+        }
+
+      private:
+        double m_k;
+    };
+
+    class q_op
+    {
+      public:
+        q_op(double a)
+            : m_k(1.0 / a)
         {
         }
 
-        double operator()(Index i, Index j) const
+        double operator()(double x) const
         {
-            return m_dist.pdf((double)m_x(i, j));
+            double u = m_k * x;
+            if (u < 1) {
+                return 0.5 - std::atan(u) / IEXP_PI;
+            } else {
+                return std::atan(1 / u) / IEXP_PI;
+            }
         }
 
       private:
-        const T &m_x;
-        dist m_dist;
+        double m_k;
     };
+
+    template <typename T, typename A = typename packet::double_arg<T>::type>
+    static inline CwiseUnaryOp<pdf_op, const A> pdf(const DenseBase<T> &x,
+                                                    double a)
+    {
+        const A &xd = packet::double_arg<T>::get(x.derived());
+        return CwiseUnaryOp<pdf_op, const A>(xd, pdf_op(a));
+    }
+
+    template <typename T, typename A = typename packet::double_arg<T>::type>
+    static inline CwiseUnaryOp<p_op, const A> p(const DenseBase<T> &x,
+                                                double a)
+    {
+        const A &xd = packet::double_arg<T>::get(x.derived());
+        return CwiseUnaryOp<p_op, const A>(xd, p_op(a));
+    }
+
+    template <typename T, typename A = typename packet::double_arg<T>::type>
+    static inline CwiseUnaryOp<q_op, const A> q(const DenseBase<T> &x,
+                                                double a)
+    {
+        const A &xd = packet::double_arg<T>::get(x.derived());
+        return CwiseUnaryOp<q_op, const A>(xd, q_op(a));
+    }
+
+  private:
+    cauchy() = delete;
 };
 
 ////////////////////////////////////////////////////////////
@@ -190,6 +257,39 @@ class cauchy
 ////////////////////////////////////////////////////////////
 }
 
+namespace internal {
+
+template <>
+struct functor_traits<rand::cauchy::pdf_op>
+{
+    enum
+    {
+        Cost = 6 * NumTraits<double>::MulCost,
+        PacketAccess = packet_traits<double>::HasDiv
+    };
+};
+
+template <>
+struct functor_traits<rand::cauchy::p_op>
+{
+    enum
+    {
+        Cost = 30 * NumTraits<double>::MulCost,
+        PacketAccess = 0
+    };
+};
+
+template <>
+struct functor_traits<rand::cauchy::q_op>
+{
+    enum
+    {
+        Cost = 30 * NumTraits<double>::MulCost,
+        PacketAccess = 0
+    };
+};
+}
+
 IEXP_NS_END
 
 #endif /* __IEXP_RAND_CAUCHY__ */
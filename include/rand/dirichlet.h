@@ -25,6 +25,7 @@
 
 #include <common/common.h>
 
+#include <rand/gamma.h>
 #include <rand/rng.h>
 
 #include <gsl/gsl_randist.h>
@@ -76,6 +77,27 @@ class drch
             return *this;
         }
 
+        // n vectors stored back to back, each component is drawn for all
+        // vectors at once by the batched gamma kernel
+        rng &next(double theta[], size_t n)
+        {
+            for (size_t j = 0; j < m_k; ++j) {
+                gamma::fill(m_rng, &theta[j], n, m_alpha[j], 1.0, m_k);
+            }
+
+            Map<ArrayXXd> t(theta, m_k, n);
+            for (size_t i = 0; i < n; ++i) {
+                double sum = t.col(i).sum();
+                if (sum > 0) {
+                    t.col(i) /= sum;
+                } else {
+                    // every component underflowed, gsl handles tiny alpha
+                    next(&theta[i * m_k]);
+                }
+            }
+            return *this;
+        }
+
         size_t k() const
         {
             return m_k;
@@ -107,10 +129,7 @@ class drch
                       "only support double scalar");
         eigen_assert((theta.size() % r.k()) == 0);
 
-        double *data = theta.derived().data();
-        for (Index i = 0; i < theta.size(); i += r.k()) {
-            r.next(&data[i]);
-        }
+        r.next(theta.derived().data(), theta.size() / r.k());
         return theta.derived();
     }
 
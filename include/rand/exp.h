@@ -25,6 +25,8 @@
 
 #include <common/common.h>
 
+#include <common/packet.h>
+#include <math/constant.h>
 #include <rand/rng.h>
 
 #include <gsl/gsl_randist.h>
@@ -43,9 +45,6 @@ namespace rand {
 
 class exp
 {
-    template <typename T>
-    class pdf_functor;
-
   public:
     // ========================================
     // generator
@@ -144,41 +143,106 @@ class exp
         double m_mu;
     };
 
-    template <typename T>
-    static inline CwiseNullaryOp<pdf_functor<T>,
-                                 typename pdf_functor<T>::ResultType>
-    pdf(const DenseBase<T> &x, double mu)
+    // ========================================
+    // vectorized evaluation
+    // ========================================
+
+    class pdf_op
     {
-        using ResultType = typename pdf_functor<T>::ResultType;
-        return ResultType::NullaryExpr(x.rows(),
-                                       x.cols(),
-                                       pdf_functor<T>(x.derived(), mu));
-    }
+      public:
+        pdf_op(double mu)
+            : m_c(1.0 / mu)
+            , m_k(-1.0 / mu)
+        {
+        }
 
-  private:
-    exp() = delete;
+        double operator()(double x) const
+        {
+            return x < 0 ? 0 : m_c * std::exp(m_k * x);
+        }
 
-    template <typename T>
-    class pdf_functor
+        template <typename Packet>
+        Packet packetOp(const Packet &x) const
+        {
+            using namespace internal;
+            Packet z = pset1<Packet>(0);
+            Packet e = pexp(pmul(pset1<Packet>(m_k), x));
+            return packet::pselect_lt(x, z, z, pmul(pset1<Packet>(m_c), e));
+        }
+
+      private:
+        double m_c, m_k;
+    };
+
+    // expm1 has no packet version, p is a scalar closed form
+    class p_op
     {
       public:
-        using ResultType = typename dense_derive<T, double>::type;
+        p_op(double mu)
+            : m_k(-1.0 / mu)
+        {
+        }
+
+        double operator()(double x) const
+        {
+            return x < 0 ? 0 : -std::expm1(m_k * x);
+        }
+
+      private:
+        double m_k;
+    };
 
-        pdf_functor(const T &x, double mu)
-            : m_x(x)
-            , m_dist(mu)
+    class q_op
+    {
+      public:
+        q_op(double mu)
+            : m_k(-1.0 / mu)
         {
         }
 
-        double operator()(Index i, Index j) const
+        double operator()(double x) const
         {
-            return m_dist.pdf((double)m_x(i, j));
+            return x < 0 ? 1 : std::exp(m_k * x);
+        }
+
+        template <typename Packet>
+        Packet packetOp(const Packet &x) const
+        {
+            using namespace internal;
+            Packet e = pexp(pmul(pset1<Packet>(m_k), x));
+            return packet::pselect_lt(x, pset1<Packet>(0), pset1<Packet>(1), e);
         }
 
       private:
-        const T &m_x;
-        dist m_dist;
+        double m_k;
     };
+
+    template <typename T, typename A = typename packet::double_arg<T>::type>
+    static inline CwiseUnaryOp<pdf_op, const A> pdf(const DenseBase<T> &x,
+                                                    double mu)
+    {
+        const A &xd = packet::double_arg<T>::get(x.derived());
+        return CwiseUnaryOp<pdf_op, const A>(xd, pdf_op(mu));
+    }
+
+    template <typename T, typename A = typename packet::double_arg<T>::type>
+    static inline CwiseUnaryOp<p_op, const A> p(const DenseBase<T> &x,
+                                                double mu)
+    {
+        const A &xd = packet::double_arg<T>::get(x.derived());
+        return CwiseUnaryOp<p_op, const A>(xd, p_op(mu));
+    }
+
+    template <typename T, typename A = typename packet::double_arg<T>::type>
+    static inline CwiseUnaryOp<q_op, const A> q(const DenseBase<T> &x,
+                                                double mu)
+    {
+        const A &xd = packet::double_arg<T>::get(x.derived());
+        return CwiseUnaryOp<q_op, const A>(xd, q_op(mu));
+    }
+
+  private:
+    exp() = delete;
 };
 
 ////////////////////////////////////////////////////////////
@@ -190,6 +254,41 @@ class exp
 ////////////////////////////////////////////////////////////
 }
 
+namespace internal {
+
+template <>
+struct functor_traits<rand::exp::pdf_op>
+{
+    enum
+    {
+        Cost = 3 * NumTraits<double>::MulCost +
+               functor_traits<scalar_exp_op<double>>::Cost,
+        PacketAccess = packet_traits<double>::HasExp
+    };
+};
+
+template <>
+struct functor_traits<rand::exp::p_op>
+{
+    enum
+    {
+        Cost = 20 * NumTraits<double>::MulCost,
+        PacketAccess = 0
+    };
+};
+
+template <>
+struct functor_traits<rand::exp::q_op>
+{
+    enum
+    {
+        Cost = 2 * NumTraits<double>::MulCost +
+               functor_traits<scalar_exp_op<double>>::Cost,
+        PacketAccess = packet_traits<double>::HasExp
+    };
+};
+}
+
 IEXP_NS_END
 
 #endif /* __IEXP_RAND_EXP__ */
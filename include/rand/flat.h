@@ -25,6 +25,8 @@
 
 #include <common/common.h>
 
+#include <common/packet.h>
+#include <math/constant.h>
 #include <rand/rng.h>
 
 #include <gsl/gsl_randist.h>
@@ -43,9 +45,6 @@ namespace rand {
 
 class flat
 {
-    template <typename T>
-    class pdf_functor;
-
   public:
     // ========================================
     // generator
@@ -148,41 +147,136 @@ class flat
         double m_a, m_b;
     };
 
-    template <typename T>
-    static inline CwiseNullaryOp<pdf_functor<T>,
-                                 typename pdf_functor<T>::ResultType>
-    pdf(const DenseBase<T> &x, double a, double b)
+    // ========================================
+    // vectorized evaluation
+    // ========================================
+
+    class pdf_op
     {
-        using ResultType = typename pdf_functor<T>::ResultType;
-        return ResultType::NullaryExpr(x.rows(),
-                                       x.cols(),
-                                       pdf_functor<T>(x.derived(), a, b));
-    }
+      public:
+        pdf_op(double a, double b)
+            : m_a(a)
+            , m_b(b)
+            , m_c(1.0 / (b - a))
+        {
+        }
 
-  private:
-    flat() = delete;
+        double operator()(double x) const
+        {
+            return (x < m_b && x >= m_a) ? m_c : 0;
+        }
 
-    template <typename T>
-    class pdf_functor
+        template <typename Packet>
+        Packet packetOp(const Packet &x) const
+        {
+            using namespace internal;
+            Packet z = pset1<Packet>(0);
+            Packet c = packet::pselect_lt(
+                x, pset1<Packet>(m_b), pset1<Packet>(m_c), z);
+            return packet::pselect_lt(x, pset1<Packet>(m_a), z, c);
+        }
+
+      private:
+        double m_a, m_b, m_c;
+    };
+
+    class p_op
+    {
+      public:
+        p_op(double a, double b)
+            : m_a(a)
+            , m_b(b)
+            , m_c(1.0 / (b - a))
+        {
+        }
+
+        double operator()(double x) const
+        {
+            if (x < m_a) {
+                return 0;
+            } else if (x > m_b) {
+                return 1;
+            } else {
+                return (x - m_a) * m_c;
+            }
+        }
+
+        template <typename Packet>
+        Packet packetOp(const Packet &x) const
+        {
+            using namespace internal;
+            Packet a = pset1<Packet>(m_a);
+            Packet v = pmul(psub(x, a), pset1<Packet>(m_c));
+            v = packet::pselect_lt(pset1<Packet>(m_b), x, pset1<Packet>(1), v);
+            return packet::pselect_lt(x, a, pset1<Packet>(0), v);
+        }
+
+      private:
+        double m_a, m_b, m_c;
+    };
+
+    class q_op
     {
       public:
-        using ResultType = typename dense_derive<T, double>::type;
+        q_op(double a, double b)
+            : m_a(a)
+            , m_b(b)
+            , m_c(1.0 / (b - a))
+        {
+        }
 
-        pdf_functor(const T &x, double a, double b)
-            : m_x(x)
-            , m_dist(a, b)
+        double operator()(double x) const
         {
+            if (x < m_a) {
+                return 1;
+            } else if (x > m_b) {
+                return 0;
+            } else {
+                return (m_b - x) * m_c;
+            }
         }
 
-        double operator()(Index i, Index j) const
+        template <typename Packet>
+        Packet packetOp(const Packet &x) const
         {
-            return m_dist.pdf(m_x(i, j));
+            using namespace internal;
+            Packet b = pset1<Packet>(m_b);
+            Packet v = pmul(psub(b, x), pset1<Packet>(m_c));
+            v = packet::pselect_lt(b, x, pset1<Packet>(0), v);
+            return packet::pselect_lt(
+                x, pset1<Packet>(m_a), pset1<Packet>(1), v);
         }
 
       private:
-        const T &m_x;
-        dist m_dist;
+        double m_a, m_b, m_c;
     };
+
+    template <typename T, typename A = typename packet::double_arg<T>::type>
+    static inline CwiseUnaryOp<pdf_op, const A> pdf(const DenseBase<T> &x,
+                                                    double a, double b)
+    {
+        const A &xd = packet::double_arg<T>::get(x.derived());
+        return CwiseUnaryOp<pdf_op, const A>(xd, pdf_op(a, b));
+    }
+
+    template <typename T, typename A = typename packet::double_arg<T>::type>
+    static inline CwiseUnaryOp<p_op, const A> p(const DenseBase<T> &x,
+                                                double a, double b)
+    {
+        const A &xd = packet::double_arg<T>::get(x.derived());
+        return CwiseUnaryOp<p_op, const A>(xd, p_op(a, b));
+    }
+
+    template <typename T, typename A = typename packet::double_arg<T>::type>
+    static inline CwiseUnaryOp<q_op, const A> q(const DenseBase<T> &x,
+                                                double a, double b)
+    {
+        const A &xd = packet::double_arg<T>::get(x.derived());
+        return CwiseUnaryOp<q_op, const A>(xd, q_op(a, b));
+    }
+
+  private:
+    flat() = delete;
 };
 
 ////////////////////////////////////////////////////////////
@@ -194,6 +288,39 @@ class flat
 ////////////////////////////////////////////////////////////
 }
 
+namespace internal {
+
+template <>
+struct functor_traits<rand::flat::pdf_op>
+{
+    enum
+    {
+        Cost = 2 * NumTraits<double>::MulCost,
+        PacketAccess = 1
+    };
+};
+
+template <>
+struct functor_traits<rand::flat::p_op>
+{
+    enum
+    {
+        Cost = 4 * NumTraits<double>::MulCost,
+        PacketAccess = 1
+    };
+};
+
+template <>
+struct functor_traits<rand::flat::q_op>
+{
+    enum
+    {
+        Cost = 4 * NumTraits<double>::MulCost,
+        PacketAccess = 1
+    };
+};
+}
+
 IEXP_NS_END
 
 #endif /* __IEXP_RAND_FLAT__ */
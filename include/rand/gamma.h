@@ -25,6 +25,7 @@
 
 #include <common/common.h>
 
+#include <rand/gauss.h>
 #include <rand/rng.h>
 
 #include <gsl/gsl_randist.h>
@@ -75,6 +76,12 @@ class gamma
             return gsl_ran_gamma(m_rng.gsl(), m_a, m_b);
         }
 
+        rng &next(double x[], size_t n)
+        {
+            gamma::fill(m_rng, x, n, m_a, m_b);
+            return *this;
+        }
+
       private:
         double m_a, m_b;
         rand::rng m_rng;
@@ -99,13 +106,63 @@ class gamma
         static_assert(TYPE_IS(typename T::Scalar, double),
                       "only support double scalar");
 
-        double *data = x.derived().data();
-        for (Index i = 0; i < x.size(); ++i) {
-            data[i] = r.next();
-        }
+        r.next(x.derived().data(), x.size());
         return x.derived();
     }
 
+    // Marsaglia-Tsang, "A simple method for generating gamma variables",
+    // evaluated on blocks of normal and uniform deviates, writes n
+    // values to x[0], x[stride], ...
+    static inline void fill(rand::rng &r,
+                            double x[],
+                            size_t n,
+                            double a,
+                            double b,
+                            size_t stride = 1)
+    {
+        using block = Array<double, Dynamic, 1, ColMajor, MT_BLOCK, 1>;
+
+        eigen_assert((a > 0) && (b > 0));
+
+        // a < 1 is boosted to a + 1 and scaled by u^(1/a) afterwards
+        double d = (a < 1 ? a + 1 : a) - 1.0 / 3, c = 1 / std::sqrt(9 * d);
+        double norm[MT_BLOCK], unif[MT_BLOCK];
+
+        size_t k = 0;
+        while (k < n) {
+            // ~98% acceptance for a >= 1, a few extra candidates avoid
+            // most of the tail rounds
+            size_t left = n - k;
+            size_t m = std::min<size_t>(MT_BLOCK, left + left / 16 + 1);
+            gauss::fill(r, norm, m, 1.0);
+            r.uniform_pos_double(unif, m);
+
+            Map<block> z(norm, m), u(unif, m);
+            block v = (1 + c * z).cube();
+            block z2 = z.square();
+            // nan produced by log(v <= 0) fails every comparison
+            Array<bool, Dynamic, 1, ColMajor, MT_BLOCK, 1> ok =
+                (v > 0) && ((u < 1 - 0.0331 * z2.square()) ||
+                            (u.log() < 0.5 * z2 + d * (1 - v + v.log())));
+
+            for (size_t i = 0; (i < m) && (k < n); ++i) {
+                if (ok[i]) {
+                    x[k++ * stride] = d * v[i] * b;
+                }
+            }
+        }
+
+        if (a < 1) {
+            for (k = 0; k < n; k += MT_BLOCK) {
+                size_t m = std::min<size_t>(MT_BLOCK, n - k);
+                r.uniform_pos_double(unif, m);
+                for (size_t i = 0; i < m; ++i) {
+                    x[(k + i) * stride] *= std::pow(unif[i], 1 / a);
+                }
+            }
+        }
+    }
+
     // ========================================
     // distribution
     // ========================================
@@ -160,6 +217,11 @@ class gamma
     }
 
   private:
+    enum
+    {
+        MT_BLOCK = 256
+    };
+
     gamma() = delete;
 
     template <typename T>
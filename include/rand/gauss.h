@@ -25,6 +25,8 @@
 
 #include <common/common.h>
 
+#include <common/packet.h>
+#include <math/constant.h>
 #include <rand/rng.h>
 
 #include <gsl/gsl_randist.h>
@@ -43,9 +45,6 @@ namespace rand {
 
 class gauss
 {
-    template <typename T>
-    class pdf_functor;
-
   public:
     // ========================================
     // generator
@@ -73,6 +72,12 @@ class gauss
             return gsl_ran_gaussian_ziggurat(m_rng.gsl(), m_sigma);
         }
 
+        rng &next(double x[], size_t n)
+        {
+            gauss::fill(m_rng, x, n, m_sigma);
+            return *this;
+        }
+
       private:
         double m_sigma;
         rand::rng m_rng;
@@ -96,13 +101,19 @@ class gauss
         static_assert(TYPE_IS(typename T::Scalar, double),
                       "only support double scalar");
 
-        double *data = x.derived().data();
-        for (Index i = 0; i < x.size(); ++i) {
-            data[i] = r.next();
-        }
+        r.next(x.derived().data(), x.size());
         return x.derived();
     }
 
+    // n values from an external generator, one gsl call each, so that
+    // composite samplers (gamma, beta, ...) draw from one random stream
+    static inline void fill(rand::rng &r, double x[], size_t n, double sigma)
+    {
+        for (size_t i = 0; i < n; ++i) {
+            x[i] = gsl_ran_gaussian_ziggurat(r.gsl(), sigma);
+        }
+    }
+
     // ========================================
     // distribution
     // ========================================
@@ -144,41 +155,97 @@ class gauss
         double m_sigma;
     };
 
-    template <typename T>
-    static inline CwiseNullaryOp<pdf_functor<T>,
-                                 typename pdf_functor<T>::ResultType>
-    pdf(const DenseBase<T> &x, double sigma)
+    // ========================================
+    // vectorized evaluation
+    // ========================================
+
+    class pdf_op
     {
-        using ResultType = typename pdf_functor<T>::ResultType;
-        return ResultType::NullaryExpr(x.rows(),
-                                       x.cols(),
-                                       pdf_functor<T>(x.derived(), sigma));
-    }
+      public:
+        pdf_op(double sigma)
+            : m_c(1.0 / (std::sqrt(2.0 * IEXP_PI) * std::fabs(sigma)))
+            , m_k(-0.5 / (sigma * sigma))
+        {
+        }
 
-  private:
-    gauss() = delete;
+        double operator()(double x) const
+        {
+            return m_c * std::exp(m_k * x * x);
+        }
 
-    template <typename T>
-    class pdf_functor
+        template <typename Packet>
+        Packet packetOp(const Packet &x) const
+        {
+            using namespace internal;
+            Packet e = pexp(pmul(pset1<Packet>(m_k), pmul(x, x)));
+            return pmul(pset1<Packet>(m_c), e);
+        }
+
+      private:
+        double m_c, m_k;
+    };
+
+    // erfc has no packet version, p and q are scalar closed forms
+    class p_op
     {
       public:
-        using ResultType = typename dense_derive<T, double>::type;
+        p_op(double sigma)
+            : m_k(-1.0 / (sigma * IEXP_SQRT2))
+        {
+        }
 
-        pdf_functor(const T &x, double sigma)
-            : m_x(x)
-            , m_dist(sigma)
+        double operator()(double x) const
         {
+            return 0.5 * std::erfc(m_k * x);
         }
 
-        double operator()(Index i, Index j) const
+      private:
+        double m_k;
+    };
+
+    class q_op
+    {
+      public:
+        q_op(double sigma)
+            : m_k(1.0 / (sigma * IEXP_SQRT2))
+        {
+        }
+
+        double operator()(double x) const
         {
-            return m_dist.pdf(m_x(i, j));
+            return 0.5 * std::erfc(m_k * x);
         }
 
       private:
-        const T &m_x;
-        dist m_dist;
+        double m_k;
     };
+
+    template <typename T, typename A = typename packet::double_arg<T>::type>
+    static inline CwiseUnaryOp<pdf_op, const A> pdf(const DenseBase<T> &x,
+                                                    double sigma)
+    {
+        const A &xd = packet::double_arg<T>::get(x.derived());
+        return CwiseUnaryOp<pdf_op, const A>(xd, pdf_op(sigma));
+    }
+
+    template <typename T, typename A = typename packet::double_arg<T>::type>
+    static inline CwiseUnaryOp<p_op, const A> p(const DenseBase<T> &x,
+                                                double sigma)
+    {
+        const A &xd = packet::double_arg<T>::get(x.derived());
+        return CwiseUnaryOp<p_op, const A>(xd, p_op(sigma));
+    }
+
+    template <typename T, typename A = typename packet::double_arg<T>::type>
+    static inline CwiseUnaryOp<q_op, const A> q(const DenseBase<T> &x,
+                                                double sigma)
+    {
+        const A &xd = packet::double_arg<T>::get(x.derived());
+        return CwiseUnaryOp<q_op, const A>(xd, q_op(sigma));
+    }
+
+  private:
+    gauss() = delete;
 };
 
 ////////////////////////////////////////////////////////////
@@ -190,6 +257,40 @@ class gauss
 ////////////////////////////////////////////////////////////
 }
 
+namespace internal {
+
+template <>
+struct functor_traits<rand::gauss::pdf_op>
+{
+    enum
+    {
+        Cost = 4 * NumTraits<double>::MulCost +
+               functor_traits<scalar_exp_op<double>>::Cost,
+        PacketAccess = packet_traits<double>::HasExp
+    };
+};
+
+template <>
+struct functor_traits<rand::gauss::p_op>
+{
+    enum
+    {
+        Cost = 20 * NumTraits<double>::MulCost,
+        PacketAccess = 0
+    };
+};
+
+template <>
+struct functor_traits<rand::gauss::q_op>
+{
+    enum
+    {
+        Cost = 20 * NumTraits<double>::MulCost,
+        PacketAccess = 0
+    };
+};
+}
+
 IEXP_NS_END
 
 #endif /* __IEXP_RAND_GAUSS__ */
@@ -0,0 +1,415 @@
+/* Copyright (C) 2017 haniu (niuhao.cn@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef __IEXP_RAND_INVCDF__
+#define __IEXP_RAND_INVCDF__
+
+////////////////////////////////////////////////////////////
+// import header files
+////////////////////////////////////////////////////////////
+
+#include <common/common.h>
+
+#include <rand/rng.h>
+
+#include <algorithm>
+#include <vector>
+
+IEXP_NS_BEGIN
+
+namespace rand {
+
+////////////////////////////////////////////////////////////
+// macro definition
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// type definition
+////////////////////////////////////////////////////////////
+
+// inverse transform sampling from a tabulated quantile function. the
+// quantile function is evaluated once on an adaptively refined grid and
+// then approximated by a cubic hermite interpolant, three point slopes
+// kept monotone by hyman's filter, so each sample costs a table lookup
+// instead of an iterative gsl inversion. u in [1e-7, 1 - 1e-7] is
+// tabulated, the rare u outside it goes to the exact quantile function
+class invcdf
+{
+  public:
+    using func = std::function<double(double)>;
+
+    // ========================================
+    // table
+    // ========================================
+
+    class table
+    {
+      public:
+        enum
+        {
+            INIT_NODE = 65,
+            MAX_NODE = 1 << 20,
+        };
+
+        table(const func &invp, precision p = precision::SINGLE)
+            : m_invp(invp)
+        {
+            build(p);
+        }
+
+        // any distribution with a dist::invp, e.g. gamma::dist(2, 1.5)
+        template <typename D,
+                  typename = decltype(std::declval<const D &>().invp(0.5))>
+        table(const D &d, precision p = precision::SINGLE)
+            : m_invp([d](double u) { return d.invp(u); })
+        {
+            build(p);
+        }
+
+        double operator()(double u) const
+        {
+            if (!(u >= m_u.front() && u <= m_u.back())) {
+                return m_invp(u);
+            }
+
+            size_t k = m_guide[(size_t)((u - m_u.front()) * m_guide_scale)];
+            while (m_u[k + 1] < u) {
+                ++k;
+            }
+            return eval(k, u);
+        }
+
+        // in-place transform of uniforms
+        void operator()(double x[], size_t n) const
+        {
+            for (size_t i = 0; i < n; ++i) {
+                x[i] = operator()(x[i]);
+            }
+        }
+
+        // relative error targeted when tabulating. it is an estimate, the
+        // error at interval midpoints times a safety factor, not a bound
+        double tolerance() const
+        {
+            return m_tol;
+        }
+
+        size_t size() const
+        {
+            return m_u.size();
+        }
+
+      private:
+        static double tolerance(precision p)
+        {
+            switch (p) {
+                case precision::DOUBLE:
+                    // a cubic interpolant can not reach 2e-16, this is
+                    // about the accuracy of gsl's own iterative inversion
+                    return 1e-12;
+                case precision::SINGLE:
+                    return 1e-7;
+                case precision::APPROX:
+                default:
+                    return 5e-4;
+            }
+        }
+
+        double eval(size_t k, double u) const
+        {
+            double h = m_u[k + 1] - m_u[k];
+            double t = (u - m_u[k]) / h;
+            double t2 = t * t, t3 = t2 * t;
+            return (2 * t3 - 3 * t2 + 1) * m_y[k] +
+                   (t3 - 2 * t2 + t) * h * m_d[k] +
+                   (-2 * t3 + 3 * t2) * m_y[k + 1] +
+                   (t3 - t2) * h * m_d[k + 1];
+        }
+
+        double quantile(double u) const
+        {
+            double y = m_invp(u);
+            if (!std::isfinite(y)) {
+                RETURN_OR_THROW(std::invalid_argument("invcdf"));
+            }
+            return y;
+        }
+
+        // three point (parabolic) slopes with hyman's monotonicity filter,
+        // second order accurate where the harmonic mean slopes of
+        // fritsch-carlson are only first order
+        void slope()
+        {
+            size_t n = m_u.size();
+            std::vector<double> delta(n - 1);
+            for (size_t k = 0; k < n - 1; ++k) {
+                delta[k] = (m_y[k + 1] - m_y[k]) / (m_u[k + 1] - m_u[k]);
+            }
+
+            m_d.resize(n);
+            for (size_t k = 1; k < n - 1; ++k) {
+                double h0 = m_u[k] - m_u[k - 1];
+                double h1 = m_u[k + 1] - m_u[k];
+                m_d[k] = (h1 * delta[k - 1] + h0 * delta[k]) / (h0 + h1);
+            }
+            if (n > 2) {
+                double h0 = m_u[1] - m_u[0], h1 = m_u[2] - m_u[1];
+                m_d[0] = ((2 * h0 + h1) * delta[0] - h0 * delta[1]) / (h0 + h1);
+                h0 = m_u[n - 1] - m_u[n - 2];
+                h1 = m_u[n - 2] - m_u[n - 3];
+                m_d[n - 1] =
+                    ((2 * h0 + h1) * delta[n - 2] - h0 * delta[n - 3]) /
+                    (h0 + h1);
+            } else {
+                m_d[0] = m_d[1] = delta[0];
+            }
+
+            for (size_t k = 0; k < n; ++k) {
+                double dl = k > 0 ? delta[k - 1] : delta[k];
+                double dr = k < n - 1 ? delta[k] : delta[k - 1];
+                if (dl * dr <= 0 || m_d[k] * dl <= 0) {
+                    m_d[k] = 0;
+                } else {
+                    double m = 3 * std::min(std::fabs(dl), std::fabs(dr));
+                    if (std::fabs(m_d[k]) > m) {
+                        m_d[k] = m_d[k] > 0 ? m : -m;
+                    }
+                }
+            }
+        }
+
+        void build(precision p)
+        {
+            m_tol = tolerance(p);
+
+            // tanh spaced initial grid, denser towards both tails where
+            // the quantile function usually has most curvature
+            const double tail = 1e-7;
+            const double s0 = std::atanh(2 * tail - 1);
+            m_u.resize(INIT_NODE);
+            m_y.resize(INIT_NODE);
+            for (size_t i = 0; i < INIT_NODE; ++i) {
+                double s = s0 * (1 - 2.0 * i / (INIT_NODE - 1));
+                m_u[i] = 0.5 * (1 + std::tanh(s));
+            }
+            m_u.front() = tail;
+            m_u.back() = 1 - tail;
+            for (size_t i = 0; i < INIT_NODE; ++i) {
+                m_y[i] = quantile(m_u[i]);
+            }
+
+            // absolute floor of the tolerance, so that quantiles around
+            // zero do not require an infinitely fine grid
+            const double scale = std::fabs(quantile(0.75) - quantile(0.25));
+
+            // an interval is accepted when the interpolant matches the
+            // quantile function at its midpoint, otherwise the midpoint
+            // becomes a node. splitting an interval changes the end slopes
+            // of its neighbours, so they are checked again in next pass
+            std::vector<char> done(m_u.size() - 1, 0);
+            std::vector<double> u, y;
+            std::vector<char> d;
+            for (;;) {
+                slope();
+
+                bool refined = false, split = false;
+                u.clear();
+                y.clear();
+                d.clear();
+                for (size_t k = 0; k < m_u.size() - 1; ++k) {
+                    u.push_back(m_u[k]);
+                    y.push_back(m_y[k]);
+                    if (done[k] && !split) {
+                        d.push_back(1);
+                        continue;
+                    }
+
+                    double um = 0.5 * (m_u[k] + m_u[k + 1]);
+                    double ym = quantile(um);
+                    // the midpoint error underestimates the worst error of
+                    // the interval, so keep a wide margin. this estimates
+                    // the error, it does not bound it
+                    double err = std::fabs(eval(k, um) - ym) * 32;
+                    if ((err <= m_tol * (std::fabs(ym) + scale)) ||
+                        (um - m_u[k] <= 1e-15) ||
+                        (u.size() + m_u.size() - k >= MAX_NODE)) {
+                        d.push_back(split ? 0 : 1);
+                        split = false;
+                        continue;
+                    }
+
+                    if (!d.empty()) {
+                        d.back() = 0;
+                    }
+                    u.push_back(um);
+                    y.push_back(ym);
+                    d.push_back(0);
+                    d.push_back(0);
+                    split = true;
+                    refined = true;
+                }
+                u.push_back(m_u.back());
+                y.push_back(m_y.back());
+
+                m_u.swap(u);
+                m_y.swap(y);
+                done.swap(d);
+                if (!refined) {
+                    break;
+                }
+            }
+
+            // guide table: bucket b starts searching at the last node
+            // not greater than the bucket's left edge
+            size_t n = m_u.size();
+            m_guide.resize(n);
+            m_guide_scale = (n - 1) / (m_u.back() - m_u.front());
+            size_t k = 0;
+            for (size_t b = 0; b < n; ++b) {
+                double ub = m_u.front() + b / m_guide_scale;
+                while (k + 2 < n && m_u[k + 1] <= ub) {
+                    ++k;
+                }
+                m_guide[b] = k;
+            }
+            m_guide.push_back(n - 2);
+        }
+
+        func m_invp;
+        double m_tol;
+        std::vector<double> m_u, m_y, m_d;
+        std::vector<size_t> m_guide;
+        double m_guide_scale;
+    };
+
+    // ========================================
+    // generator
+    // ========================================
+
+    class rng
+    {
+      public:
+        rng(const table &t,
+            rand::rng::type type = DEFAULT_RNG_TYPE,
+            unsigned long seed = 0)
+            : m_table(t)
+            , m_rng(type, seed)
+        {
+        }
+
+        rng &seed(unsigned long seed)
+        {
+            m_rng.seed(seed);
+            return *this;
+        }
+
+        double next()
+        {
+            return m_table(m_rng.uniform_pos_double());
+        }
+
+        rng &next(double x[], size_t n)
+        {
+            m_rng.uniform_pos_double(x, n);
+            m_table(x, n);
+            return *this;
+        }
+
+      private:
+        table m_table;
+        rand::rng m_rng;
+    };
+
+    template <typename T>
+    static inline auto fill(DenseBase<T> &x,
+                            const table &t,
+                            unsigned long seed = 0,
+                            rand::rng::type type = DEFAULT_RNG_TYPE)
+        -> decltype(x.derived())
+    {
+        static_assert(TYPE_IS(typename T::Scalar, double),
+                      "only support double scalar");
+
+        // no need to copy the table into a rng
+        rand::rng r(type, seed);
+        double *data = x.derived().data();
+        r.uniform_pos_double(data, x.size());
+        t(data, x.size());
+        return x.derived();
+    }
+
+    template <typename T>
+    static inline auto fill(DenseBase<T> &x, invcdf::rng &r)
+        -> decltype(x.derived())
+    {
+        static_assert(TYPE_IS(typename T::Scalar, double),
+                      "only support double scalar");
+
+        r.next(x.derived().data(), x.size());
+        return x.derived();
+    }
+
+    // ========================================
+    // transform
+    // ========================================
+
+    // quantiles of given uniforms, e.g. copula or latin hypercube
+    // samples. the table must outlive the expression
+    class invp_op
+    {
+      public:
+        invp_op(const table &t)
+            : m_table(t)
+        {
+        }
+
+        double operator()(double u) const
+        {
+            return m_table(u);
+        }
+
+      private:
+        const table &m_table;
+    };
+
+    template <typename T>
+    static inline CwiseUnaryOp<invp_op, const T> invp(const DenseBase<T> &u,
+                                                      const table &t)
+    {
+        static_assert(TYPE_IS(typename T::Scalar, double),
+                      "only support double scalar");
+
+        return CwiseUnaryOp<invp_op, const T>(u.derived(), invp_op(t));
+    }
+
+  private:
+    invcdf() = delete;
+};
+
+////////////////////////////////////////////////////////////
+// global variants
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// indexerface declaration
+////////////////////////////////////////////////////////////
+}
+
+IEXP_NS_END
+
+#endif /* __IEXP_RAND_INVCDF__ */
@@ -25,6 +25,8 @@
 
 #include <common/common.h>
 
+#include <common/packet.h>
+#include <math/constant.h>
 #include <rand/rng.h>
 
 #include <gsl/gsl_randist.h>
@@ -43,9 +45,6 @@ namespace rand {
 
 class laplace
 {
-    template <typename T>
-    class pdf_functor;
-
   public:
     // ========================================
     // generator
@@ -144,41 +143,120 @@ class laplace
         double m_a;
     };
 
-    template <typename T>
-    static inline CwiseNullaryOp<pdf_functor<T>,
-                                 typename pdf_functor<T>::ResultType>
-    pdf(const DenseBase<T> &x, double a)
+    // ========================================
+    // vectorized evaluation
+    // ========================================
+
+    class pdf_op
     {
-        using ResultType = typename pdf_functor<T>::ResultType;
-        return ResultType::NullaryExpr(x.rows(),
-                                       x.cols(),
-                                       pdf_functor<T>(x.derived(), a));
-    }
+      public:
+        pdf_op(double a)
+            : m_c(0.5 / std::fabs(a))
+            , m_k(1.0 / a)
+        {
+        }
 
-  private:
-    laplace() = delete;
+        double operator()(double x) const
+        {
+            return m_c * std::exp(-std::fabs(m_k * x));
+        }
 
-    template <typename T>
-    class pdf_functor
+        template <typename Packet>
+        Packet packetOp(const Packet &x) const
+        {
+            using namespace internal;
+            Packet u = pabs(pmul(pset1<Packet>(m_k), x));
+            return pmul(pset1<Packet>(m_c), pexp(pnegate(u)));
+        }
+
+      private:
+        double m_c, m_k;
+    };
+
+    class p_op
+    {
+      public:
+        p_op(double a)
+            : m_k(1.0 / a)
+        {
+        }
+
+        double operator()(double x) const
+        {
+            double u = m_k * x;
+            double e = 0.5 * std::exp(-std::fabs(u));
+            return u < 0 ? e : 1 - e;
+        }
+
+        template <typename Packet>
+        Packet packetOp(const Packet &x) const
+        {
+            using namespace internal;
+            Packet u = pmul(pset1<Packet>(m_k), x);
+            Packet e = pmul(pset1<Packet>(0.5), pexp(pnegate(pabs(u))));
+            return packet::pselect_lt(
+                u, pset1<Packet>(0), e, psub(pset1<Packet>(1), e));
+        }
+
+      private:
+        double m_k;
+    };
+
+    class q_op
     {
       public:
-        using ResultType = typename dense_derive<T, double>::type;
+        q_op(double a)
+            : m_k(1.0 / a)
+        {
+        }
 
-        pdf_functor(const T &x, double a)
-            : m_x(x)
-            , m_dist(a)
+        double operator()(double x) const
         {
+            double u = m_k * x;
+            double e = 0.5 * std::exp(-std::fabs(u));
+            return u < 0 ? 1 - e : e;
         }
 
-        double operator()(Index i, Index j) const
+        template <typename Packet>
+        Packet packetOp(const Packet &x) const
         {
-            return m_dist.pdf(m_x(i, j));
+            using namespace internal;
+            Packet u = pmul(pset1<Packet>(m_k), x);
+            Packet e = pmul(pset1<Packet>(0.5), pexp(pnegate(pabs(u))));
+            return packet::pselect_lt(
+                u, pset1<Packet>(0), psub(pset1<Packet>(1), e), e);
         }
 
       private:
-        const T &m_x;
-        dist m_dist;
+        double m_k;
     };
+
+    template <typename T, typename A = typename packet::double_arg<T>::type>
+    static inline CwiseUnaryOp<pdf_op, const A> pdf(const DenseBase<T> &x,
+                                                    double a)
+    {
+        const A &xd = packet::double_arg<T>::get(x.derived());
+        return CwiseUnaryOp<pdf_op, const A>(xd, pdf_op(a));
+    }
+
+    template <typename T, typename A = typename packet::double_arg<T>::type>
+    static inline CwiseUnaryOp<p_op, const A> p(const DenseBase<T> &x,
+                                                double a)
+    {
+        const A &xd = packet::double_arg<T>::get(x.derived());
+        return CwiseUnaryOp<p_op, const A>(xd, p_op(a));
+    }
+
+    template <typename T, typename A = typename packet::double_arg<T>::type>
+    static inline CwiseUnaryOp<q_op, const A> q(const DenseBase<T> &x,
+                                                double a)
+    {
+        const A &xd = packet::double_arg<T>::get(x.derived());
+        return CwiseUnaryOp<q_op, const A>(xd, q_op(a));
+    }
+
+  private:
+    laplace() = delete;
 };
 
 ////////////////////////////////////////////////////////////
@@ -190,6 +268,42 @@ class laplace
 ////////////////////////////////////////////////////////////
 }
 
+namespace internal {
+
+template <>
+struct functor_traits<rand::laplace::pdf_op>
+{
+    enum
+    {
+        Cost = 3 * NumTraits<double>::MulCost +
+               functor_traits<scalar_exp_op<double>>::Cost,
+        PacketAccess = packet_traits<double>::HasExp
+    };
+};
+
+template <>
+struct functor_traits<rand::laplace::p_op>
+{
+    enum
+    {
+        Cost = 4 * NumTraits<double>::MulCost +
+               functor_traits<scalar_exp_op<double>>::Cost,
+        PacketAccess = packet_traits<double>::HasExp
+    };
+};
+
+template <>
+struct functor_traits<rand::laplace::q_op>
+{
+    enum
+    {
+        Cost = 4 * NumTraits<double>::MulCost +
+               functor_traits<scalar_exp_op<double>>::Cost,
+        PacketAccess = packet_traits<double>::HasExp
+    };
+};
+}
+
 IEXP_NS_END
 
 #endif /* __IEXP_RAND_LAPLACE__ */
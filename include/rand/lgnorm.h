@@ -25,6 +25,8 @@
 
 #include <common/common.h>
 
+#include <common/packet.h>
+#include <math/constant.h>
 #include <rand/rng.h>
 
 #include <gsl/gsl_randist.h>
@@ -43,9 +45,6 @@ namespace rand {
 
 class lgnorm
 {
-    template <typename T>
-    class pdf_functor;
-
   public:
     // ========================================
     // generator
@@ -148,43 +147,114 @@ class lgnorm
         double m_zeta, m_sigma;
     };
 
-    template <typename T>
-    static inline CwiseNullaryOp<pdf_functor<T>,
-                                 typename pdf_functor<T>::ResultType>
-    pdf(const DenseBase<T> &x, double zeta, double sigma)
+    // ========================================
+    // vectorized evaluation
+    // ========================================
+
+    // a packet log for double only exists in later eigen releases, the packet
+    // path below is enabled once packet_traits<double>::HasLog is set
+    class pdf_op
     {
-        using ResultType = typename pdf_functor<T>::ResultType;
-        return ResultType::NullaryExpr(x.rows(),
-                                       x.cols(),
-                                       pdf_functor<T>(x.derived(),
-                                                      zeta,
-                                                      sigma));
-    }
+      public:
+        pdf_op(double zeta, double sigma)
+            : m_zeta(zeta)
+            , m_c(1.0 / (std::fabs(sigma) * std::sqrt(2.0 * IEXP_PI)))
+            , m_k(-0.5 / (sigma * sigma))
+        {
+        }
 
-  private:
-    lgnorm() = delete;
+        double operator()(double x) const
+        {
+            if (x <= 0) {
+                return 0;
+            }
+            double u = std::log(x) - m_zeta;
+            return m_c / x * std::exp(m_k * u * u);
+        }
 
-    template <typename T>
-    class pdf_functor
+        template <typename Packet>
+        Packet packetOp(const Packet &x) const
+        {
+            using namespace internal;
+            Packet u = psub(plog(x), pset1<Packet>(m_zeta));
+            Packet e = pexp(pmul(pset1<Packet>(m_k), pmul(u, u)));
+            Packet v = pdiv(pmul(pset1<Packet>(m_c), e), x);
+            return packet::pselect_le(x, pset1<Packet>(0), pset1<Packet>(0), v);
+        }
+
+      private:
+        double m_zeta, m_c, m_k;
+    };
+
+    // erfc has no packet version, p and q are scalar closed forms
+    class p_op
     {
       public:
-        using ResultType = typename dense_derive<T, double>::type;
+        p_op(double zeta, double sigma)
+            : m_zeta(zeta)
+            , m_k(-1.0 / (sigma * IEXP_SQRT2))
+        {
+        }
 
-        pdf_functor(const T &x, double zeta, double sigma)
-            : m_x(x)
-            , m_dist(zeta, sigma)
+        double operator()(double x) const
         {
+            if (x <= 0) {
+                return 0;
+            }
+            return 0.5 * std::erfc(m_k * (std::log(x) - m_zeta));
         }
 
-        double operator()(Index i, Index j) const
+      private:
+        double m_zeta, m_k;
+    };
+
+    class q_op
+    {
+      public:
+        q_op(double zeta, double sigma)
+            : m_zeta(zeta)
+            , m_k(1.0 / (sigma * IEXP_SQRT2))
         {
-            return m_dist.pdf(m_x(i, j));
+        }
+
+        double operator()(double x) const
+        {
+            if (x <= 0) {
+                return 1;
+            }
+            return 0.5 * std::erfc(m_k * (std::log(x) - m_zeta));
         }
 
       private:
-        const T &m_x;
-        dist m_dist;
+        double m_zeta, m_k;
     };
+
+    template <typename T, typename A = typename packet::double_arg<T>::type>
+    static inline CwiseUnaryOp<pdf_op, const A> pdf(const DenseBase<T> &x,
+                                                    double zeta, double sigma)
+    {
+        const A &xd = packet::double_arg<T>::get(x.derived());
+        return CwiseUnaryOp<pdf_op, const A>(xd, pdf_op(zeta, sigma));
+    }
+
+    template <typename T, typename A = typename packet::double_arg<T>::type>
+    static inline CwiseUnaryOp<p_op, const A> p(const DenseBase<T> &x,
+                                                double zeta, double sigma)
+    {
+        const A &xd = packet::double_arg<T>::get(x.derived());
+        return CwiseUnaryOp<p_op, const A>(xd, p_op(zeta, sigma));
+    }
+
+    template <typename T, typename A = typename packet::double_arg<T>::type>
+    static inline CwiseUnaryOp<q_op, const A> q(const DenseBase<T> &x,
+                                                double zeta, double sigma)
+    {
+        const A &xd = packet::double_arg<T>::get(x.derived());
+        return CwiseUnaryOp<q_op, const A>(xd, q_op(zeta, sigma));
+    }
+
+  private:
+    lgnorm() = delete;
 };
 
 ////////////////////////////////////////////////////////////
@@ -196,6 +266,42 @@ class lgnorm
 ////////////////////////////////////////////////////////////
 }
 
+namespace internal {
+
+template <>
+struct functor_traits<rand::lgnorm::pdf_op>
+{
+    enum
+    {
+        Cost = 5 * NumTraits<double>::MulCost +
+               2 * functor_traits<scalar_exp_op<double>>::Cost,
+        PacketAccess = (packet_traits<double>::HasExp &&
+                        packet_traits<double>::HasDiv &&
+                        packet_traits<double>::HasLog)
+    };
+};
+
+template <>
+struct functor_traits<rand::lgnorm::p_op>
+{
+    enum
+    {
+        Cost = 40 * NumTraits<double>::MulCost,
+        PacketAccess = 0
+    };
+};
+
+template <>
+struct functor_traits<rand::lgnorm::q_op>
+{
+    enum
+    {
+        Cost = 40 * NumTraits<double>::MulCost,
+        PacketAccess = 0
+    };
+};
+}
+
 IEXP_NS_END
 
 #endif /* __IEXP_RAND_LGNORM__ */
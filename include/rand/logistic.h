@@ -25,6 +25,8 @@
 
 #include <common/common.h>
 
+#include <common/packet.h>
+#include <math/constant.h>
 #include <rand/rng.h>
 
 #include <gsl/gsl_randist.h>
@@ -43,9 +45,6 @@ namespace rand {
 
 class lgst
 {
-    template <typename T>
-    class pdf_functor;
-
   public:
     // ========================================
     // generator
@@ -144,41 +143,124 @@ class lgst
         double m_a;
     };
 
-    template <typename T>
-    static inline CwiseNullaryOp<pdf_functor<T>,
-                                 typename pdf_functor<T>::ResultType>
-    pdf(const DenseBase<T> &x, double a)
+    // ========================================
+    // vectorized evaluation
+    // ========================================
+
+    class pdf_op
     {
-        using ResultType = typename pdf_functor<T>::ResultType;
-        return ResultType::NullaryExpr(x.rows(),
-                                       x.cols(),
-                                       pdf_functor<T>(x.derived(), a));
-    }
+      public:
+        pdf_op(double a)
+            : m_c(1.0 / std::fabs(a))
+            , m_k(-1.0 / a)
+        {
+        }
 
-  private:
-    lgst() = delete;
+        double operator()(double x) const
+        {
+            double u = std::exp(m_k * std::fabs(x));
+            return m_c * u / ((1 + u) * (1 + u));
+        }
 
-    template <typename T>
-    class pdf_functor
+        template <typename Packet>
+        Packet packetOp(const Packet &x) const
+        {
+            using namespace internal;
+            Packet u = pexp(pmul(pset1<Packet>(m_k), pabs(x)));
+            Packet v = padd(pset1<Packet>(1), u);
+            return pdiv(pmul(pset1<Packet>(m_c), u), pmul(v, v));
+        }
+
+      private:
+        double m_c, m_k;
+    };
+
+    class p_op
+    {
+      public:
+        p_op(double a)
+            : m_k(1.0 / a)
+        {
+        }
+
+        double operator()(double x) const
+        {
+            double u = m_k * x;
+            double e = std::exp(-std::fabs(u));
+            return u < 0 ? e / (1 + e) : 1 / (1 + e);
+        }
+
+        template <typename Packet>
+        Packet packetOp(const Packet &x) const
+        {
+            using namespace internal;
+            Packet u = pmul(pset1<Packet>(m_k), x);
+            Packet e = pexp(pnegate(pabs(u)));
+            Packet v = padd(pset1<Packet>(1), e);
+            return packet::pselect_lt(
+                u, pset1<Packet>(0), pdiv(e, v), pdiv(pset1<Packet>(1), v));
+        }
+
+      private:
+        double m_k;
+    };
+
+    class q_op
     {
       public:
-        using ResultType = typename dense_derive<T, double>::type;
+        q_op(double a)
+            : m_k(1.0 / a)
+        {
+        }
 
-        pdf_functor(const T &x, double a)
-            : m_x(x)
-            , m_dist(a)
+        double operator()(double x) const
         {
+            double u = m_k * x;
+            double e = std::exp(-std::fabs(u));
+            return u < 0 ? 1 / (1 + e) : e / (1 + e);
         }
 
-        double operator()(Index i, Index j) const
+        template <typename Packet>
+        Packet packetOp(const Packet &x) const
         {
-            return m_dist.pdf(m_x(i, j));
+            using namespace internal;
+            Packet u = pmul(pset1<Packet>(m_k), x);
+            Packet e = pexp(pnegate(pabs(u)));
+            Packet v = padd(pset1<Packet>(1), e);
+            return packet::pselect_lt(
+                u, pset1<Packet>(0), pdiv(pset1<Packet>(1), v), pdiv(e, v));
         }
 
       private:
-        const T &m_x;
-        dist m_dist;
+        double m_k;
     };
+
+    template <typename T, typename A = typename packet::double_arg<T>::type>
+    static inline CwiseUnaryOp<pdf_op, const A> pdf(const DenseBase<T> &x,
+                                                    double a)
+    {
+        const A &xd = packet::double_arg<T>::get(x.derived());
+        return CwiseUnaryOp<pdf_op, const A>(xd, pdf_op(a));
+    }
+
+    template <typename T, typename A = typename packet::double_arg<T>::type>
+    static inline CwiseUnaryOp<p_op, const A> p(const DenseBase<T> &x,
+                                                double a)
+    {
+        const A &xd = packet::double_arg<T>::get(x.derived());
+        return CwiseUnaryOp<p_op, const A>(xd, p_op(a));
+    }
+
+    template <typename T, typename A = typename packet::double_arg<T>::type>
+    static inline CwiseUnaryOp<q_op, const A> q(const DenseBase<T> &x,
+                                                double a)
+    {
+        const A &xd = packet::double_arg<T>::get(x.derived());
+        return CwiseUnaryOp<q_op, const A>(xd, q_op(a));
+    }
+
+  private:
+    lgst() = delete;
 };
 
 ////////////////////////////////////////////////////////////
@@ -190,6 +272,45 @@ class lgst
 ////////////////////////////////////////////////////////////
 }
 
+namespace internal {
+
+template <>
+struct functor_traits<rand::lgst::pdf_op>
+{
+    enum
+    {
+        Cost = 5 * NumTraits<double>::MulCost +
+               functor_traits<scalar_exp_op<double>>::Cost,
+        PacketAccess = (packet_traits<double>::HasExp &&
+                        packet_traits<double>::HasDiv)
+    };
+};
+
+template <>
+struct functor_traits<rand::lgst::p_op>
+{
+    enum
+    {
+        Cost = 6 * NumTraits<double>::MulCost +
+               functor_traits<scalar_exp_op<double>>::Cost,
+        PacketAccess = (packet_traits<double>::HasExp &&
+                        packet_traits<double>::HasDiv)
+    };
+};
+
+template <>
+struct functor_traits<rand::lgst::q_op>
+{
+    enum
+    {
+        Cost = 6 * NumTraits<double>::MulCost +
+               functor_traits<scalar_exp_op<double>>::Cost,
+        PacketAccess = (packet_traits<double>::HasExp &&
+                        packet_traits<double>::HasDiv)
+    };
+};
+}
+
 IEXP_NS_END
 
 #endif /* __IEXP_RAND_LOGISTIC__ */
@@ -25,6 +25,8 @@
 
 #include <common/common.h>
 
+#include <common/packet.h>
+#include <math/constant.h>
 #include <rand/rng.h>
 
 #include <gsl/gsl_randist.h>
@@ -43,9 +45,6 @@ namespace rand {
 
 class rayl
 {
-    template <typename T>
-    class pdf_functor;
-
   public:
     // ========================================
     // generator
@@ -124,41 +123,105 @@ class rayl
         double m_sigma;
     };
 
-    template <typename T>
-    static inline CwiseNullaryOp<pdf_functor<T>,
-                                 typename pdf_functor<T>::ResultType>
-    pdf(const DenseBase<T> &x, double sigma)
+    // ========================================
+    // vectorized evaluation
+    // ========================================
+
+    class pdf_op
     {
-        using ResultType = typename pdf_functor<T>::ResultType;
-        return ResultType::NullaryExpr(x.rows(),
-                                       x.cols(),
-                                       pdf_functor<T>(x.derived(), sigma));
-    }
+      public:
+        pdf_op(double sigma)
+            : m_c(1.0 / (sigma * sigma))
+            , m_k(-0.5 / (sigma * sigma))
+        {
+        }
 
-  private:
-    rayl() = delete;
+        double operator()(double x) const
+        {
+            return x < 0 ? 0 : m_c * x * std::exp(m_k * x * x);
+        }
 
-    template <typename T>
-    class pdf_functor
+        template <typename Packet>
+        Packet packetOp(const Packet &x) const
+        {
+            using namespace internal;
+            Packet e = pexp(pmul(pset1<Packet>(m_k), pmul(x, x)));
+            Packet v = pmul(pmul(pset1<Packet>(m_c), x), e);
+            return packet::pselect_lt(x, pset1<Packet>(0), pset1<Packet>(0), v);
+        }
+
+      private:
+        double m_c, m_k;
+    };
+
+    // expm1 has no packet version, p is a scalar closed form
+    class p_op
     {
       public:
-        using ResultType = typename dense_derive<T, double>::type;
+        p_op(double sigma)
+            : m_k(-0.5 / (sigma * sigma))
+        {
+        }
+
+        double operator()(double x) const
+        {
+            return -std::expm1(m_k * x * x);
+        }
+
+      private:
+        double m_k;
+    };
 
-        pdf_functor(const T &x, double sigma)
-            : m_x(x)
-            , m_dist(sigma)
+    class q_op
+    {
+      public:
+        q_op(double sigma)
+            : m_k(-0.5 / (sigma * sigma))
         {
         }
 
-        double operator()(Index i, Index j) const
+        double operator()(double x) const
         {
-            return m_dist.pdf(m_x(i, j));
+            return std::exp(m_k * x * x);
+        }
+
+        template <typename Packet>
+        Packet packetOp(const Packet &x) const
+        {
+            using namespace internal;
+            return pexp(pmul(pset1<Packet>(m_k), pmul(x, x)));
         }
 
       private:
-        const T &m_x;
-        dist m_dist;
+        double m_k;
     };
+
+    template <typename T, typename A = typename packet::double_arg<T>::type>
+    static inline CwiseUnaryOp<pdf_op, const A> pdf(const DenseBase<T> &x,
+                                                    double sigma)
+    {
+        const A &xd = packet::double_arg<T>::get(x.derived());
+        return CwiseUnaryOp<pdf_op, const A>(xd, pdf_op(sigma));
+    }
+
+    template <typename T, typename A = typename packet::double_arg<T>::type>
+    static inline CwiseUnaryOp<p_op, const A> p(const DenseBase<T> &x,
+                                                double sigma)
+    {
+        const A &xd = packet::double_arg<T>::get(x.derived());
+        return CwiseUnaryOp<p_op, const A>(xd, p_op(sigma));
+    }
+
+    template <typename T, typename A = typename packet::double_arg<T>::type>
+    static inline CwiseUnaryOp<q_op, const A> q(const DenseBase<T> &x,
+                                                double sigma)
+    {
+        const A &xd = packet::double_arg<T>::get(x.derived());
+        return CwiseUnaryOp<q_op, const A>(xd, q_op(sigma));
+    }
+
+  private:
+    rayl() = delete;
 };
 
 ////////////////////////////////////////////////////////////
@@ -170,6 +233,41 @@ class rayl
 ////////////////////////////////////////////////////////////
 }
 
+namespace internal {
+
+template <>
+struct functor_traits<rand::rayl::pdf_op>
+{
+    enum
+    {
+        Cost = 4 * NumTraits<double>::MulCost +
+               functor_traits<scalar_exp_op<double>>::Cost,
+        PacketAccess = packet_traits<double>::HasExp
+    };
+};
+
+template <>
+struct functor_traits<rand::rayl::p_op>
+{
+    enum
+    {
+        Cost = 20 * NumTraits<double>::MulCost,
+        PacketAccess = 0
+    };
+};
+
+template <>
+struct functor_traits<rand::rayl::q_op>
+{
+    enum
+    {
+        Cost = 2 * NumTraits<double>::MulCost +
+               functor_traits<scalar_exp_op<double>>::Cost,
+        PacketAccess = packet_traits<double>::HasExp
+    };
+};
+}
+
 IEXP_NS_END
 
 #endif /* __IEXP_RAND_RAYLEIGH__ */
@@ -0,0 +1,287 @@
+/* Copyright (C) 2017 haniu (niuhao.cn@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef __IEXP_RAND_RESERVOIR__
+#define __IEXP_RAND_RESERVOIR__
+
+////////////////////////////////////////////////////////////
+// import header files
+////////////////////////////////////////////////////////////
+
+#include <common/common.h>
+
+#include <rand/rng.h>
+
+#include <algorithm>
+#include <vector>
+
+IEXP_NS_BEGIN
+
+namespace rand {
+
+////////////////////////////////////////////////////////////
+// macro definition
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// type definition
+////////////////////////////////////////////////////////////
+
+// one pass sampling of k items without replacement from a stream of
+// unknown length, uniform or weighted (efraimidis-spirakis a-expj).
+//
+// every item gets a random key log(u) / w and the reservoir keeps the k
+// largest keys in a min heap, so memory is O(k) whatever the stream
+// length. exponential jumps skip the items that can not enter the
+// reservoir with a single random number per jump. since keys of distinct
+// items are independent, the top k keys of two reservoirs are exactly a
+// sample of the concatenated streams, which makes reservoirs mergeable
+template <typename T = double>
+class reservoir
+{
+  public:
+    reservoir(size_t k,
+              unsigned long seed = 0,
+              rng::type type = DEFAULT_RNG_TYPE)
+        : m_k(k)
+        , m_count(0)
+        , m_weight(0)
+        , m_jump(0)
+        , m_rng(type, seed)
+    {
+        eigen_assert(k > 0);
+        m_heap.reserve(k);
+    }
+
+    reservoir &add(const T &x, double w = 1.0)
+    {
+        ++m_count;
+        if (!(w > 0)) {
+            return *this;
+        }
+        m_weight += w;
+
+        if (m_heap.size() < m_k) {
+            push(std::log(m_rng.uniform_pos_double()) / w, x);
+            if (m_heap.size() == m_k) {
+                jump();
+            }
+            return *this;
+        }
+
+        m_jump -= w;
+        if (m_jump > 0) {
+            return *this;
+        }
+
+        // the item beats the threshold: its key is uniform on the part
+        // of (0, 1) above it
+        double t = std::exp(m_heap.front().first * w);
+        double u = t + (1 - t) * m_rng.uniform_pos_double();
+        std::pop_heap(m_heap.begin(), m_heap.end(), greater);
+        m_heap.pop_back();
+        push(std::log(u) / w, x);
+        jump();
+        return *this;
+    }
+
+    template <typename U>
+    reservoir &add(const DenseBase<U> &x)
+    {
+        typename type_eval<U>::type m_x(x.eval());
+        const typename U::Scalar *data = m_x.data();
+        for (Index i = 0; i < m_x.size(); ++i) {
+            add((T)data[i]);
+        }
+        return *this;
+    }
+
+    template <typename U, typename V>
+    reservoir &add(const DenseBase<U> &x, const DenseBase<V> &w)
+    {
+        eigen_assert(x.size() == w.size());
+
+        typename type_eval<U>::type m_x(x.eval());
+        typename type_eval<V>::type m_w(w.eval());
+        const typename U::Scalar *data = m_x.data();
+        const typename V::Scalar *weight = m_w.data();
+        for (Index i = 0; i < m_x.size(); ++i) {
+            add((T)data[i], (double)weight[i]);
+        }
+        return *this;
+    }
+
+    // sample of both streams, e.g. reservoirs filled by different threads.
+    // the reservoirs should have been seeded differently
+    reservoir &merge(const reservoir &other)
+    {
+        eigen_assert(m_k == other.m_k);
+
+        for (const auto &e : other.m_heap) {
+            if (m_heap.size() < m_k) {
+                push(e.first, e.second);
+            } else if (e.first > m_heap.front().first) {
+                std::pop_heap(m_heap.begin(), m_heap.end(), greater);
+                m_heap.pop_back();
+                push(e.first, e.second);
+            }
+        }
+        m_count += other.m_count;
+        m_weight += other.m_weight;
+
+        // the threshold has changed, the pending jump is redrawn which is
+        // valid as future keys are independent of the past
+        if (m_heap.size() == m_k) {
+            jump();
+        }
+        return *this;
+    }
+
+    reservoir &clear()
+    {
+        m_heap.clear();
+        m_count = 0;
+        m_weight = 0;
+        m_jump = 0;
+        return *this;
+    }
+
+    // sampled items, in no particular order
+    Matrix<T, Dynamic, 1> sample() const
+    {
+        Matrix<T, Dynamic, 1> s(m_heap.size());
+        for (size_t i = 0; i < m_heap.size(); ++i) {
+            s[i] = m_heap[i].second;
+        }
+        return s;
+    }
+
+    size_t size() const
+    {
+        return m_heap.size();
+    }
+
+    size_t capacity() const
+    {
+        return m_k;
+    }
+
+    // items seen, including those of merged reservoirs
+    size_t count() const
+    {
+        return m_count;
+    }
+
+    double weight() const
+    {
+        return m_weight;
+    }
+
+  private:
+    using entry = std::pair<double, T>;
+
+    static bool greater(const entry &a, const entry &b)
+    {
+        return a.first > b.first;
+    }
+
+    void push(double key, const T &x)
+    {
+        m_heap.push_back(entry(key, x));
+        std::push_heap(m_heap.begin(), m_heap.end(), greater);
+    }
+
+    // weight to skip before the next item enters the reservoir
+    void jump()
+    {
+        m_jump = std::log(m_rng.uniform_pos_double()) / m_heap.front().first;
+    }
+
+    size_t m_k;
+    size_t m_count;
+    double m_weight;
+    double m_jump;
+    std::vector<entry> m_heap;
+    rng m_rng;
+};
+
+template <bool row_form, typename T>
+class wsample_functor
+{
+  public:
+    using Scalar = typename T::Scalar;
+    using ResultType = typename dense_derive<T,
+                                             Scalar,
+                                             row_form ? 1 : Dynamic,
+                                             row_form ? Dynamic : 1>::type;
+
+    template <typename W>
+    wsample_functor(const T &x,
+                    const W &w,
+                    size_t k,
+                    rng::type type,
+                    unsigned long seed)
+    {
+        reservoir<Scalar> r(k, seed, type);
+        r.add(x, w);
+        m_result = std::make_shared<Matrix<Scalar, Dynamic, 1>>(r.sample());
+    }
+
+    Scalar operator()(Index i) const
+    {
+        return (*m_result)[i];
+    }
+
+    Index size() const
+    {
+        return m_result->size();
+    }
+
+  private:
+    std::shared_ptr<Matrix<Scalar, Dynamic, 1>> m_result;
+};
+
+////////////////////////////////////////////////////////////
+// global variants
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// indexerface declaration
+////////////////////////////////////////////////////////////
+
+// k items of x without replacement, item i being drawn with probability
+// proportional to w[i]. items of zero weight are never drawn, so fewer
+// than k items are returned if less than k weights are positive
+template <bool row_form = false, typename T = void, typename W = void>
+inline CwiseNullaryOp<wsample_functor<row_form, T>,
+                      typename wsample_functor<row_form, T>::ResultType>
+wsample(const DenseBase<T> &x,
+        const DenseBase<W> &w,
+        size_t k,
+        unsigned long seed = 0,
+        rng::type type = DEFAULT_RNG_TYPE)
+{
+    using ResultType = typename wsample_functor<row_form, T>::ResultType;
+    wsample_functor<row_form, T> f(x.derived(), w.derived(), k, type, seed);
+    return ResultType::NullaryExpr(f.size(), f);
+}
+}
+
+IEXP_NS_END
+
+#endif /* __IEXP_RAND_RESERVOIR__ */
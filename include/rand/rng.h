@@ -178,6 +178,22 @@ class rng
         return gsl_rng_uniform_pos(m_rng);
     }
 
+    // [0, 1), n values
+    void uniform_double(double x[], size_t n) const
+    {
+        for (size_t i = 0; i < n; ++i) {
+            x[i] = gsl_rng_uniform(m_rng);
+        }
+    }
+
+    // (0, 1), n values
+    void uniform_pos_double(double x[], size_t n) const
+    {
+        for (size_t i = 0; i < n; ++i) {
+            x[i] = gsl_rng_uniform_pos(m_rng);
+        }
+    }
+
     const char *name() const
     {
         return gsl_rng_name(m_rng);
@@ -25,6 +25,7 @@
 
 #include <common/common.h>
 
+#include <common/parallel.h>
 #include <rand/rng.h>
 
 #include <gsl/gsl_randist.h>
@@ -41,15 +42,130 @@ namespace rand {
 // type definition
 ////////////////////////////////////////////////////////////
 
+// parallel merge shuffle (bacher, bodini, hollender and lumbroso). the
+// array is cut into blocks of fixed size which are fisher-yates shuffled
+// independently, then neighbouring runs are merged level by level. every
+// block and every merge has its own generator derived from the seed, so
+// the result depends on the seed only and not on the thread count. each
+// merge walks its two runs sequentially, hence cache friendly
+class merge_shuffle
+{
+  public:
+    enum
+    {
+        BLOCK = 1 << 16,
+    };
+
+    template <typename Scalar>
+    static void run(Scalar x[], size_t n, unsigned long seed, rng::type type)
+    {
+        size_t nblock = (n + BLOCK - 1) / BLOCK;
+        parallel::run(nblock, [&](size_t b) {
+            rng r(type, mix(seed, 0, b));
+            size_t start = b * BLOCK;
+            shuffle(x + start, std::min<size_t>(BLOCK, n - start), r);
+        });
+
+        size_t level = 1;
+        for (size_t w = BLOCK; w < n; w *= 2, ++level) {
+            size_t nmerge = (n + 2 * w - 1) / (2 * w);
+            parallel::run(nmerge, [&](size_t m) {
+                size_t start = m * 2 * w;
+                size_t mid = start + w;
+                if (mid < n) {
+                    rng r(type, mix(seed, level, m));
+                    merge(x, start, mid, std::min(start + 2 * w, n), r);
+                }
+            });
+        }
+    }
+
+  private:
+    // independent seed per (level, index), splitmix64 finalizer
+    static unsigned long mix(unsigned long seed, size_t level, size_t index)
+    {
+        uint64_t z = (uint64_t)seed + 0x9e3779b97f4a7c15ULL * (level + 1) +
+                     0xbf58476d1ce4e5b9ULL * (index + 1);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return (unsigned long)(z ^ (z >> 31));
+    }
+
+    template <typename Scalar>
+    static void shuffle(Scalar x[], size_t n, rng &r)
+    {
+        for (size_t i = n; i > 1; --i) {
+            std::swap(x[i - 1], x[r.uniform_ulong(i)]);
+        }
+    }
+
+    // random bits, 16 at a time when the generator has the range
+    class bits
+    {
+      public:
+        bits(rng &r)
+            : m_rng(r)
+            , m_wide(r.max() - r.min() >= 0xffff)
+            , m_left(0)
+        {
+        }
+
+        bool next()
+        {
+            if (m_left == 0) {
+                m_bits = m_wide ? m_rng.uniform_ulong(0x10000)
+                                : m_rng.uniform_ulong(2);
+                m_left = m_wide ? 16 : 1;
+            }
+            bool b = m_bits & 1;
+            m_bits >>= 1;
+            --m_left;
+            return b;
+        }
+
+      private:
+        rng &m_rng;
+        bool m_wide;
+        int m_left;
+        unsigned long m_bits;
+    };
+
+    // x[start, mid) and x[mid, end) are uniformly shuffled, after merging
+    // x[start, end) is
+    template <typename Scalar>
+    static void merge(Scalar x[], size_t start, size_t mid, size_t end, rng &r)
+    {
+        bits b(r);
+        size_t i = start, j = mid;
+        for (;; ++i) {
+            if (b.next()) {
+                if (j == end) {
+                    break;
+                }
+                std::swap(x[i], x[j++]);
+            } else if (i == j) {
+                break;
+            }
+        }
+
+        // one run is exhausted, insert the rest of the other one
+        for (; i < end; ++i) {
+            std::swap(x[start + r.uniform_ulong(i - start + 1)], x[i]);
+        }
+    }
+};
+
+// shuffles in parallel, see merge_shuffle
 template <typename T>
 inline auto shuffle(DenseBase<T> &x,
                     unsigned long seed = 0,
                     rng::type type = DEFAULT_RNG_TYPE) -> decltype(x.derived())
 {
-    rng r(type, seed);
-    return shuffle(x, r);
+    merge_shuffle::run(x.derived().data(), x.derived().size(), seed, type);
+    return x.derived();
 }
 
+// sequential fisher-yates drawing from r
 template <typename T>
 inline auto shuffle(DenseBase<T> &x, rng &r) -> decltype(x.derived())
 {
@@ -60,6 +176,31 @@ inline auto shuffle(DenseBase<T> &x, rng &r) -> decltype(x.derived())
     return x.derived();
 }
 
+// x becomes a random permutation of 0, 1, ..., x.size() - 1
+template <typename T>
+inline auto permutation(DenseBase<T> &x,
+                        unsigned long seed = 0,
+                        rng::type type = DEFAULT_RNG_TYPE)
+    -> decltype(x.derived())
+{
+    static_assert(IS_INTEGER(typename T::Scalar),
+                  "only support integer scalar");
+
+    typename T::Scalar *data = x.derived().data();
+    for (Index i = 0; i < x.size(); ++i) {
+        data[i] = (typename T::Scalar)i;
+    }
+    return shuffle(x, seed, type);
+}
+
+inline Matrix<Index, Dynamic, 1> permutation(
+    Index n, unsigned long seed = 0, rng::type type = DEFAULT_RNG_TYPE)
+{
+    Matrix<Index, Dynamic, 1> p(n);
+    permutation(p, seed, type);
+    return p;
+}
+
 ////////////////////////////////////////////////////////////
 // global variants
 ////////////////////////////////////////////////////////////
@@ -0,0 +1,339 @@
+/* Copyright (C) 2017 haniu (niuhao.cn@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef __IEXP_EWSTAT__
+#define __IEXP_EWSTAT__
+
+////////////////////////////////////////////////////////////
+// import header files
+////////////////////////////////////////////////////////////
+
+#include <common/common.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+IEXP_NS_BEGIN
+
+////////////////////////////////////////////////////////////
+// macro definition
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// type definition
+////////////////////////////////////////////////////////////
+
+// exponentially weighted mean and variance of a time stamped stream.
+//
+// a sample observed at time t weighs 2^(-(now - t) / half_life), so
+// timestamps may be irregular and regular streams simply use t = 0, 1,
+// 2, .... updates are weighted welford steps after decaying the running
+// sums, in O(1) and without allocation. accumulators are plain values:
+// each thread keeps its own and they are merged afterwards. a sample
+// older than the last one is decayed itself instead of the state
+class ewstat
+{
+  public:
+    ewstat(double half_life)
+        : m_half_life(half_life)
+    {
+        eigen_assert(half_life > 0);
+        reset();
+    }
+
+    ewstat &reset()
+    {
+        m_time = -std::numeric_limits<double>::infinity();
+        m_w = 0;
+        m_w2 = 0;
+        m_mean = 0;
+        m_m2 = 0;
+        return *this;
+    }
+
+    ewstat &add(double x, double t)
+    {
+        add_weighted(x, t, 1);
+        return *this;
+    }
+
+    // sample one time unit after the last one
+    ewstat &add(double x)
+    {
+        return add(x, m_w > 0 ? m_time + 1 : 0);
+    }
+
+    template <typename T, typename U>
+    ewstat &add(const DenseBase<T> &x, const DenseBase<U> &t)
+    {
+        eigen_assert(x.size() == t.size());
+
+        stride_eval<T> m_x(x);
+        stride_eval<U> m_t(t);
+        const typename T::Scalar *xd = m_x.data();
+        const typename U::Scalar *td = m_t.data();
+        for (size_t i = 0; i < m_x.size(); ++i) {
+            add((double)xd[i * m_x.stride()], (double)td[i * m_t.stride()]);
+        }
+        return *this;
+    }
+
+    template <typename T>
+    ewstat &add(const DenseBase<T> &x)
+    {
+        stride_eval<T> m_x(x);
+        const typename T::Scalar *data = m_x.data();
+        for (size_t i = 0; i < m_x.size(); ++i) {
+            add((double)data[i * m_x.stride()]);
+        }
+        return *this;
+    }
+
+    // statistics of both streams, as if all samples were added to one
+    ewstat &merge(const ewstat &other)
+    {
+        eigen_assert(other.m_half_life == m_half_life);
+
+        if (other.m_w == 0) {
+            return *this;
+        }
+        if (m_w == 0) {
+            return *this = other;
+        }
+
+        double t = std::max(m_time, other.m_time);
+        decay(t);
+        double a = factor(t - other.m_time), w = other.m_w * a;
+
+        double sw = m_w + w, d = other.m_mean - m_mean;
+        m_m2 += other.m_m2 * a + d * d * m_w * w / sw;
+        m_mean += d * w / sw;
+        m_w = sw;
+        m_w2 += other.m_w2 * a * a;
+        return *this;
+    }
+
+    double mean() const
+    {
+        return m_w > 0 ? m_mean : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    // unbiased for reliability weights, as gsl_stats_wvariance
+    double var() const
+    {
+        return m_m2 * m_w / (m_w * m_w - m_w2);
+    }
+
+    double std() const
+    {
+        return std::sqrt(var());
+    }
+
+    // decayed sum of the sample weights at the last sample time
+    double weight() const
+    {
+        return m_w;
+    }
+
+    // number of equally weighted samples giving the same variance of the
+    // mean
+    double effective_size() const
+    {
+        return m_w2 > 0 ? m_w * m_w / m_w2 : 0;
+    }
+
+    // time of the latest sample
+    double time() const
+    {
+        return m_time;
+    }
+
+    double half_life() const
+    {
+        return m_half_life;
+    }
+
+  private:
+    friend class ewquantile;
+
+    double factor(double dt) const
+    {
+        return std::exp2(-dt / m_half_life);
+    }
+
+    void decay(double t)
+    {
+        if (t > m_time && m_w > 0) {
+            double a = factor(t - m_time);
+            m_w *= a;
+            m_w2 *= a * a;
+            m_m2 *= a;
+        }
+        m_time = std::max(m_time, t);
+    }
+
+    // returns the share of the sample in the new total weight
+    double add_weighted(double x, double t, double w)
+    {
+        if (t < m_time) {
+            w *= factor(m_time - t);
+        } else {
+            decay(t);
+        }
+
+        m_w += w;
+        m_w2 += w * w;
+        double d = x - m_mean, r = w / m_w;
+        m_mean += d * r;
+        m_m2 += w * d * (x - m_mean);
+        return r;
+    }
+
+    double m_half_life;
+    double m_time;
+    double m_w, m_w2;
+    double m_mean, m_m2;
+};
+
+// exponentially weighted quantile f of a time stamped stream.
+//
+// a quantile can not be updated exactly in O(1) memory, so it is tracked
+// by stochastic approximation: each sample moves the estimate by
+// r * s * (f - [x < q]), r being the share of the sample in the decayed
+// weight and s the decayed standard deviation. the estimate is stationary
+// where a fraction f of the decayed weight lies below it and follows
+// drifts with the same half-life as the mean. merging averages the
+// estimates by decayed weight, which is approximate
+class ewquantile
+{
+  public:
+    ewquantile(double half_life, double f = 0.5)
+        : m_stat(half_life)
+        , m_f(f)
+        , m_q(std::numeric_limits<double>::quiet_NaN())
+    {
+        eigen_assert(f > 0 && f < 1);
+    }
+
+    ewquantile &reset()
+    {
+        m_stat.reset();
+        m_q = std::numeric_limits<double>::quiet_NaN();
+        return *this;
+    }
+
+    ewquantile &add(double x, double t)
+    {
+        double r = m_stat.add_weighted(x, t, 1);
+        if (std::isnan(m_q)) {
+            m_q = x;
+            return *this;
+        }
+
+        double s = m_stat.std();
+        if (!std::isfinite(s)) {
+            s = std::abs(x - m_q);
+        }
+        m_q += r * s * (m_f - (x < m_q ? 1 : 0));
+        return *this;
+    }
+
+    ewquantile &add(double x)
+    {
+        return add(x, m_stat.m_w > 0 ? m_stat.m_time + 1 : 0);
+    }
+
+    template <typename T, typename U>
+    ewquantile &add(const DenseBase<T> &x, const DenseBase<U> &t)
+    {
+        eigen_assert(x.size() == t.size());
+
+        stride_eval<T> m_x(x);
+        stride_eval<U> m_t(t);
+        const typename T::Scalar *xd = m_x.data();
+        const typename U::Scalar *td = m_t.data();
+        for (size_t i = 0; i < m_x.size(); ++i) {
+            add((double)xd[i * m_x.stride()], (double)td[i * m_t.stride()]);
+        }
+        return *this;
+    }
+
+    template <typename T>
+    ewquantile &add(const DenseBase<T> &x)
+    {
+        stride_eval<T> m_x(x);
+        const typename T::Scalar *data = m_x.data();
+        for (size_t i = 0; i < m_x.size(); ++i) {
+            add((double)data[i * m_x.stride()]);
+        }
+        return *this;
+    }
+
+    ewquantile &merge(const ewquantile &other)
+    {
+        eigen_assert(other.m_f == m_f);
+
+        if (std::isnan(other.m_q)) {
+            return *this;
+        }
+        if (std::isnan(m_q)) {
+            return *this = other;
+        }
+
+        double t = std::max(m_stat.m_time, other.m_stat.m_time);
+        double w = m_stat.m_w * m_stat.factor(t - m_stat.m_time);
+        double ow = other.m_stat.m_w * m_stat.factor(t - other.m_stat.m_time);
+        m_q = (m_q * w + other.m_q * ow) / (w + ow);
+        m_stat.merge(other.m_stat);
+        return *this;
+    }
+
+    double get() const
+    {
+        return m_q;
+    }
+
+    double fraction() const
+    {
+        return m_f;
+    }
+
+    // mean and variance of the same decayed samples
+    const ewstat &stat() const
+    {
+        return m_stat;
+    }
+
+  private:
+    ewstat m_stat;
+    double m_f;
+    double m_q;
+};
+
+////////////////////////////////////////////////////////////
+// global variants
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// interface declaration
+////////////////////////////////////////////////////////////
+
+IEXP_NS_END
+
+#endif /* __IEXP_EWSTAT__ */
@@ -25,8 +25,12 @@
 
 #include <common/common.h>
 
+#include <stats/moments.h>
+
 #include <gsl/gsl_rstat.h>
 
+#include <algorithm>
+
 IEXP_NS_BEGIN
 
 ////////////////////////////////////////////////////////////
@@ -37,15 +41,59 @@ IEXP_NS_BEGIN
 // type definition
 ////////////////////////////////////////////////////////////
 
+// running statistics of a stream.
+//
+// accumulators are copyable and mergeable, so partial aggregates from
+// threads or shards can be combined. moments are merged exactly with
+// chan's parallel update extended to 3rd and 4th moments (pebay). the
+// median is a p-square estimate which can not be merged exactly: the
+// markers of both estimators are combined by weight, so the median of a
+// merged accumulator is approximate unless one side has at most 5 samples.
+//
+// gsl has no merge or state api: merge(), save() and load() read and write
+// the fields of gsl_rstat_workspace directly (M2..M4 and the p-square
+// q/npos/np/dnp of median_workspace_p), which ties them to the layout of
+// the gsl version built against
 class rstat
 {
   public:
+    // plain data copy of an accumulator, e.g. to be sent to another
+    // process. it includes the median markers so that a restored
+    // accumulator can keep adding samples
+    struct state
+    {
+        size_t n;
+        double min, max;
+        double mean, m2, m3, m4;
+        size_t median_n;
+        double q[5];
+        int npos[5];
+        double np[5];
+    };
+
     rstat()
     {
         m_rw = gsl_rstat_alloc();
         IEXP_NOT_NULLPTR(m_rw);
     }
 
+    explicit rstat(const state &s)
+        : rstat()
+    {
+        load(s);
+    }
+
+    rstat(const rstat &other)
+        : rstat()
+    {
+        load(other.save());
+    }
+
+    rstat &operator=(const rstat &other)
+    {
+        return load(other.save());
+    }
+
     ~rstat()
     {
         gsl_rstat_free(m_rw);
@@ -63,6 +111,97 @@ class rstat
         return *this;
     }
 
+    // moments of x are computed in one vectorized pass and merged, only
+    // the median estimator sees samples one by one
+    template <typename T>
+    rstat &add(const DenseBase<T> &x)
+    {
+        stride_eval<T> m_x(x);
+        const typename T::Scalar *data = m_x.data();
+        size_t n = m_x.size(), stride = m_x.stride();
+        if (n == 0) {
+            return *this;
+        }
+
+        stats::summary s;
+        s.add(data, n, stride);
+        merge_moment(s.size(),
+                     s.min(),
+                     s.max(),
+                     s.mean(),
+                     s.m2(),
+                     s.m3(),
+                     s.m4());
+
+        for (size_t i = 0; i < n; ++i) {
+            gsl_rstat_quantile_add((double)data[i * stride],
+                                   m_rw->median_workspace_p);
+        }
+        return *this;
+    }
+
+    // statistics of both streams, exact except for the median
+    rstat &merge(const rstat &other)
+    {
+        if (&other == this) {
+            rstat t(other);
+            return merge(t);
+        }
+
+        const gsl_rstat_workspace *o = other.m_rw;
+        if (o->n == 0) {
+            return *this;
+        }
+        if (m_rw->n == 0) {
+            return *this = other;
+        }
+
+        merge_moment(o->n, o->min, o->max, o->mean, o->M2, o->M3, o->M4);
+        merge_median(*o->median_workspace_p);
+        return *this;
+    }
+
+    state save() const
+    {
+        const gsl_rstat_quantile_workspace *q = m_rw->median_workspace_p;
+
+        state s;
+        s.n = m_rw->n;
+        s.min = m_rw->min;
+        s.max = m_rw->max;
+        s.mean = m_rw->mean;
+        s.m2 = m_rw->M2;
+        s.m3 = m_rw->M3;
+        s.m4 = m_rw->M4;
+        s.median_n = q->n;
+        for (int i = 0; i < 5; ++i) {
+            s.q[i] = q->q[i];
+            s.npos[i] = q->npos[i];
+            s.np[i] = q->np[i];
+        }
+        return s;
+    }
+
+    rstat &load(const state &s)
+    {
+        gsl_rstat_quantile_workspace *q = m_rw->median_workspace_p;
+
+        m_rw->n = s.n;
+        m_rw->min = s.min;
+        m_rw->max = s.max;
+        m_rw->mean = s.mean;
+        m_rw->M2 = s.m2;
+        m_rw->M3 = s.m3;
+        m_rw->M4 = s.m4;
+        q->n = s.median_n;
+        for (int i = 0; i < 5; ++i) {
+            q->q[i] = s.q[i];
+            q->npos[i] = s.npos[i];
+            q->np[i] = s.np[i];
+        }
+        return *this;
+    }
+
     size_t size() const
     {
         return gsl_rstat_n(m_rw);
@@ -119,8 +258,80 @@ class rstat
     }
 
   private:
-    rstat(const rstat &) = delete;
-    rstat &operator=(const rstat &) = delete;
+    void merge_moment(size_t nb,
+                      double min,
+                      double max,
+                      double mean,
+                      double m2,
+                      double m3,
+                      double m4)
+    {
+        gsl_rstat_workspace *r = m_rw;
+        if (r->n == 0) {
+            r->n = nb;
+            r->min = min;
+            r->max = max;
+            r->mean = mean;
+            r->M2 = m2;
+            r->M3 = m3;
+            r->M4 = m4;
+            return;
+        }
+
+        double na = (double)r->n, n = na + nb;
+        double d = mean - r->mean, dn = d / n, dn2 = dn * dn;
+
+        r->M4 += m4 + d * dn * dn2 * na * nb * (na * na - na * nb + nb * nb) +
+                 6 * dn2 * (na * na * m2 + nb * nb * r->M2) +
+                 4 * dn * (na * m3 - nb * r->M3);
+        r->M3 += m3 + d * dn2 * na * nb * (na - nb) +
+                 3 * dn * (na * m2 - nb * r->M2);
+        r->M2 += m2 + d * dn * na * nb;
+        r->mean += nb * dn;
+        r->n += nb;
+        r->min = std::min(r->min, min);
+        r->max = std::max(r->max, max);
+    }
+
+    void merge_median(const gsl_rstat_quantile_workspace &b)
+    {
+        gsl_rstat_quantile_workspace *a = m_rw->median_workspace_p;
+
+        // the first 5 samples are kept as they are: replay them
+        if (b.n <= 5) {
+            for (size_t i = 0; i < b.n; ++i) {
+                gsl_rstat_quantile_add(b.q[i], a);
+            }
+            return;
+        }
+        if (a->n <= 5) {
+            gsl_rstat_quantile_workspace t = b;
+            for (size_t i = 0; i < a->n; ++i) {
+                gsl_rstat_quantile_add(a->q[i], &t);
+            }
+            *a = t;
+            return;
+        }
+
+        // weighted marker heights, marker positions add up and desired
+        // positions are those of a single stream of the total length
+        double na = (double)a->n, nb = (double)b.n;
+        size_t n = a->n + b.n;
+        a->q[0] = std::min(a->q[0], b.q[0]);
+        a->q[4] = std::max(a->q[4], b.q[4]);
+        for (int i = 1; i < 4; ++i) {
+            a->q[i] = (na * a->q[i] + nb * b.q[i]) / (na + nb);
+            a->npos[i] += b.npos[i];
+        }
+        a->npos[4] = (int)n;
+
+        double p = a->p;
+        double np0[5] = {1, 1 + 2 * p, 1 + 4 * p, 3 + 2 * p, 5};
+        for (int i = 0; i < 5; ++i) {
+            a->np[i] = np0[i] + (n - 5) * a->dnp[i];
+        }
+        a->n = n;
+    }
 
     gsl_rstat_workspace *m_rw;
 };
@@ -0,0 +1,340 @@
+/* Copyright (C) 2017 haniu (niuhao.cn@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef __IEXP_TDIGEST__
+#define __IEXP_TDIGEST__
+
+////////////////////////////////////////////////////////////
+// import header files
+////////////////////////////////////////////////////////////
+
+#include <common/common.h>
+
+#include <math/constant.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+IEXP_NS_BEGIN
+
+////////////////////////////////////////////////////////////
+// macro definition
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// type definition
+////////////////////////////////////////////////////////////
+
+// streaming quantile sketch (merging t-digest of dunning and ertl).
+//
+// samples are summarized by weighted centroids. the size of a centroid
+// is bounded through the arcsine scale function, so centroids are small
+// near both tails and the extreme quantiles stay accurate, while memory
+// is O(compression) whatever the stream length. samples are buffered and
+// merged into the centroids in sorted batches, which makes bulk inserts
+// and merging digests of other threads cheap. unlike quantile, any
+// quantile or cdf value can be asked after the fact. readers do not
+// modify the digest and may run concurrently; pending samples are then
+// merged into a temporary copy, which flush() avoids
+class tdigest
+{
+  public:
+    enum
+    {
+        // buffered samples per unit of compression
+        BUFFER_FACTOR = 5,
+    };
+
+    tdigest(double compression = 100)
+        : m_compression(compression)
+        , m_weight(0)
+        , m_min(std::numeric_limits<double>::infinity())
+        , m_max(-std::numeric_limits<double>::infinity())
+    {
+        eigen_assert(compression >= 10);
+        m_buffer.reserve(buffer_size());
+    }
+
+    tdigest &reset()
+    {
+        m_centroid.clear();
+        m_buffer.clear();
+        m_weight = 0;
+        m_min = std::numeric_limits<double>::infinity();
+        m_max = -std::numeric_limits<double>::infinity();
+        return *this;
+    }
+
+    tdigest &add(double x, double w = 1)
+    {
+        if (!(w > 0) || std::isnan(x)) {
+            return *this;
+        }
+
+        m_buffer.push_back(centroid{x, w});
+        m_weight += w;
+        m_min = std::min(m_min, x);
+        m_max = std::max(m_max, x);
+        if (m_buffer.size() >= buffer_size()) {
+            flush();
+        }
+        return *this;
+    }
+
+    template <typename T>
+    tdigest &add(const DenseBase<T> &x)
+    {
+        stride_eval<T> m_x(x);
+        const typename T::Scalar *data = m_x.data();
+        for (size_t i = 0; i < m_x.size(); ++i) {
+            add((double)data[i * m_x.stride()]);
+        }
+        return *this;
+    }
+
+    // digest of both streams
+    tdigest &merge(const tdigest &other)
+    {
+        if (&other == this) {
+            tdigest t(other);
+            return merge(t);
+        }
+
+        for (const auto &c : other.m_centroid) {
+            m_buffer.push_back(c);
+        }
+        for (const auto &c : other.m_buffer) {
+            m_buffer.push_back(c);
+        }
+        m_weight += other.m_weight;
+        m_min = std::min(m_min, other.m_min);
+        m_max = std::max(m_max, other.m_max);
+        return flush();
+    }
+
+    // merges the buffered samples into the centroids
+    tdigest &flush()
+    {
+        if (!m_buffer.empty()) {
+            compress(m_buffer, m_centroid);
+            m_buffer.clear();
+        }
+        return *this;
+    }
+
+    // value below which a fraction q of the samples lies
+    double quantile(double q) const
+    {
+        std::vector<centroid> tmp;
+        return quantile(centroids(tmp), q);
+    }
+
+    template <typename T>
+    VectorXd quantile(const DenseBase<T> &q) const
+    {
+        std::vector<centroid> tmp;
+        const std::vector<centroid> &c = centroids(tmp);
+
+        VectorXd r(q.size());
+        for (Index i = 0; i < q.size(); ++i) {
+            r[i] = quantile(c, (double)q.derived().coeff(i));
+        }
+        return r;
+    }
+
+    // fraction of the samples not greater than x, inverse of quantile()
+    double cdf(double x) const
+    {
+        std::vector<centroid> tmp;
+        const std::vector<centroid> &cs = centroids(tmp);
+        if (cs.empty()) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        if (x < m_min) {
+            return 0;
+        }
+        if (x >= m_max) {
+            return 1;
+        }
+
+        double pos = 0, prev_pos = 0, prev = m_min;
+        for (const auto &c : cs) {
+            pos += c.w / 2;
+            if (x < c.mean) {
+                return interpolate(x, prev, c.mean, prev_pos, pos) / m_weight;
+            }
+            prev_pos = pos;
+            prev = c.mean;
+            pos += c.w / 2;
+        }
+        return interpolate(x, prev, m_max, prev_pos, m_weight) / m_weight;
+    }
+
+    // total weight, the number of samples for unit weights
+    double weight() const
+    {
+        return m_weight;
+    }
+
+    double min() const
+    {
+        return m_min;
+    }
+
+    double max() const
+    {
+        return m_max;
+    }
+
+    double compression() const
+    {
+        return m_compression;
+    }
+
+    // number of centroids, buffered samples merged
+    size_t size() const
+    {
+        std::vector<centroid> tmp;
+        return centroids(tmp).size();
+    }
+
+  private:
+    struct centroid
+    {
+        double mean, w;
+
+        bool operator<(const centroid &other) const
+        {
+            return mean < other.mean;
+        }
+    };
+
+    size_t buffer_size() const
+    {
+        return (size_t)(m_compression * BUFFER_FACTOR);
+    }
+
+    static double interpolate(double t,
+                              double t0,
+                              double t1,
+                              double y0,
+                              double y1)
+    {
+        if (t1 <= t0) {
+            return y1;
+        }
+        return y0 + (y1 - y0) * (t - t0) / (t1 - t0);
+    }
+
+    // arcsine scale function and its inverse: a centroid may only cover
+    // one unit of k
+    double k(double q) const
+    {
+        return m_compression / (2 * IEXP_PI) * std::asin(2 * q - 1);
+    }
+
+    double q_limit(double q) const
+    {
+        double k1 = k(q) + 1;
+        if (k1 >= m_compression / 4) {
+            return 1;
+        }
+        return (std::sin(k1 * 2 * IEXP_PI / m_compression) + 1) / 2;
+    }
+
+    double quantile(const std::vector<centroid> &cs, double q) const
+    {
+        eigen_assert(q >= 0 && q <= 1);
+
+        if (cs.empty()) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+
+        // piecewise linear through (0, min), the centroids at the middle
+        // of their weight and (weight, max)
+        double t = q * m_weight, pos = 0, prev_pos = 0, prev = m_min;
+        for (const auto &c : cs) {
+            pos += c.w / 2;
+            if (t < pos) {
+                return interpolate(t, prev_pos, pos, prev, c.mean);
+            }
+            prev_pos = pos;
+            prev = c.mean;
+            pos += c.w / 2;
+        }
+        return interpolate(t, prev_pos, m_weight, prev, m_max);
+    }
+
+    // the centroids with the buffered samples merged, built in tmp when
+    // there are any
+    const std::vector<centroid> &centroids(std::vector<centroid> &tmp) const
+    {
+        if (m_buffer.empty()) {
+            return m_centroid;
+        }
+        std::vector<centroid> buffer(m_buffer);
+        tmp = m_centroid;
+        compress(buffer, tmp);
+        return tmp;
+    }
+
+    // merges buffer, which is reordered, into cs
+    void compress(std::vector<centroid> &buffer,
+                  std::vector<centroid> &cs) const
+    {
+        buffer.insert(buffer.end(), cs.begin(), cs.end());
+        std::sort(buffer.begin(), buffer.end());
+        cs.clear();
+
+        centroid cur = buffer[0];
+        double done = 0, limit = q_limit(0) * m_weight;
+        for (size_t i = 1; i < buffer.size(); ++i) {
+            const centroid &c = buffer[i];
+            if (done + cur.w + c.w <= limit) {
+                cur.w += c.w;
+                cur.mean += (c.mean - cur.mean) * c.w / cur.w;
+            } else {
+                cs.push_back(cur);
+                done += cur.w;
+                limit = q_limit(done / m_weight) * m_weight;
+                cur = c;
+            }
+        }
+        cs.push_back(cur);
+    }
+
+    double m_compression;
+    double m_weight;
+    double m_min, m_max;
+    std::vector<centroid> m_centroid;
+    std::vector<centroid> m_buffer;
+};
+
+////////////////////////////////////////////////////////////
+// global variants
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// indexerface declaration
+////////////////////////////////////////////////////////////
+
+IEXP_NS_END
+
+#endif /* __IEXP_TDIGEST__ */
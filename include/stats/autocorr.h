@@ -44,22 +44,22 @@ namespace stats {
 // ========================================
 
 template <typename T>
-inline double autocorr_impl(const T data[], size_t n)
+inline double autocorr_impl(const T data[], size_t stride, size_t n)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
-inline double autocorr_impl(const double data[], size_t n)
+inline double autocorr_impl(const double data[], size_t stride, size_t n)
 {
-    return gsl_stats_lag1_autocorrelation(data, 1, n);
+    return gsl_stats_lag1_autocorrelation(data, stride, n);
 }
 
 #define DEFINE_AUTOCORR(type, name)                                            \
     template <>                                                                \
-    inline double autocorr_impl(const type data[], size_t n)                   \
+    inline double autocorr_impl(const type data[], size_t stride, size_t n)    \
     {                                                                          \
-        return gsl_stats_##name##_lag1_autocorrelation(data, 1, n);            \
+        return gsl_stats_##name##_lag1_autocorrelation(data, stride, n);       \
     }
 DEFINE_AUTOCORR(char, char)
 DEFINE_AUTOCORR(unsigned char, uchar)
@@ -74,8 +74,8 @@ DEFINE_AUTOCORR(long double, long_double)
 template <typename T>
 inline double autocorr(const DenseBase<T> &data)
 {
-    typename type_eval<T>::type m_data(data.eval());
-    return autocorr_impl(m_data.data(), m_data.size());
+    stride_eval<T> m_data(data);
+    return autocorr_impl(m_data.data(), m_data.stride(), m_data.size());
 }
 
 // ========================================
@@ -83,22 +83,34 @@ inline double autocorr(const DenseBase<T> &data)
 // ========================================
 
 template <typename T>
-inline double autocorr_m_impl(const T data[], size_t n, double mean)
+inline double autocorr_m_impl(const T data[],
+                              size_t stride,
+                              size_t n,
+                              double mean)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
-inline double autocorr_m_impl(const double data[], size_t n, double mean)
+inline double autocorr_m_impl(const double data[],
+                              size_t stride,
+                              size_t n,
+                              double mean)
 {
-    return gsl_stats_lag1_autocorrelation_m(data, 1, n, mean);
+    return gsl_stats_lag1_autocorrelation_m(data, stride, n, mean);
 }
 
 #define DEFINE_AUTOCORR_M(type, name)                                          \
     template <>                                                                \
-    inline double autocorr_m_impl(const type data[], size_t n, double mean)    \
+    inline double autocorr_m_impl(const type data[],                           \
+                                  size_t stride,                               \
+                                  size_t n,                                    \
+                                  double mean)                                 \
     {                                                                          \
-        return gsl_stats_##name##_lag1_autocorrelation_m(data, 1, n, mean);    \
+        return gsl_stats_##name##_lag1_autocorrelation_m(data,                 \
+                                                         stride,               \
+                                                         n,                    \
+                                                         mean);                \
     }
 DEFINE_AUTOCORR_M(char, char)
 DEFINE_AUTOCORR_M(unsigned char, uchar)
@@ -113,8 +125,8 @@ DEFINE_AUTOCORR_M(long double, long_double)
 template <typename T>
 inline double autocorr(const DenseBase<T> &data, double mean)
 {
-    typename type_eval<T>::type m_data(data.eval());
-    return autocorr_m_impl(m_data.data(), m_data.size(), mean);
+    stride_eval<T> m_data(data);
+    return autocorr_m_impl(m_data.data(), m_data.stride(), m_data.size(), mean);
 }
 
 ////////////////////////////////////////////////////////////
@@ -0,0 +1,314 @@
+/* Copyright (C) 2017 haniu (niuhao.cn@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef __IEXP_STATS_COLWISE__
+#define __IEXP_STATS_COLWISE__
+
+////////////////////////////////////////////////////////////
+// import header files
+////////////////////////////////////////////////////////////
+
+#include <common/common.h>
+#include <common/parallel.h>
+
+#include <stats/select.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+IEXP_NS_BEGIN
+
+namespace stats {
+
+////////////////////////////////////////////////////////////
+// macro definition
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// type definition
+////////////////////////////////////////////////////////////
+
+// per column (column = true) or per row statistics of a matrix expression.
+//
+// a "line" is a column for colwise and a row for rowwise. when the lines
+// are contiguous in memory, e.g. columns of a column major matrix, each
+// line is reduced on its own. otherwise the matrix is walked in storage
+// order and every storage row updates the accumulators of a slab of
+// lines, so memory is never read across the grain. lines or slabs are
+// distributed over parallel::run, results do not depend on the number of
+// threads. var, std and quantile follow the gsl_stats_* definitions
+template <typename T, bool column>
+class vectorwise
+{
+  public:
+    enum
+    {
+        // lines per task when reducing across storage rows
+        SLAB = 256,
+        // elements per task when reducing contiguous lines
+        CHUNK = 1 << 14,
+        // least lines per task when copying across storage rows, so that
+        // whole cache lines are read
+        GATHER = 16,
+        // smaller inputs are not worth waking other threads
+        PARALLEL_SIZE = 1 << 15,
+    };
+
+    using Scalar = typename T::Scalar;
+    using ResultType =
+        Matrix<double, column ? 1 : Dynamic, column ? Dynamic : 1>;
+
+    vectorwise(const T &x)
+        : m_x(x)
+    {
+    }
+
+    ResultType mean() const
+    {
+        return reduce(false, false);
+    }
+
+    ResultType var() const
+    {
+        return reduce(true, false);
+    }
+
+    ResultType std() const
+    {
+        return reduce(true, true);
+    }
+
+    ResultType median() const
+    {
+        return quantile(0.5);
+    }
+
+    // f in [0, 1], linear interpolation between order statistics
+    ResultType quantile(double f) const
+    {
+        view v(m_x);
+        ResultType r(v.line);
+        if (v.len == 0) {
+            r.setConstant(std::numeric_limits<double>::quiet_NaN());
+            return r;
+        }
+
+        Index per = std::max<Index>(v.along ? 1 : GATHER, CHUNK / v.len);
+        size_t task = (size_t)((v.line + per - 1) / per);
+        parallel::run(task,
+                      [&](size_t t) {
+                          Index begin = (Index)t * per;
+                          Index n = std::min<Index>(per, v.line - begin);
+                          quantile_lines(v, begin, n, f, r);
+                      },
+                      thread(v));
+        return r;
+    }
+
+  private:
+    using Plain = Matrix<Scalar,
+                         Dynamic,
+                         Dynamic,
+                         (T::Flags & RowMajorBit) ? RowMajor : ColMajor>;
+    using Line = Array<Scalar, Dynamic, 1>;
+    using LineMap = Map<const Line, 0, InnerStride<>>;
+
+    // direct access expressions are referenced, others evaluated once
+    struct view
+    {
+        view(const T &x)
+            : ref(x)
+            , data(ref.data())
+            , line(column ? ref.cols() : ref.rows())
+            , len(column ? ref.rows() : ref.cols())
+        {
+            bool row_major = (T::Flags & RowMajorBit) != 0;
+            along = (column != row_major);
+            elem_stride = along ? ref.innerStride() : ref.outerStride();
+            line_stride = along ? ref.outerStride() : ref.innerStride();
+        }
+
+        Ref<const Plain, 0, Stride<Dynamic, Dynamic>> ref;
+        const Scalar *data;
+        Index line, len;
+        Index elem_stride, line_stride;
+        // lines are contiguous
+        bool along;
+    };
+
+    static unsigned int thread(const view &v)
+    {
+        return v.line * v.len < PARALLEL_SIZE ? 1 : 0;
+    }
+
+    ResultType reduce(bool var, bool sd) const
+    {
+        view v(m_x);
+        ResultType r(v.line);
+
+        if (v.along) {
+            Index per = std::max<Index>(1, CHUNK / std::max<Index>(1, v.len));
+            size_t task = (size_t)((v.line + per - 1) / per);
+            parallel::run(task,
+                          [&](size_t t) {
+                              Index begin = (Index)t * per;
+                              Index n = std::min<Index>(per, v.line - begin);
+                              line_stat(v, begin, n, var, sd, r);
+                          },
+                          thread(v));
+        } else {
+            size_t task = (size_t)((v.line + SLAB - 1) / SLAB);
+            parallel::run(task,
+                          [&](size_t t) {
+                              Index begin = (Index)t * SLAB;
+                              Index w = std::min<Index>(SLAB, v.line - begin);
+                              slab_stat(v, begin, w, var, sd, r);
+                          },
+                          thread(v));
+        }
+        return r;
+    }
+
+    // two pass: mean, then sum of squared deviations
+    static void line_stat(const view &v,
+                          Index begin,
+                          Index n,
+                          bool var,
+                          bool sd,
+                          ResultType &r)
+    {
+        for (Index j = begin; j < begin + n; ++j) {
+            LineMap l(v.data + j * v.line_stride,
+                      v.len,
+                      InnerStride<>(v.elem_stride));
+            auto a = l.template cast<double>();
+            double m = a.sum() / v.len;
+            if (var) {
+                m = (a - m).square().sum() / (v.len - 1);
+                if (sd) {
+                    m = std::sqrt(m);
+                }
+            }
+            r[j] = m;
+        }
+    }
+
+    // lines which are not contiguous are first copied out together, one
+    // storage row of the block after another
+    static void quantile_lines(const view &v,
+                               Index begin,
+                               Index n,
+                               double f,
+                               ResultType &r)
+    {
+        if (v.along) {
+            std::vector<double> buf(v.len);
+            for (Index j = begin; j < begin + n; ++j) {
+                const Scalar *p = v.data + j * v.line_stride;
+                for (Index i = 0; i < v.len; ++i) {
+                    buf[i] = (double)p[i * v.elem_stride];
+                }
+                quantile_select_impl(buf.data(), buf.size(), &f, 1, &r[j]);
+            }
+            return;
+        }
+
+        std::vector<double> buf(v.len * n);
+        const Scalar *p = v.data + begin * v.line_stride;
+        for (Index i = 0; i < v.len; ++i) {
+            const Scalar *s = p + i * v.elem_stride;
+            for (Index j = 0; j < n; ++j) {
+                buf[j * v.len + i] = (double)s[j * v.line_stride];
+            }
+        }
+        for (Index j = 0; j < n; ++j) {
+            quantile_select_impl(buf.data() + j * v.len,
+                                 (size_t)v.len,
+                                 &f,
+                                 1,
+                                 &r[begin + j]);
+        }
+    }
+
+    static void slab_stat(const view &v,
+                          Index begin,
+                          Index w,
+                          bool var,
+                          bool sd,
+                          ResultType &r)
+    {
+        Array<double, Dynamic, 1, ColMajor, SLAB, 1> acc(w), m(w);
+        const Scalar *p = v.data + begin * v.line_stride;
+
+        acc.setZero();
+        for (Index i = 0; i < v.len; ++i) {
+            LineMap a(p + i * v.elem_stride, w, InnerStride<>(v.line_stride));
+            acc += a.template cast<double>();
+        }
+        m = acc / v.len;
+
+        if (var) {
+            acc.setZero();
+            for (Index i = 0; i < v.len; ++i) {
+                LineMap a(p + i * v.elem_stride,
+                          w,
+                          InnerStride<>(v.line_stride));
+                acc += (a.template cast<double>() - m).square();
+            }
+            m = acc / (v.len - 1);
+            if (sd) {
+                m = m.sqrt();
+            }
+        }
+        Map<Array<double, Dynamic, 1>>(r.data() + begin, w) = m;
+    }
+
+    // plain objects are referenced, other expressions kept by value
+    typename internal::ref_selector<T>::type m_x;
+};
+
+////////////////////////////////////////////////////////////
+// global variants
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// interface declaration
+////////////////////////////////////////////////////////////
+
+// statistics of each column, e.g. stats::colwise(x).mean(), as a row
+// vector like eigen's partial reductions. an expression is kept by value
+// but a matrix, and the operands of an expression, must outlive the
+// returned object
+template <typename T>
+inline vectorwise<T, true> colwise(const DenseBase<T> &x)
+{
+    return vectorwise<T, true>(x.derived());
+}
+
+// statistics of each row, as a column vector
+template <typename T>
+inline vectorwise<T, false> rowwise(const DenseBase<T> &x)
+{
+    return vectorwise<T, false>(x.derived());
+}
+}
+
+IEXP_NS_END
+
+#endif /* __IEXP_STATS_COLWISE__ */
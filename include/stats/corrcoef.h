@@ -44,26 +44,38 @@ namespace stats {
 // ========================================
 
 template <typename T>
-inline double corrcoef_impl(const T data1[], const T data2[], size_t n)
+inline double corrcoef_impl(const T data1[],
+                            size_t stride1,
+                            const T data2[],
+                            size_t stride2,
+                            size_t n)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
 inline double corrcoef_impl(const double data1[],
+                            size_t stride1,
                             const double data2[],
+                            size_t stride2,
                             size_t n)
 {
-    return gsl_stats_correlation(data1, 1, data2, 1, n);
+    return gsl_stats_correlation(data1, stride1, data2, stride2, n);
 }
 
 #define DEFINE_CORRCOEF(type, name)                                            \
     template <>                                                                \
     inline double corrcoef_impl(const type data1[],                            \
+                                size_t stride1,                                \
                                 const type data2[],                            \
+                                size_t stride2,                                \
                                 size_t n)                                      \
     {                                                                          \
-        return gsl_stats_##name##_correlation(data1, 1, data2, 1, n);          \
+        return gsl_stats_##name##_correlation(data1,                           \
+                                              stride1,                         \
+                                              data2,                           \
+                                              stride2,                         \
+                                              n);                              \
     }
 DEFINE_CORRCOEF(char, char)
 DEFINE_CORRCOEF(unsigned char, uchar)
@@ -80,8 +92,12 @@ inline double corrcoef(const DenseBase<T> &data1, const DenseBase<T> &data2)
 {
     eigen_assert(data1.size() == data2.size());
 
-    typename type_eval<T>::type m_data1(data1.eval()), m_data2(data2.eval());
-    return corrcoef_impl(m_data1.data(), m_data2.data(), m_data1.size());
+    stride_eval<T> m_data1(data1), m_data2(data2);
+    return corrcoef_impl(m_data1.data(),
+                         m_data1.stride(),
+                         m_data2.data(),
+                         m_data2.stride(),
+                         m_data1.size());
 }
 
 // ========================================
@@ -90,7 +106,9 @@ inline double corrcoef(const DenseBase<T> &data1, const DenseBase<T> &data2)
 
 template <typename T>
 inline double spearman_impl(const T data1[],
+                            size_t stride1,
                             const T data2[],
+                            size_t stride2,
                             size_t n,
                             double work[])
 {
@@ -99,21 +117,30 @@ inline double spearman_impl(const T data1[],
 
 template <>
 inline double spearman_impl(const double data1[],
+                            size_t stride1,
                             const double data2[],
+                            size_t stride2,
                             size_t n,
                             double work[])
 {
-    return gsl_stats_spearman(data1, 1, data2, 1, n, work);
+    return gsl_stats_spearman(data1, stride1, data2, stride2, n, work);
 }
 
 #define DEFINE_SPEARMAN(type, name)                                            \
     template <>                                                                \
     inline double spearman_impl(const type data1[],                            \
+                                size_t stride1,                                \
                                 const type data2[],                            \
+                                size_t stride2,                                \
                                 size_t n,                                      \
                                 double work[])                                 \
     {                                                                          \
-        return gsl_stats_##name##_spearman(data1, 1, data2, 1, n, work);       \
+        return gsl_stats_##name##_spearman(data1,                              \
+                                           stride1,                            \
+                                           data2,                              \
+                                           stride2,                            \
+                                           n,                                  \
+                                           work);                              \
     }
 DEFINE_SPEARMAN(char, char)
 DEFINE_SPEARMAN(unsigned char, uchar)
@@ -130,11 +157,13 @@ inline double spearman(const DenseBase<T> &data1, const DenseBase<T> &data2)
 {
     eigen_assert(data1.size() == data2.size());
 
-    typename type_eval<T>::type m_data1(data1.eval()), m_data2(data2.eval());
+    stride_eval<T> m_data1(data1), m_data2(data2);
 
     std::unique_ptr<double> work(new double[data1.size() * 2]);
     return spearman_impl(m_data1.data(),
+                         m_data1.stride(),
                          m_data2.data(),
+                         m_data2.stride(),
                          m_data1.size(),
                          work.get());
 }
@@ -25,6 +25,8 @@
 
 #include <common/common.h>
 
+#include <stats/reduce.h>
+
 #include <gsl/gsl_statistics.h>
 
 IEXP_NS_BEGIN
@@ -44,22 +46,41 @@ namespace stats {
 // ========================================
 
 template <typename T>
-inline double cov_impl(const T data1[], const T data2[], size_t n)
+inline double cov_impl(const T data1[],
+                       size_t stride1,
+                       const T data2[],
+                       size_t stride2,
+                       size_t n)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
-inline double cov_impl(const double data1[], const double data2[], size_t n)
+inline double cov_impl(const double data1[],
+                       size_t stride1,
+                       const double data2[],
+                       size_t stride2,
+                       size_t n)
 {
-    return gsl_stats_covariance(data1, 1, data2, 1, n);
+    if (reduce::enabled(n)) {
+        return reduce::comoment(data1, stride1, data2, stride2, n) / (n - 1);
+    }
+    return gsl_stats_covariance(data1, stride1, data2, stride2, n);
 }
 
 #define DEFINE_COV(type, name)                                                 \
     template <>                                                                \
-    inline double cov_impl(const type data1[], const type data2[], size_t n)   \
+    inline double cov_impl(const type data1[],                                 \
+                           size_t stride1,                                     \
+                           const type data2[],                                 \
+                           size_t stride2,                                     \
+                           size_t n)                                           \
     {                                                                          \
-        return gsl_stats_##name##_covariance(data1, 1, data2, 1, n);           \
+        return gsl_stats_##name##_covariance(data1,                            \
+                                             stride1,                          \
+                                             data2,                            \
+                                             stride2,                          \
+                                             n);                               \
     }
 DEFINE_COV(char, char)
 DEFINE_COV(unsigned char, uchar)
@@ -76,8 +97,12 @@ inline double cov(const DenseBase<T> &data1, const DenseBase<T> &data2)
 {
     eigen_assert(data1.size() == data2.size());
 
-    typename type_eval<T>::type m_data1(data1.eval()), m_data2(data2.eval());
-    return cov_impl(m_data1.data(), m_data2.data(), m_data1.size());
+    stride_eval<T> m_data1(data1), m_data2(data2);
+    return cov_impl(m_data1.data(),
+                    m_data1.stride(),
+                    m_data2.data(),
+                    m_data2.stride(),
+                    m_data1.size());
 }
 
 // ========================================
@@ -85,34 +110,58 @@ inline double cov(const DenseBase<T> &data1, const DenseBase<T> &data2)
 // ========================================
 
 template <typename T>
-inline double cov_impl(
-    const T data1[], const T data2[], size_t n, double mean1, double mean2)
+inline double cov_impl(const T data1[],
+                       size_t stride1,
+                       const T data2[],
+                       size_t stride2,
+                       size_t n,
+                       double mean1,
+                       double mean2)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
 inline double cov_impl(const double data1[],
+                       size_t stride1,
                        const double data2[],
+                       size_t stride2,
                        size_t n,
                        double mean1,
                        double mean2)
 {
-    return gsl_stats_covariance_m(data1, 1, data2, 1, n, mean1, mean2);
+    if (reduce::enabled(n)) {
+        return reduce::comoment(data1,
+                                stride1,
+                                data2,
+                                stride2,
+                                n,
+                                mean1,
+                                mean2) / (n - 1);
+    }
+    return gsl_stats_covariance_m(data1,
+                                  stride1,
+                                  data2,
+                                  stride2,
+                                  n,
+                                  mean1,
+                                  mean2);
 }
 
 #define DEFINE_COV_M(type, name)                                               \
     template <>                                                                \
     inline double cov_impl(const type data1[],                                 \
+                           size_t stride1,                                     \
                            const type data2[],                                 \
+                           size_t stride2,                                     \
                            size_t n,                                           \
                            double mean1,                                       \
                            double mean2)                                       \
     {                                                                          \
         return gsl_stats_##name##_covariance_m(data1,                          \
-                                               1,                              \
+                                               stride1,                        \
                                                data2,                          \
-                                               1,                              \
+                                               stride2,                        \
                                                n,                              \
                                                mean1,                          \
                                                mean2);                         \
@@ -135,9 +184,11 @@ inline double cov(const DenseBase<T> &data1,
 {
     eigen_assert(data1.size() == data2.size());
 
-    typename type_eval<T>::type m_data1(data1.eval()), m_data2(data2.eval());
+    stride_eval<T> m_data1(data1), m_data2(data2);
     return cov_impl(m_data1.data(),
+                    m_data1.stride(),
                     m_data2.data(),
+                    m_data2.stride(),
                     m_data1.size(),
                     mean1,
                     mean2);
@@ -0,0 +1,198 @@
+/* Copyright (C) 2017 haniu (niuhao.cn@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef __IEXP_STATS_COV_MATRIX__
+#define __IEXP_STATS_COV_MATRIX__
+
+////////////////////////////////////////////////////////////
+// import header files
+////////////////////////////////////////////////////////////
+
+#include <common/common.h>
+
+#include <cmath>
+#include <limits>
+
+IEXP_NS_BEGIN
+
+namespace stats {
+
+////////////////////////////////////////////////////////////
+// macro definition
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// type definition
+////////////////////////////////////////////////////////////
+
+enum class nan_mode
+{
+    // a nan makes every entry of its variable nan
+    PROPAGATE,
+    // each pair of variables uses the observations where both are known
+    PAIRWISE,
+};
+
+// exact 1 on the diagonal of a correlation matrix where the variance of
+// the variable is finite and positive; nan, zero variance or too few
+// observations leave the diagonal nan
+inline void set_unit_diagonal(MatrixXd &r, const VectorXd &var)
+{
+    for (Index i = 0; i < r.rows(); ++i) {
+        r(i, i) = std::isfinite(var[i]) && (var[i] > 0)
+                      ? 1
+                      : std::numeric_limits<double>::quiet_NaN();
+    }
+}
+
+// covariance (corr = false) or correlation matrix of the columns of x,
+// rows being observations. w holds weights of observations or is null.
+//
+// columns are centred once and the cross products come from eigen's
+// blocked matrix products, a rank update filling half of the symmetric
+// result. with weights, the covariance follows gsl_stats_wvariance:
+// sum(w (x - m)(y - m)) * W / (W^2 - sum(w^2)), W being the sum of
+// positive weights; without weights it is the usual n - 1 estimate
+inline MatrixXd cov_matrix_impl(const MatrixXd &x, const VectorXd *w, bool corr)
+{
+    Index p = x.cols();
+    VectorXd m_w =
+        w != nullptr ? VectorXd(w->cwiseMax(0)) : VectorXd::Ones(x.rows());
+    double sw = m_w.sum(), sw2 = m_w.squaredNorm();
+
+    RowVectorXd mean = (m_w.transpose() * x) / sw;
+    MatrixXd xc = m_w.cwiseSqrt().asDiagonal() * (x.rowwise() - mean);
+
+    MatrixXd c = MatrixXd::Zero(p, p);
+    c.selfadjointView<Lower>().rankUpdate(xc.transpose());
+    MatrixXd r = c.selfadjointView<Lower>();
+    r *= sw / (sw * sw - sw2);
+
+    if (corr) {
+        VectorXd var = r.diagonal();
+        VectorXd d = var.cwiseSqrt().cwiseInverse();
+        r = d.asDiagonal() * r * d.asDiagonal();
+        set_unit_diagonal(r, var);
+    }
+    return r;
+}
+
+// pairwise complete version: with the 0/1 mask k of known values and x0
+// being x with nan replaced by 0, the sums restricted to the rows known
+// in both columns i and j are entries of products such as
+// x0' diag(w) k (sum of x_i) and k' diag(w) k (weight), so the whole
+// matrix still costs a few matrix products
+inline MatrixXd cov_matrix_pairwise_impl(const MatrixXd &x,
+                                         const VectorXd *w,
+                                         bool corr)
+{
+    Index n = x.rows();
+    VectorXd m_w = w != nullptr ? VectorXd(w->cwiseMax(0)) : VectorXd::Ones(n);
+
+    Array<bool, Dynamic, Dynamic> known = !x.array().isNaN();
+    MatrixXd k = known.cast<double>().matrix();
+    MatrixXd x0 = known.select(x.array(), 0).matrix();
+
+    // shifting columns by their mean changes nothing but cancellation
+    RowVectorXd shift =
+        x0.colwise().sum().cwiseQuotient(k.colwise().sum().cwiseMax(1));
+    x0 = known.select((x0.rowwise() - shift).array(), 0).matrix();
+
+    MatrixXd kw = m_w.asDiagonal() * k;
+    MatrixXd sw = k.transpose() * kw;
+    MatrixXd sw2 = k.transpose() * (m_w.cwiseAbs2().asDiagonal() * k);
+    MatrixXd s = x0.transpose() * kw;
+    MatrixXd sxy = x0.transpose() * (m_w.asDiagonal() * x0);
+
+    ArrayXXd cm = sxy.array() - s.array() * s.transpose().array() / sw.array();
+    if (!corr) {
+        ArrayXXd f = sw.array() / (sw.array().square() - sw2.array());
+        return (cm * f).matrix();
+    }
+
+    // variances over the same rows as the pair
+    MatrixXd sxx = x0.cwiseAbs2().transpose() * kw;
+    ArrayXXd v = sxx.array() - s.array().square() / sw.array();
+    MatrixXd r = (cm / (v * v.transpose()).sqrt()).matrix();
+    set_unit_diagonal(r, v.matrix().diagonal());
+    return r;
+}
+
+////////////////////////////////////////////////////////////
+// global variants
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// interface declaration
+////////////////////////////////////////////////////////////
+
+// covariance matrix of the columns of x, which are variables observed in
+// rows
+template <typename T>
+inline MatrixXd cov_matrix(const DenseBase<T> &x,
+                           nan_mode mode = nan_mode::PROPAGATE)
+{
+    MatrixXd m_x = x.derived().template cast<double>();
+    return mode == nan_mode::PAIRWISE
+               ? cov_matrix_pairwise_impl(m_x, nullptr, false)
+               : cov_matrix_impl(m_x, nullptr, false);
+}
+
+// weighted covariance matrix, w having a weight per row of x
+template <typename T, typename W>
+inline MatrixXd cov_matrix(const DenseBase<T> &x,
+                           const DenseBase<W> &w,
+                           nan_mode mode = nan_mode::PROPAGATE)
+{
+    eigen_assert(IS_VEC(w) && (w.size() == x.rows()));
+
+    MatrixXd m_x = x.derived().template cast<double>();
+    VectorXd m_w = w.derived().template cast<double>();
+    return mode == nan_mode::PAIRWISE
+               ? cov_matrix_pairwise_impl(m_x, &m_w, false)
+               : cov_matrix_impl(m_x, &m_w, false);
+}
+
+template <typename T>
+inline MatrixXd corr_matrix(const DenseBase<T> &x,
+                            nan_mode mode = nan_mode::PROPAGATE)
+{
+    MatrixXd m_x = x.derived().template cast<double>();
+    return mode == nan_mode::PAIRWISE
+               ? cov_matrix_pairwise_impl(m_x, nullptr, true)
+               : cov_matrix_impl(m_x, nullptr, true);
+}
+
+template <typename T, typename W>
+inline MatrixXd corr_matrix(const DenseBase<T> &x,
+                            const DenseBase<W> &w,
+                            nan_mode mode = nan_mode::PROPAGATE)
+{
+    eigen_assert(IS_VEC(w) && (w.size() == x.rows()));
+
+    MatrixXd m_x = x.derived().template cast<double>();
+    VectorXd m_w = w.derived().template cast<double>();
+    return mode == nan_mode::PAIRWISE
+               ? cov_matrix_pairwise_impl(m_x, &m_w, true)
+               : cov_matrix_impl(m_x, &m_w, true);
+}
+}
+
+IEXP_NS_END
+
+#endif /* __IEXP_STATS_COV_MATRIX__ */
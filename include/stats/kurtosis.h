@@ -44,22 +44,22 @@ namespace stats {
 // ========================================
 
 template <typename T>
-inline double kurtosis_impl(const T data[], size_t n)
+inline double kurtosis_impl(const T data[], size_t stride, size_t n)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
-inline double kurtosis_impl(const double data[], size_t n)
+inline double kurtosis_impl(const double data[], size_t stride, size_t n)
 {
-    return gsl_stats_kurtosis(data, 1, n);
+    return gsl_stats_kurtosis(data, stride, n);
 }
 
 #define DEFINE_KURTOSIS(type, name)                                            \
     template <>                                                                \
-    inline double kurtosis_impl(const type data[], size_t n)                   \
+    inline double kurtosis_impl(const type data[], size_t stride, size_t n)    \
     {                                                                          \
-        return gsl_stats_##name##_kurtosis(data, 1, n);                        \
+        return gsl_stats_##name##_kurtosis(data, stride, n);                   \
     }
 DEFINE_KURTOSIS(char, char)
 DEFINE_KURTOSIS(unsigned char, uchar)
@@ -74,8 +74,8 @@ DEFINE_KURTOSIS(long double, long_double)
 template <typename T>
 inline double kurtosis(const DenseBase<T> &data)
 {
-    typename type_eval<T>::type m_data(data.eval());
-    return kurtosis_impl(m_data.data(), m_data.size());
+    stride_eval<T> m_data(data);
+    return kurtosis_impl(m_data.data(), m_data.stride(), m_data.size());
 }
 
 // ========================================
@@ -84,6 +84,7 @@ inline double kurtosis(const DenseBase<T> &data)
 
 template <typename T>
 inline double kurtosis_mv_impl(const T data[],
+                               size_t stride,
                                size_t n,
                                double mean,
                                double std)
@@ -93,21 +94,23 @@ inline double kurtosis_mv_impl(const T data[],
 
 template <>
 inline double kurtosis_mv_impl(const double data[],
+                               size_t stride,
                                size_t n,
                                double mean,
                                double std)
 {
-    return gsl_stats_kurtosis_m_sd(data, 1, n, mean, std);
+    return gsl_stats_kurtosis_m_sd(data, stride, n, mean, std);
 }
 
 #define DEFINE_KURTOSIS_MV(type, name)                                         \
     template <>                                                                \
     inline double kurtosis_mv_impl(const type data[],                          \
+                                   size_t stride,                              \
                                    size_t n,                                   \
                                    double mean,                                \
                                    double std)                                 \
     {                                                                          \
-        return gsl_stats_##name##_kurtosis_m_sd(data, 1, n, mean, std);        \
+        return gsl_stats_##name##_kurtosis_m_sd(data, stride, n, mean, std);   \
     }
 DEFINE_KURTOSIS_MV(char, char)
 DEFINE_KURTOSIS_MV(unsigned char, uchar)
@@ -122,8 +125,12 @@ DEFINE_KURTOSIS_MV(long double, long_double)
 template <typename T>
 inline double kurtosis(const DenseBase<T> &data, double mean, double std)
 {
-    typename type_eval<T>::type m_data(data.eval());
-    return kurtosis_mv_impl(m_data.data(), m_data.size(), mean, std);
+    stride_eval<T> m_data(data);
+    return kurtosis_mv_impl(m_data.data(),
+                            m_data.stride(),
+                            m_data.size(),
+                            mean,
+                            std);
 }
 
 ////////////////////////////////////////////////////////////
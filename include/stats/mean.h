@@ -25,6 +25,8 @@
 
 #include <common/common.h>
 
+#include <stats/reduce.h>
+
 #include <gsl/gsl_statistics.h>
 
 IEXP_NS_BEGIN
@@ -44,22 +46,25 @@ namespace stats {
 // ========================================
 
 template <typename T>
-inline double mean_impl(const T data[], size_t n)
+inline double mean_impl(const T data[], size_t stride, size_t n)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
-inline double mean_impl(const double data[], size_t n)
+inline double mean_impl(const double data[], size_t stride, size_t n)
 {
-    return gsl_stats_mean(data, 1, n);
+    if (reduce::enabled(n)) {
+        return reduce::mean(data, stride, n);
+    }
+    return gsl_stats_mean(data, stride, n);
 }
 
 #define DEFINE_MEAN(type, name)                                                \
     template <>                                                                \
-    inline double mean_impl(const type data[], size_t n)                       \
+    inline double mean_impl(const type data[], size_t stride, size_t n)        \
     {                                                                          \
-        return gsl_stats_##name##_mean(data, 1, n);                            \
+        return gsl_stats_##name##_mean(data, stride, n);                       \
     }
 DEFINE_MEAN(char, char)
 DEFINE_MEAN(unsigned char, uchar)
@@ -74,8 +79,8 @@ DEFINE_MEAN(long double, long_double)
 template <typename T>
 inline double mean(const DenseBase<T> &data)
 {
-    typename type_eval<T>::type m_data(data.eval());
-    return mean_impl(m_data.data(), m_data.size());
+    stride_eval<T> m_data(data);
+    return mean_impl(m_data.data(), m_data.stride(), m_data.size());
 }
 
 // ========================================
@@ -83,15 +88,23 @@ inline double mean(const DenseBase<T> &data)
 // ========================================
 
 template <typename T>
-inline double wmean_impl(const T data[], const T w[], size_t n)
+inline double wmean_impl(const T data[],
+                         size_t stride,
+                         const T w[],
+                         size_t wstride,
+                         size_t n)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
-inline double wmean_impl(const double data[], const double w[], size_t n)
+inline double wmean_impl(const double data[],
+                         size_t stride,
+                         const double w[],
+                         size_t wstride,
+                         size_t n)
 {
-    return gsl_stats_wmean(w, 1, data, 1, n);
+    return gsl_stats_wmean(w, wstride, data, stride, n);
 }
 
 template <typename T>
@@ -99,8 +112,12 @@ inline double wmean(const DenseBase<T> &data, const DenseBase<T> &weight)
 {
     eigen_assert(data.size() == weight.size());
 
-    typename type_eval<T>::type m_data(data.eval()), m_w(weight.eval());
-    return wmean_impl(m_data.data(), m_w.data(), m_data.size());
+    stride_eval<T> m_data(data), m_w(weight);
+    return wmean_impl(m_data.data(),
+                      m_data.stride(),
+                      m_w.data(),
+                      m_w.stride(),
+                      m_data.size());
 }
 
 ////////////////////////////////////////////////////////////
@@ -40,22 +40,22 @@ namespace stats {
 ////////////////////////////////////////////////////////////
 
 template <typename T>
-inline double median_impl(const T data[], size_t n)
+inline double median_impl(const T data[], size_t stride, size_t n)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
-inline double median_impl(const double data[], size_t n)
+inline double median_impl(const double data[], size_t stride, size_t n)
 {
-    return gsl_stats_median_from_sorted_data(data, 1, n);
+    return gsl_stats_median_from_sorted_data(data, stride, n);
 }
 
 #define DEFINE_MEAN(type, name)                                                \
     template <>                                                                \
-    inline double median_impl(const type data[], size_t n)                     \
+    inline double median_impl(const type data[], size_t stride, size_t n)      \
     {                                                                          \
-        return gsl_stats_##name##_median_from_sorted_data(data, 1, n);         \
+        return gsl_stats_##name##_median_from_sorted_data(data, stride, n);    \
     }
 DEFINE_MEAN(char, char)
 DEFINE_MEAN(unsigned char, uchar)
@@ -70,8 +70,8 @@ DEFINE_MEAN(long double, long_double)
 template <typename T>
 inline double median(const DenseBase<T> &data)
 {
-    typename type_eval<T>::type m_data(data.eval());
-    return median_impl(m_data.data(), m_data.size());
+    stride_eval<T> m_data(data);
+    return median_impl(m_data.data(), m_data.stride(), m_data.size());
 }
 
 ////////////////////////////////////////////////////////////
@@ -0,0 +1,233 @@
+/* Copyright (C) 2017 haniu (niuhao.cn@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef __IEXP_STATS_MOMENTS__
+#define __IEXP_STATS_MOMENTS__
+
+////////////////////////////////////////////////////////////
+// import header files
+////////////////////////////////////////////////////////////
+
+#include <common/common.h>
+
+#include <limits>
+
+IEXP_NS_BEGIN
+
+namespace stats {
+
+////////////////////////////////////////////////////////////
+// macro definition
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// type definition
+////////////////////////////////////////////////////////////
+
+// ========================================
+// summary
+// ========================================
+
+// count, sum, min, max and the first four moments gathered in one pass.
+//
+// data is consumed in small blocks: a block is loaded once, its mean and
+// central moments are computed with vectorized eigen reductions while it
+// stays in cache, and blocks are combined with the pairwise update of
+// chan, golub and leveque extended to 3rd and 4th moments (pebay), which
+// is numerically stable. var, std, skewness and kurtosis follow the
+// definitions of the gsl_stats_* functions
+class summary
+{
+  public:
+    enum
+    {
+        BLOCK = 512,
+    };
+
+    summary()
+        : m_n(0)
+        , m_sum(0)
+        , m_mean(0)
+        , m_m2(0)
+        , m_m3(0)
+        , m_m4(0)
+        , m_min(std::numeric_limits<double>::infinity())
+        , m_max(-std::numeric_limits<double>::infinity())
+    {
+    }
+
+    template <typename T>
+    summary &add(const T data[], size_t n, size_t stride = 1)
+    {
+        using Vec = Array<T, Dynamic, 1>;
+
+        for (size_t i = 0; i < n; i += BLOCK) {
+            Index m = (Index)std::min<size_t>(BLOCK, n - i);
+            if (stride == 1) {
+                Map<const Vec> a(data + i, m);
+                add_block(a.template cast<double>());
+            } else {
+                Map<const Vec, 0, InnerStride<>> a(data + i * stride,
+                                                   m,
+                                                   InnerStride<>(stride));
+                add_block(a.template cast<double>());
+            }
+        }
+        return *this;
+    }
+
+    // summary of both data sets, e.g. computed by different threads
+    summary &merge(const summary &other)
+    {
+        if (other.m_n == 0) {
+            return *this;
+        }
+        if (m_n == 0) {
+            return *this = other;
+        }
+
+        double na = (double)m_n, nb = (double)other.m_n, n = na + nb;
+        double d = other.m_mean - m_mean, dn = d / n, dn2 = dn * dn;
+
+        m_m4 += other.m_m4 +
+                d * dn * dn2 * na * nb * (na * na - na * nb + nb * nb) +
+                6 * dn2 * (na * na * other.m_m2 + nb * nb * m_m2) +
+                4 * dn * (na * other.m_m3 - nb * m_m3);
+        m_m3 += other.m_m3 + d * dn2 * na * nb * (na - nb) +
+                3 * dn * (na * other.m_m2 - nb * m_m2);
+        m_m2 += other.m_m2 + d * dn * na * nb;
+        m_mean += nb * dn;
+
+        m_n += other.m_n;
+        m_sum += other.m_sum;
+        m_min = std::min(m_min, other.m_min);
+        m_max = std::max(m_max, other.m_max);
+        return *this;
+    }
+
+    size_t size() const
+    {
+        return m_n;
+    }
+
+    double sum() const
+    {
+        return m_sum;
+    }
+
+    double min() const
+    {
+        return m_min;
+    }
+
+    double max() const
+    {
+        return m_max;
+    }
+
+    double mean() const
+    {
+        return m_n > 0 ? m_mean : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    // sums of 2nd, 3rd and 4th powers of deviations from the mean
+    double m2() const
+    {
+        return m_m2;
+    }
+
+    double m3() const
+    {
+        return m_m3;
+    }
+
+    double m4() const
+    {
+        return m_m4;
+    }
+
+    double var() const
+    {
+        return m_m2 / (m_n - 1.0);
+    }
+
+    double std() const
+    {
+        return std::sqrt(var());
+    }
+
+    double skewness() const
+    {
+        double sd = std();
+        return m_m3 / m_n / (sd * sd * sd);
+    }
+
+    double kurtosis() const
+    {
+        double v = var();
+        return m_m4 / m_n / (v * v) - 3.0;
+    }
+
+  private:
+    template <typename A>
+    void add_block(const ArrayBase<A> &a)
+    {
+        Array<double, Dynamic, 1, ColMajor, BLOCK, 1> x(a);
+
+        summary b;
+        b.m_n = x.size();
+        b.m_sum = x.sum();
+        b.m_mean = b.m_sum / x.size();
+        b.m_min = x.minCoeff();
+        b.m_max = x.maxCoeff();
+
+        x -= b.m_mean;
+        Array<double, Dynamic, 1, ColMajor, BLOCK, 1> x2(x.square());
+        b.m_m2 = x2.sum();
+        b.m_m3 = (x2 * x).sum();
+        b.m_m4 = x2.square().sum();
+
+        merge(b);
+    }
+
+    size_t m_n;
+    double m_sum;
+    double m_mean;
+    double m_m2, m_m3, m_m4;
+    double m_min, m_max;
+};
+
+////////////////////////////////////////////////////////////
+// global variants
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// indexerface declaration
+////////////////////////////////////////////////////////////
+
+template <typename T>
+inline summary moments(const DenseBase<T> &data)
+{
+    stride_eval<T> m_data(data);
+    return summary().add(m_data.data(), m_data.size(), m_data.stride());
+}
+}
+
+IEXP_NS_END
+
+#endif /* __IEXP_STATS_MOMENTS__ */
@@ -40,22 +40,31 @@ namespace stats {
 ////////////////////////////////////////////////////////////
 
 template <typename T>
-inline double quantile_impl(const T data[], size_t n, double f)
+inline double quantile_impl(const T data[], size_t stride, size_t n, double f)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
-inline double quantile_impl(const double data[], size_t n, double f)
+inline double quantile_impl(const double data[],
+                            size_t stride,
+                            size_t n,
+                            double f)
 {
-    return gsl_stats_quantile_from_sorted_data(data, 1, n, f);
+    return gsl_stats_quantile_from_sorted_data(data, stride, n, f);
 }
 
 #define DEFINE_QUANTILE(type, name)                                            \
     template <>                                                                \
-    inline double quantile_impl(const type data[], size_t n, double f)         \
+    inline double quantile_impl(const type data[],                             \
+                                size_t stride,                                 \
+                                size_t n,                                      \
+                                double f)                                      \
     {                                                                          \
-        return gsl_stats_##name##_quantile_from_sorted_data(data, 1, n, f);    \
+        return gsl_stats_##name##_quantile_from_sorted_data(data,              \
+                                                            stride,            \
+                                                            n,                 \
+                                                            f);                \
     }
 DEFINE_QUANTILE(char, char)
 DEFINE_QUANTILE(unsigned char, uchar)
@@ -70,8 +79,8 @@ DEFINE_QUANTILE(long double, long_double)
 template <typename T>
 inline double quantile(const DenseBase<T> &data, double f)
 {
-    typename type_eval<T>::type m_data(data.eval());
-    return quantile_impl(m_data.data(), m_data.size(), f);
+    stride_eval<T> m_data(data);
+    return quantile_impl(m_data.data(), m_data.stride(), m_data.size(), f);
 }
 
 ////////////////////////////////////////////////////////////
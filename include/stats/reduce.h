@@ -0,0 +1,343 @@
+/* Copyright (C) 2017 haniu (niuhao.cn@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef __IEXP_STATS_REDUCE__
+#define __IEXP_STATS_REDUCE__
+
+////////////////////////////////////////////////////////////
+// import header files
+////////////////////////////////////////////////////////////
+
+#include <common/common.h>
+#include <common/parallel.h>
+
+#include <algorithm>
+#include <vector>
+
+IEXP_NS_BEGIN
+
+namespace stats {
+
+////////////////////////////////////////////////////////////
+// macro definition
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// type definition
+////////////////////////////////////////////////////////////
+
+// multi-threaded reductions used by the stats functions on large double
+// inputs, where the running sums of gsl are slow and lose precision.
+//
+// data is cut into cache sized blocks, each block is summed pairwise and
+// block results are merged along a fixed binary tree, with the parallel
+// variance formula of chan, golub and leveque for moments. the tree does
+// not depend on how blocks are spread over threads, so results are the
+// same whatever the number of threads
+class reduce
+{
+  public:
+    enum
+    {
+        BLOCK = 4096,
+        // leaves of the pairwise summation, summed with packets
+        LEAF = 64,
+        BLOCK_PER_TASK = 16,
+        // smaller inputs go to gsl
+        MIN_SIZE = 1 << 16,
+    };
+
+    static bool enabled(size_t n)
+    {
+        return n >= MIN_SIZE;
+    }
+
+    static double mean(const double data[], size_t stride, size_t n)
+    {
+        return run<double>(data, stride, n, block_sum<sum_op>{sum_op()}) / n;
+    }
+
+    // sum of squared deviations from the mean
+    static double m2(const double data[], size_t stride, size_t n)
+    {
+        return run<moment_part>(data, stride, n, block_moment).m2;
+    }
+
+    // sum of |x - mean|^power, power being 1 or 2
+    static double dev(const double data[],
+                      size_t stride,
+                      size_t n,
+                      double mean,
+                      int power)
+    {
+        if (power == 1) {
+            return run<double>(data, stride, n, block_sum<abs_op>{{mean}});
+        }
+        return run<double>(data, stride, n, block_sum<square_op>{{mean}});
+    }
+
+    // sum of (x - mean_x)(y - mean_y)
+    static double comoment(const double x[],
+                           size_t xstride,
+                           const double y[],
+                           size_t ystride,
+                           size_t n)
+    {
+        auto r = run2<comoment_part>(x, xstride, y, ystride, n, block_comoment);
+        return r.c;
+    }
+
+    static double comoment(const double x[],
+                           size_t xstride,
+                           const double y[],
+                           size_t ystride,
+                           size_t n,
+                           double xmean,
+                           double ymean)
+    {
+        block_sum2<cross_op> f{{xmean, ymean}};
+        return run2<double>(x, xstride, y, ystride, n, f);
+    }
+
+  private:
+    reduce() = delete;
+
+    struct moment_part
+    {
+        double n, mean, m2;
+
+        moment_part &operator+=(const moment_part &o)
+        {
+            double t = n + o.n, d = o.mean - mean;
+            m2 += o.m2 + d * d * n * o.n / t;
+            mean += d * o.n / t;
+            n = t;
+            return *this;
+        }
+    };
+
+    struct comoment_part
+    {
+        double n, xmean, ymean, c;
+
+        comoment_part &operator+=(const comoment_part &o)
+        {
+            double t = n + o.n, dx = o.xmean - xmean, dy = o.ymean - ymean;
+            c += o.c + dx * dy * n * o.n / t;
+            xmean += dx * o.n / t;
+            ymean += dy * o.n / t;
+            n = t;
+            return *this;
+        }
+    };
+
+    using Seg = Map<const ArrayXd>;
+
+    // leaves of the pairwise sums
+
+    struct sum_op
+    {
+        double operator()(const Seg &a) const
+        {
+            return a.sum();
+        }
+    };
+
+    struct abs_op
+    {
+        double mean;
+
+        double operator()(const Seg &a) const
+        {
+            return (a - mean).abs().sum();
+        }
+    };
+
+    struct square_op
+    {
+        double mean;
+
+        double operator()(const Seg &a) const
+        {
+            return (a - mean).square().sum();
+        }
+    };
+
+    struct cross_op
+    {
+        double xmean, ymean;
+
+        double operator()(const Seg &a, const Seg &b) const
+        {
+            return ((a - xmean) * (b - ymean)).sum();
+        }
+    };
+
+    template <typename Op>
+    static double pairwise(const double x[], size_t n, const Op &op)
+    {
+        if (n <= LEAF) {
+            return op(Seg(x, n));
+        }
+        size_t h = n / 2;
+        return pairwise(x, h, op) + pairwise(x + h, n - h, op);
+    }
+
+    template <typename Op>
+    static double pairwise(const double x[],
+                           const double y[],
+                           size_t n,
+                           const Op &op)
+    {
+        if (n <= LEAF) {
+            return op(Seg(x, n), Seg(y, n));
+        }
+        size_t h = n / 2;
+        return pairwise(x, y, h, op) + pairwise(x + h, y + h, n - h, op);
+    }
+
+    // block functions
+
+    template <typename Op>
+    struct block_sum
+    {
+        Op op;
+
+        double operator()(const double x[], size_t m) const
+        {
+            return pairwise(x, m, op);
+        }
+    };
+
+    template <typename Op>
+    struct block_sum2
+    {
+        Op op;
+
+        double operator()(const double x[], const double y[], size_t m) const
+        {
+            return pairwise(x, y, m, op);
+        }
+    };
+
+    static moment_part block_moment(const double x[], size_t m)
+    {
+        moment_part r;
+        r.n = (double)m;
+        r.mean = pairwise(x, m, sum_op()) / m;
+        r.m2 = pairwise(x, m, square_op{r.mean});
+        return r;
+    }
+
+    static comoment_part block_comoment(const double x[],
+                                        const double y[],
+                                        size_t m)
+    {
+        comoment_part r;
+        r.n = (double)m;
+        r.xmean = pairwise(x, m, sum_op()) / m;
+        r.ymean = pairwise(y, m, sum_op()) / m;
+        r.c = pairwise(x, y, m, cross_op{r.xmean, r.ymean});
+        return r;
+    }
+
+    // contiguous block, copied when data is strided
+    static const double *load(const double data[],
+                              size_t stride,
+                              size_t begin,
+                              size_t m,
+                              std::vector<double> &buf)
+    {
+        if (stride == 1) {
+            return data + begin;
+        }
+        buf.resize(BLOCK);
+        for (size_t i = 0; i < m; ++i) {
+            buf[i] = data[(begin + i) * stride];
+        }
+        return buf.data();
+    }
+
+    // merge block results along a fixed tree
+    template <typename R>
+    static R merge(std::vector<R> &r)
+    {
+        for (size_t step = 1; step < r.size(); step *= 2) {
+            for (size_t i = 0; i + step < r.size(); i += 2 * step) {
+                r[i] += r[i + step];
+            }
+        }
+        return r[0];
+    }
+
+    template <typename R, typename F>
+    static R run(const double data[], size_t stride, size_t n, const F &f)
+    {
+        size_t nb = (n + BLOCK - 1) / BLOCK;
+        std::vector<R> r(nb);
+        parallel::run((nb + BLOCK_PER_TASK - 1) / BLOCK_PER_TASK,
+                      [&](size_t t) {
+                          std::vector<double> buf;
+                          size_t end = std::min(nb, (t + 1) * BLOCK_PER_TASK);
+                          for (size_t b = t * BLOCK_PER_TASK; b < end; ++b) {
+                              size_t begin = b * BLOCK;
+                              size_t m = std::min<size_t>(BLOCK, n - begin);
+                              r[b] = f(load(data, stride, begin, m, buf), m);
+                          }
+                      });
+        return merge(r);
+    }
+
+    template <typename R, typename F>
+    static R run2(const double x[],
+                  size_t xstride,
+                  const double y[],
+                  size_t ystride,
+                  size_t n,
+                  const F &f)
+    {
+        size_t nb = (n + BLOCK - 1) / BLOCK;
+        std::vector<R> r(nb);
+        parallel::run((nb + BLOCK_PER_TASK - 1) / BLOCK_PER_TASK,
+                      [&](size_t t) {
+                          std::vector<double> xbuf, ybuf;
+                          size_t end = std::min(nb, (t + 1) * BLOCK_PER_TASK);
+                          for (size_t b = t * BLOCK_PER_TASK; b < end; ++b) {
+                              size_t begin = b * BLOCK;
+                              size_t m = std::min<size_t>(BLOCK, n - begin);
+                              r[b] = f(load(x, xstride, begin, m, xbuf),
+                                       load(y, ystride, begin, m, ybuf),
+                                       m);
+                          }
+                      });
+        return merge(r);
+    }
+};
+
+////////////////////////////////////////////////////////////
+// global variants
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// interface declaration
+////////////////////////////////////////////////////////////
+}
+
+IEXP_NS_END
+
+#endif /* __IEXP_STATS_REDUCE__ */
@@ -0,0 +1,169 @@
+/* Copyright (C) 2017 haniu (niuhao.cn@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef __IEXP_STATS_SELECT__
+#define __IEXP_STATS_SELECT__
+
+////////////////////////////////////////////////////////////
+// import header files
+////////////////////////////////////////////////////////////
+
+#include <common/common.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+IEXP_NS_BEGIN
+
+namespace stats {
+
+////////////////////////////////////////////////////////////
+// macro definition
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// type definition
+////////////////////////////////////////////////////////////
+
+// ========================================
+// order statistics
+// ========================================
+
+// partially orders data[begin, end) so that data[k] holds the element of
+// rank k for every k of the sorted ranks [k_begin, k_end). introselect on
+// the middle rank splits both the data and the ranks, so a handful of
+// ranks costs O(n log(ranks)) instead of a full sort
+template <typename T>
+inline void select_impl(T data[],
+                        size_t begin,
+                        size_t end,
+                        const size_t *k_begin,
+                        const size_t *k_end)
+{
+    if (k_begin == k_end) {
+        return;
+    }
+
+    const size_t *mid = k_begin + (k_end - k_begin) / 2;
+    std::nth_element(data + begin, data + *mid, data + end);
+    select_impl(data, begin, *mid, k_begin, mid);
+    select_impl(data, *mid + 1, end, mid + 1, k_end);
+}
+
+// the f quantiles of data[0, n), as gsl_stats_quantile_from_sorted_data
+// would compute them once data is sorted. data is reordered
+template <typename T>
+inline void quantile_select_impl(T data[],
+                                 size_t n,
+                                 const double f[],
+                                 size_t nf,
+                                 double q[])
+{
+    if (n == 0) {
+        std::fill(q, q + nf, std::numeric_limits<double>::quiet_NaN());
+        return;
+    }
+
+    // ranks needed: the one below each quantile and its successor
+    std::vector<size_t> k;
+    k.reserve(nf * 2);
+    for (size_t i = 0; i < nf; ++i) {
+        eigen_assert(f[i] >= 0 && f[i] <= 1);
+        size_t lhs = (size_t)(f[i] * (n - 1));
+        k.push_back(lhs);
+        if (lhs + 1 < n) {
+            k.push_back(lhs + 1);
+        }
+    }
+    std::sort(k.begin(), k.end());
+    k.erase(std::unique(k.begin(), k.end()), k.end());
+
+    select_impl(data, 0, n, k.data(), k.data() + k.size());
+
+    for (size_t i = 0; i < nf; ++i) {
+        double idx = f[i] * (n - 1);
+        size_t lhs = (size_t)idx;
+        double delta = idx - lhs;
+        if (lhs == n - 1) {
+            q[i] = (double)data[lhs];
+        } else {
+            q[i] = (1 - delta) * data[lhs] + delta * data[lhs + 1];
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////
+// global variants
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// interface declaration
+////////////////////////////////////////////////////////////
+
+// the elements of an expression in a scratch buffer, in any order
+template <typename T>
+inline std::vector<typename T::Scalar> select_buffer(const DenseBase<T> &data)
+{
+    using Scalar = typename T::Scalar;
+    std::vector<Scalar> buf((size_t)data.size());
+    Map<Matrix<Scalar, Dynamic, Dynamic>>(buf.data(),
+                                          data.rows(),
+                                          data.cols()) = data;
+    return buf;
+}
+
+// quantile of unsorted data in O(n), stats::quantile needs sorted data
+template <typename T>
+inline double quantile_select(const DenseBase<T> &data, double f)
+{
+    auto buf = select_buffer(data);
+    double q;
+    quantile_select_impl(buf.data(), buf.size(), &f, 1, &q);
+    return q;
+}
+
+template <typename T>
+inline double median_select(const DenseBase<T> &data)
+{
+    return quantile_select(data, 0.5);
+}
+
+// several quantiles of unsorted data, e.g. percentiles 1, 5, 25, 50, 75,
+// 95 and 99, from one partitioning pass over a single copy of data
+template <typename T, typename F>
+inline VectorXd quantiles(const DenseBase<T> &data, const DenseBase<F> &f)
+{
+    static_assert(TYPE_IS(typename F::Scalar, double),
+                  "only support double fractions");
+
+    auto buf = select_buffer(data);
+    VectorXd m_f(f.size()), q(f.size());
+    Map<Matrix<double, Dynamic, Dynamic>>(m_f.data(), f.rows(), f.cols()) = f;
+    quantile_select_impl(buf.data(),
+                         buf.size(),
+                         m_f.data(),
+                         m_f.size(),
+                         q.data());
+    return q;
+}
+}
+
+IEXP_NS_END
+
+#endif /* __IEXP_STATS_SELECT__ */
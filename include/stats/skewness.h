@@ -44,22 +44,22 @@ namespace stats {
 // ========================================
 
 template <typename T>
-inline double skewness_impl(const T data[], size_t n)
+inline double skewness_impl(const T data[], size_t stride, size_t n)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
-inline double skewness_impl(const double data[], size_t n)
+inline double skewness_impl(const double data[], size_t stride, size_t n)
 {
-    return gsl_stats_skew(data, 1, n);
+    return gsl_stats_skew(data, stride, n);
 }
 
 #define DEFINE_SKEWNESS(type, name)                                            \
     template <>                                                                \
-    inline double skewness_impl(const type data[], size_t n)                   \
+    inline double skewness_impl(const type data[], size_t stride, size_t n)    \
     {                                                                          \
-        return gsl_stats_##name##_skew(data, 1, n);                            \
+        return gsl_stats_##name##_skew(data, stride, n);                       \
     }
 DEFINE_SKEWNESS(char, char)
 DEFINE_SKEWNESS(unsigned char, uchar)
@@ -74,8 +74,8 @@ DEFINE_SKEWNESS(long double, long_double)
 template <typename T>
 inline double skewness(const DenseBase<T> &data)
 {
-    typename type_eval<T>::type m_data(data.eval());
-    return skewness_impl(m_data.data(), m_data.size());
+    stride_eval<T> m_data(data);
+    return skewness_impl(m_data.data(), m_data.stride(), m_data.size());
 }
 
 // ========================================
@@ -84,6 +84,7 @@ inline double skewness(const DenseBase<T> &data)
 
 template <typename T>
 inline double skewness_mv_impl(const T data[],
+                               size_t stride,
                                size_t n,
                                double mean,
                                double std)
@@ -93,21 +94,23 @@ inline double skewness_mv_impl(const T data[],
 
 template <>
 inline double skewness_mv_impl(const double data[],
+                               size_t stride,
                                size_t n,
                                double mean,
                                double std)
 {
-    return gsl_stats_skew_m_sd(data, 1, n, mean, std);
+    return gsl_stats_skew_m_sd(data, stride, n, mean, std);
 }
 
 #define DEFINE_SKEWNESS_MV(type, name)                                         \
     template <>                                                                \
     inline double skewness_mv_impl(const type data[],                          \
+                                   size_t stride,                              \
                                    size_t n,                                   \
                                    double mean,                                \
                                    double std)                                 \
     {                                                                          \
-        return gsl_stats_##name##_skew_m_sd(data, 1, n, mean, std);            \
+        return gsl_stats_##name##_skew_m_sd(data, stride, n, mean, std);       \
     }
 DEFINE_SKEWNESS_MV(char, char)
 DEFINE_SKEWNESS_MV(unsigned char, uchar)
@@ -122,8 +125,12 @@ DEFINE_SKEWNESS_MV(long double, long_double)
 template <typename T>
 inline double skewness(const DenseBase<T> &data, double mean, double std)
 {
-    typename type_eval<T>::type m_data(data.eval());
-    return skewness_mv_impl(m_data.data(), m_data.size(), mean, std);
+    stride_eval<T> m_data(data);
+    return skewness_mv_impl(m_data.data(),
+                            m_data.stride(),
+                            m_data.size(),
+                            mean,
+                            std);
 }
 
 // ========================================
@@ -131,22 +138,34 @@ inline double skewness(const DenseBase<T> &data, double mean, double std)
 // ========================================
 
 template <typename T>
-inline double wskewness_impl(const T data[], const T w[], size_t n)
+inline double wskewness_impl(const T data[],
+                             size_t stride,
+                             const T w[],
+                             size_t wstride,
+                             size_t n)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
-inline double wskewness_impl(const double data[], const double w[], size_t n)
+inline double wskewness_impl(const double data[],
+                             size_t stride,
+                             const double w[],
+                             size_t wstride,
+                             size_t n)
 {
-    return gsl_stats_wskew(w, 1, data, 1, n);
+    return gsl_stats_wskew(w, wstride, data, stride, n);
 }
 
 template <typename T>
 inline double wskewness(const DenseBase<T> &data, const DenseBase<T> &weight)
 {
-    typename type_eval<T>::type m_data(data.eval()), m_w(weight.eval());
-    return wskewness_impl(m_data.data(), m_w.data(), m_data.size());
+    stride_eval<T> m_data(data), m_w(weight);
+    return wskewness_impl(m_data.data(),
+                          m_data.stride(),
+                          m_w.data(),
+                          m_w.stride(),
+                          m_data.size());
 }
 
 // ========================================
@@ -154,17 +173,27 @@ inline double wskewness(const DenseBase<T> &data, const DenseBase<T> &weight)
 // ========================================
 
 template <typename T>
-inline double wskewness_mv_impl(
-    const T data[], const T w[], size_t n, double mean, double std)
+inline double wskewness_mv_impl(const T data[],
+                                size_t stride,
+                                const T w[],
+                                size_t wstride,
+                                size_t n,
+                                double mean,
+                                double std)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
-inline double wskewness_mv_impl(
-    const double data[], const double w[], size_t n, double mean, double std)
+inline double wskewness_mv_impl(const double data[],
+                                size_t stride,
+                                const double w[],
+                                size_t wstride,
+                                size_t n,
+                                double mean,
+                                double std)
 {
-    return gsl_stats_wskew_m_sd(w, 1, data, 1, n, mean, std);
+    return gsl_stats_wskew_m_sd(w, wstride, data, stride, n, mean, std);
 }
 
 template <typename T>
@@ -173,9 +202,11 @@ inline double wskewness(const DenseBase<T> &data,
                         double mean,
                         double std)
 {
-    typename type_eval<T>::type m_data(data.eval()), m_w(weight.eval());
+    stride_eval<T> m_data(data), m_w(weight);
     return wskewness_mv_impl(m_data.data(),
+                             m_data.stride(),
                              m_w.data(),
+                             m_w.stride(),
                              m_data.size(),
                              mean,
                              std);
@@ -186,22 +217,34 @@ inline double wskewness(const DenseBase<T> &data,
 // ========================================
 
 template <typename T>
-inline double wkurtosis_impl(const T data[], const T w[], size_t n)
+inline double wkurtosis_impl(const T data[],
+                             size_t stride,
+                             const T w[],
+                             size_t wstride,
+                             size_t n)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
-inline double wkurtosis_impl(const double data[], const double w[], size_t n)
+inline double wkurtosis_impl(const double data[],
+                             size_t stride,
+                             const double w[],
+                             size_t wstride,
+                             size_t n)
 {
-    return gsl_stats_wkurtosis(w, 1, data, 1, n);
+    return gsl_stats_wkurtosis(w, wstride, data, stride, n);
 }
 
 template <typename T>
 inline double wkurtosis(const DenseBase<T> &data, const DenseBase<T> &weight)
 {
-    typename type_eval<T>::type m_data(data.eval()), m_w(weight.eval());
-    return wkurtosis_impl(m_data.data(), m_w.data(), m_data.size());
+    stride_eval<T> m_data(data), m_w(weight);
+    return wkurtosis_impl(m_data.data(),
+                          m_data.stride(),
+                          m_w.data(),
+                          m_w.stride(),
+                          m_data.size());
 }
 
 // ========================================
@@ -209,17 +252,27 @@ inline double wkurtosis(const DenseBase<T> &data, const DenseBase<T> &weight)
 // ========================================
 
 template <typename T>
-inline double wkurtosis_mv_impl(
-    const T data[], const T w[], size_t n, double mean, double std)
+inline double wkurtosis_mv_impl(const T data[],
+                                size_t stride,
+                                const T w[],
+                                size_t wstride,
+                                size_t n,
+                                double mean,
+                                double std)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
-inline double wkurtosis_mv_impl(
-    const double data[], const double w[], size_t n, double mean, double std)
+inline double wkurtosis_mv_impl(const double data[],
+                                size_t stride,
+                                const double w[],
+                                size_t wstride,
+                                size_t n,
+                                double mean,
+                                double std)
 {
-    return gsl_stats_wkurtosis_m_sd(w, 1, data, 1, n, mean, std);
+    return gsl_stats_wkurtosis_m_sd(w, wstride, data, stride, n, mean, std);
 }
 
 template <typename T>
@@ -228,9 +281,11 @@ inline double wkurtosis(const DenseBase<T> &data,
                         double mean,
                         double std)
 {
-    typename type_eval<T>::type m_data(data.eval()), m_w(weight.eval());
+    stride_eval<T> m_data(data), m_w(weight);
     return wkurtosis_mv_impl(m_data.data(),
+                             m_data.stride(),
                              m_w.data(),
+                             m_w.stride(),
                              m_data.size(),
                              mean,
                              std);
@@ -25,6 +25,8 @@
 
 #include <common/common.h>
 
+#include <stats/reduce.h>
+
 #include <gsl/gsl_statistics.h>
 
 IEXP_NS_BEGIN
@@ -44,22 +46,25 @@ namespace stats {
 // ========================================
 
 template <typename T>
-inline double std_impl(const T data[], size_t n)
+inline double std_impl(const T data[], size_t stride, size_t n)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
-inline double std_impl(const double data[], size_t n)
+inline double std_impl(const double data[], size_t stride, size_t n)
 {
-    return gsl_stats_sd(data, 1, n);
+    if (reduce::enabled(n)) {
+        return std::sqrt(reduce::m2(data, stride, n) / (n - 1));
+    }
+    return gsl_stats_sd(data, stride, n);
 }
 
 #define DEFINE_STD(type, name)                                                 \
     template <>                                                                \
-    inline double std_impl(const type data[], size_t n)                        \
+    inline double std_impl(const type data[], size_t stride, size_t n)         \
     {                                                                          \
-        return gsl_stats_##name##_sd(data, 1, n);                              \
+        return gsl_stats_##name##_sd(data, stride, n);                         \
     }
 DEFINE_STD(char, char)
 DEFINE_STD(unsigned char, uchar)
@@ -74,8 +79,8 @@ DEFINE_STD(long double, long_double)
 template <typename T>
 inline double std(const DenseBase<T> &data)
 {
-    typename type_eval<T>::type m_data(data.eval());
-    return std_impl(m_data.data(), m_data.size());
+    stride_eval<T> m_data(data);
+    return std_impl(m_data.data(), m_data.stride(), m_data.size());
 }
 
 // ========================================
@@ -83,22 +88,31 @@ inline double std(const DenseBase<T> &data)
 // ========================================
 
 template <typename T>
-inline double std_m_impl(const T data[], size_t n, double mean)
+inline double std_m_impl(const T data[], size_t stride, size_t n, double mean)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
-inline double std_m_impl(const double data[], size_t n, double mean)
+inline double std_m_impl(const double data[],
+                         size_t stride,
+                         size_t n,
+                         double mean)
 {
-    return gsl_stats_sd_m(data, 1, n, mean);
+    if (reduce::enabled(n)) {
+        return std::sqrt(reduce::dev(data, stride, n, mean, 2) / (n - 1));
+    }
+    return gsl_stats_sd_m(data, stride, n, mean);
 }
 
 #define DEFINE_STD_M(type, name)                                               \
     template <>                                                                \
-    inline double std_m_impl(const type data[], size_t n, double mean)         \
+    inline double std_m_impl(const type data[],                                \
+                             size_t stride,                                    \
+                             size_t n,                                         \
+                             double mean)                                      \
     {                                                                          \
-        return gsl_stats_##name##_sd_m(data, 1, n, mean);                      \
+        return gsl_stats_##name##_sd_m(data, stride, n, mean);                 \
     }
 DEFINE_STD_M(char, char)
 DEFINE_STD_M(unsigned char, uchar)
@@ -113,8 +127,8 @@ DEFINE_STD_M(long double, long_double)
 template <typename T>
 inline double std(const DenseBase<T> &data, double mean)
 {
-    typename type_eval<T>::type m_data(data.eval());
-    return std_m_impl(m_data.data(), m_data.size(), mean);
+    stride_eval<T> m_data(data);
+    return std_m_impl(m_data.data(), m_data.stride(), m_data.size(), mean);
 }
 
 // ========================================
@@ -122,22 +136,28 @@ inline double std(const DenseBase<T> &data, double mean)
 // ========================================
 
 template <typename T>
-inline double ustd_m_impl(const T data[], size_t n, double mean)
+inline double ustd_m_impl(const T data[], size_t stride, size_t n, double mean)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
-inline double ustd_m_impl(const double data[], size_t n, double mean)
+inline double ustd_m_impl(const double data[],
+                          size_t stride,
+                          size_t n,
+                          double mean)
 {
-    return gsl_stats_sd_with_fixed_mean(data, 1, n, mean);
+    return gsl_stats_sd_with_fixed_mean(data, stride, n, mean);
 }
 
 #define DEFINE_USTD_M(type, name)                                              \
     template <>                                                                \
-    inline double ustd_m_impl(const type data[], size_t n, double mean)        \
+    inline double ustd_m_impl(const type data[],                               \
+                              size_t stride,                                   \
+                              size_t n,                                        \
+                              double mean)                                     \
     {                                                                          \
-        return gsl_stats_##name##_sd_with_fixed_mean(data, 1, n, mean);        \
+        return gsl_stats_##name##_sd_with_fixed_mean(data, stride, n, mean);   \
     }
 DEFINE_USTD_M(char, char)
 DEFINE_USTD_M(unsigned char, uchar)
@@ -152,8 +172,8 @@ DEFINE_USTD_M(long double, long_double)
 template <typename T>
 inline double ustd(const DenseBase<T> &data, double mean)
 {
-    typename type_eval<T>::type m_data(data.eval());
-    return ustd_m_impl(m_data.data(), m_data.size(), mean);
+    stride_eval<T> m_data(data);
+    return ustd_m_impl(m_data.data(), m_data.stride(), m_data.size(), mean);
 }
 
 // ========================================
@@ -161,22 +181,26 @@ inline double ustd(const DenseBase<T> &data, double mean)
 // ========================================
 
 template <typename T>
-inline double abstd_impl(const T data[], size_t n)
+inline double abstd_impl(const T data[], size_t stride, size_t n)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
-inline double abstd_impl(const double data[], size_t n)
+inline double abstd_impl(const double data[], size_t stride, size_t n)
 {
-    return gsl_stats_absdev(data, 1, n);
+    if (reduce::enabled(n)) {
+        double mean = reduce::mean(data, stride, n);
+        return reduce::dev(data, stride, n, mean, 1) / n;
+    }
+    return gsl_stats_absdev(data, stride, n);
 }
 
 #define DEFINE_ABSTD(type, name)                                               \
     template <>                                                                \
-    inline double abstd_impl(const type data[], size_t n)                      \
+    inline double abstd_impl(const type data[], size_t stride, size_t n)       \
     {                                                                          \
-        return gsl_stats_##name##_absdev(data, 1, n);                          \
+        return gsl_stats_##name##_absdev(data, stride, n);                     \
     }
 DEFINE_ABSTD(char, char)
 DEFINE_ABSTD(unsigned char, uchar)
@@ -191,8 +215,8 @@ DEFINE_ABSTD(long double, long_double)
 template <typename T>
 inline double abstd(const DenseBase<T> &data)
 {
-    typename type_eval<T>::type m_data(data.eval());
-    return abstd_impl(m_data.data(), m_data.size());
+    stride_eval<T> m_data(data);
+    return abstd_impl(m_data.data(), m_data.stride(), m_data.size());
 }
 
 // ========================================
@@ -200,22 +224,31 @@ inline double abstd(const DenseBase<T> &data)
 // ========================================
 
 template <typename T>
-inline double abstd_m_impl(const T data[], size_t n, double mean)
+inline double abstd_m_impl(const T data[], size_t stride, size_t n, double mean)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
-inline double abstd_m_impl(const double data[], size_t n, double mean)
+inline double abstd_m_impl(const double data[],
+                           size_t stride,
+                           size_t n,
+                           double mean)
 {
-    return gsl_stats_absdev_m(data, 1, n, mean);
+    if (reduce::enabled(n)) {
+        return reduce::dev(data, stride, n, mean, 1) / n;
+    }
+    return gsl_stats_absdev_m(data, stride, n, mean);
 }
 
 #define DEFINE_ABSTD_M(type, name)                                             \
     template <>                                                                \
-    inline double abstd_m_impl(const type data[], size_t n, double mean)       \
+    inline double abstd_m_impl(const type data[],                              \
+                               size_t stride,                                  \
+                               size_t n,                                       \
+                               double mean)                                    \
     {                                                                          \
-        return gsl_stats_##name##_absdev_m(data, 1, n, mean);                  \
+        return gsl_stats_##name##_absdev_m(data, stride, n, mean);             \
     }
 DEFINE_ABSTD_M(char, char)
 DEFINE_ABSTD_M(unsigned char, uchar)
@@ -230,8 +263,8 @@ DEFINE_ABSTD_M(long double, long_double)
 template <typename T>
 inline double abstd(const DenseBase<T> &data, double mean)
 {
-    typename type_eval<T>::type m_data(data.eval());
-    return abstd_m_impl(m_data.data(), m_data.size(), mean);
+    stride_eval<T> m_data(data);
+    return abstd_m_impl(m_data.data(), m_data.stride(), m_data.size(), mean);
 }
 
 // ========================================
@@ -239,15 +272,23 @@ inline double abstd(const DenseBase<T> &data, double mean)
 // ========================================
 
 template <typename T>
-inline double wstd_impl(const T data[], const T w[], size_t n)
+inline double wstd_impl(const T data[],
+                        size_t stride,
+                        const T w[],
+                        size_t wstride,
+                        size_t n)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
-inline double wstd_impl(const double data[], const double w[], size_t n)
+inline double wstd_impl(const double data[],
+                        size_t stride,
+                        const double w[],
+                        size_t wstride,
+                        size_t n)
 {
-    return gsl_stats_wsd(w, 1, data, 1, n);
+    return gsl_stats_wsd(w, wstride, data, stride, n);
 }
 
 template <typename T>
@@ -255,8 +296,12 @@ inline double wstd(const DenseBase<T> &data, const DenseBase<T> &weight)
 {
     eigen_assert(data.size() == weight.size());
 
-    typename type_eval<T>::type m_data(data.eval()), m_w(weight.eval());
-    return wstd_impl(m_data.data(), m_w.data(), m_data.size());
+    stride_eval<T> m_data(data), m_w(weight);
+    return wstd_impl(m_data.data(),
+                     m_data.stride(),
+                     m_w.data(),
+                     m_w.stride(),
+                     m_data.size());
 }
 
 // ========================================
@@ -264,18 +309,25 @@ inline double wstd(const DenseBase<T> &data, const DenseBase<T> &weight)
 // ========================================
 
 template <typename T>
-inline double wstd_impl(const T data[], const T w[], size_t n, double mean)
+inline double wstd_impl(const T data[],
+                        size_t stride,
+                        const T w[],
+                        size_t wstride,
+                        size_t n,
+                        double mean)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
 inline double wstd_impl(const double data[],
+                        size_t stride,
                         const double w[],
+                        size_t wstride,
                         size_t n,
                         double mean)
 {
-    return gsl_stats_wsd_m(w, 1, data, 1, n, mean);
+    return gsl_stats_wsd_m(w, wstride, data, stride, n, mean);
 }
 
 template <typename T>
@@ -285,8 +337,13 @@ inline double wstd(const DenseBase<T> &data,
 {
     eigen_assert(data.size() == weight.size());
 
-    typename type_eval<T>::type m_data(data.eval()), m_w(weight.eval());
-    return wstd_impl(m_data.data(), m_w.data(), m_data.size(), mean);
+    stride_eval<T> m_data(data), m_w(weight);
+    return wstd_impl(m_data.data(),
+                     m_data.stride(),
+                     m_w.data(),
+                     m_w.stride(),
+                     m_data.size(),
+                     mean);
 }
 
 // ========================================
@@ -294,18 +351,25 @@ inline double wstd(const DenseBase<T> &data,
 // ========================================
 
 template <typename T>
-inline double wustd_impl(const T data[], const T w[], size_t n, double mean)
+inline double wustd_impl(const T data[],
+                         size_t stride,
+                         const T w[],
+                         size_t wstride,
+                         size_t n,
+                         double mean)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
 inline double wustd_impl(const double data[],
+                         size_t stride,
                          const double w[],
+                         size_t wstride,
                          size_t n,
                          double mean)
 {
-    return gsl_stats_wsd_with_fixed_mean(w, 1, data, 1, n, mean);
+    return gsl_stats_wsd_with_fixed_mean(w, wstride, data, stride, n, mean);
 }
 
 template <typename T>
@@ -315,8 +379,13 @@ inline double wustd(const DenseBase<T> &data,
 {
     eigen_assert(data.size() == weight.size());
 
-    typename type_eval<T>::type m_data(data.eval()), m_w(weight.eval());
-    return wustd_impl(m_data.data(), m_w.data(), m_data.size(), mean);
+    stride_eval<T> m_data(data), m_w(weight);
+    return wustd_impl(m_data.data(),
+                      m_data.stride(),
+                      m_w.data(),
+                      m_w.stride(),
+                      m_data.size(),
+                      mean);
 }
 
 // ========================================
@@ -324,15 +393,23 @@ inline double wustd(const DenseBase<T> &data,
 // ========================================
 
 template <typename T>
-inline double wabstd_impl(const T data[], const T w[], size_t n)
+inline double wabstd_impl(const T data[],
+                          size_t stride,
+                          const T w[],
+                          size_t wstride,
+                          size_t n)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
-inline double wabstd_impl(const double data[], const double w[], size_t n)
+inline double wabstd_impl(const double data[],
+                          size_t stride,
+                          const double w[],
+                          size_t wstride,
+                          size_t n)
 {
-    return gsl_stats_wabsdev(w, 1, data, 1, n);
+    return gsl_stats_wabsdev(w, wstride, data, stride, n);
 }
 
 template <typename T>
@@ -340,8 +417,12 @@ inline double wabstd(const DenseBase<T> &data, const DenseBase<T> &weight)
 {
     eigen_assert(data.size() == weight.size());
 
-    typename type_eval<T>::type m_data(data.eval()), m_w(weight.eval());
-    return wabstd_impl(m_data.data(), m_w.data(), m_data.size());
+    stride_eval<T> m_data(data), m_w(weight);
+    return wabstd_impl(m_data.data(),
+                       m_data.stride(),
+                       m_w.data(),
+                       m_w.stride(),
+                       m_data.size());
 }
 
 // ========================================
@@ -349,18 +430,25 @@ inline double wabstd(const DenseBase<T> &data, const DenseBase<T> &weight)
 // ========================================
 
 template <typename T>
-inline double wabstd_impl(const T data[], const T w[], size_t n, double mean)
+inline double wabstd_impl(const T data[],
+                          size_t stride,
+                          const T w[],
+                          size_t wstride,
+                          size_t n,
+                          double mean)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
 inline double wabstd_impl(const double data[],
+                          size_t stride,
                           const double w[],
+                          size_t wstride,
                           size_t n,
                           double mean)
 {
-    return gsl_stats_wabsdev_m(w, 1, data, 1, n, mean);
+    return gsl_stats_wabsdev_m(w, wstride, data, stride, n, mean);
 }
 
 template <typename T>
@@ -370,8 +458,13 @@ inline double wabstd(const DenseBase<T> &data,
 {
     eigen_assert(data.size() == weight.size());
 
-    typename type_eval<T>::type m_data(data.eval()), m_w(weight.eval());
-    return wabstd_impl(m_data.data(), m_w.data(), m_data.size(), mean);
+    stride_eval<T> m_data(data), m_w(weight);
+    return wabstd_impl(m_data.data(),
+                       m_data.stride(),
+                       m_w.data(),
+                       m_w.stride(),
+                       m_data.size(),
+                       mean);
 }
 
 ////////////////////////////////////////////////////////////
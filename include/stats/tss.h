@@ -25,6 +25,8 @@
 
 #include <common/common.h>
 
+#include <stats/reduce.h>
+
 #include <gsl/gsl_statistics.h>
 
 IEXP_NS_BEGIN
@@ -44,22 +46,25 @@ namespace stats {
 // ========================================
 
 template <typename T>
-inline double tss_impl(const T data[], size_t n)
+inline double tss_impl(const T data[], size_t stride, size_t n)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
-inline double tss_impl(const double data[], size_t n)
+inline double tss_impl(const double data[], size_t stride, size_t n)
 {
-    return gsl_stats_tss(data, 1, n);
+    if (reduce::enabled(n)) {
+        return reduce::m2(data, stride, n);
+    }
+    return gsl_stats_tss(data, stride, n);
 }
 
 #define DEFINE_TSS(type, name)                                                 \
     template <>                                                                \
-    inline double tss_impl(const type data[], size_t n)                        \
+    inline double tss_impl(const type data[], size_t stride, size_t n)         \
     {                                                                          \
-        return gsl_stats_##name##_sd(data, 1, n);                              \
+        return gsl_stats_##name##_sd(data, stride, n);                         \
     }
 DEFINE_TSS(char, char)
 DEFINE_TSS(unsigned char, uchar)
@@ -74,8 +79,8 @@ DEFINE_TSS(long double, long_double)
 template <typename T>
 inline double tss(const DenseBase<T> &data)
 {
-    typename type_eval<T>::type m_data(data.eval());
-    return tss_impl(m_data.data(), m_data.size());
+    stride_eval<T> m_data(data);
+    return tss_impl(m_data.data(), m_data.stride(), m_data.size());
 }
 
 // ========================================
@@ -83,22 +88,31 @@ inline double tss(const DenseBase<T> &data)
 // ========================================
 
 template <typename T>
-inline double tss_m_impl(const T data[], size_t n, double mean)
+inline double tss_m_impl(const T data[], size_t stride, size_t n, double mean)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
-inline double tss_m_impl(const double data[], size_t n, double mean)
+inline double tss_m_impl(const double data[],
+                         size_t stride,
+                         size_t n,
+                         double mean)
 {
-    return gsl_stats_tss_m(data, 1, n, mean);
+    if (reduce::enabled(n)) {
+        return reduce::dev(data, stride, n, mean, 2);
+    }
+    return gsl_stats_tss_m(data, stride, n, mean);
 }
 
 #define DEFINE_TSS_M(type, name)                                               \
     template <>                                                                \
-    inline double tss_m_impl(const type data[], size_t n, double mean)         \
+    inline double tss_m_impl(const type data[],                                \
+                             size_t stride,                                    \
+                             size_t n,                                         \
+                             double mean)                                      \
     {                                                                          \
-        return gsl_stats_##name##_sd_m(data, 1, n, mean);                      \
+        return gsl_stats_##name##_sd_m(data, stride, n, mean);                 \
     }
 DEFINE_TSS_M(char, char)
 DEFINE_TSS_M(unsigned char, uchar)
@@ -113,8 +127,8 @@ DEFINE_TSS_M(long double, long_double)
 template <typename T>
 inline double tss(const DenseBase<T> &data, double mean)
 {
-    typename type_eval<T>::type m_data(data.eval());
-    return tss_m_impl(m_data.data(), m_data.size(), mean);
+    stride_eval<T> m_data(data);
+    return tss_m_impl(m_data.data(), m_data.stride(), m_data.size(), mean);
 }
 
 // ========================================
@@ -122,15 +136,23 @@ inline double tss(const DenseBase<T> &data, double mean)
 // ========================================
 
 template <typename T>
-inline double wtss_impl(const T data[], const T w[], size_t n)
+inline double wtss_impl(const T data[],
+                        size_t stride,
+                        const T w[],
+                        size_t wstride,
+                        size_t n)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
-inline double wtss_impl(const double data[], const double w[], size_t n)
+inline double wtss_impl(const double data[],
+                        size_t stride,
+                        const double w[],
+                        size_t wstride,
+                        size_t n)
 {
-    return gsl_stats_wtss(w, 1, data, 1, n);
+    return gsl_stats_wtss(w, wstride, data, stride, n);
 }
 
 template <typename T>
@@ -138,8 +160,12 @@ inline double wtss(const DenseBase<T> &data, const DenseBase<T> &weight)
 {
     eigen_assert(data.size() == weight.size());
 
-    typename type_eval<T>::type m_data(data.eval()), m_w(weight.eval());
-    return wtss_impl(m_data.data(), m_w.data(), m_data.size());
+    stride_eval<T> m_data(data), m_w(weight);
+    return wtss_impl(m_data.data(),
+                     m_data.stride(),
+                     m_w.data(),
+                     m_w.stride(),
+                     m_data.size());
 }
 
 // ========================================
@@ -147,18 +173,25 @@ inline double wtss(const DenseBase<T> &data, const DenseBase<T> &weight)
 // ========================================
 
 template <typename T>
-inline double wtss_impl(const T data[], const T w[], size_t n, double mean)
+inline double wtss_impl(const T data[],
+                        size_t stride,
+                        const T w[],
+                        size_t wstride,
+                        size_t n,
+                        double mean)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
 inline double wtss_impl(const double data[],
+                        size_t stride,
                         const double w[],
+                        size_t wstride,
                         size_t n,
                         double mean)
 {
-    return gsl_stats_wtss_m(w, 1, data, 1, n, mean);
+    return gsl_stats_wtss_m(w, wstride, data, stride, n, mean);
 }
 
 template <typename T>
@@ -168,8 +201,13 @@ inline double wtss(const DenseBase<T> &data,
 {
     eigen_assert(data.size() == weight.size());
 
-    typename type_eval<T>::type m_data(data.eval()), m_w(weight.eval());
-    return wtss_impl(m_data.data(), m_w.data(), m_data.size(), mean);
+    stride_eval<T> m_data(data), m_w(weight);
+    return wtss_impl(m_data.data(),
+                     m_data.stride(),
+                     m_w.data(),
+                     m_w.stride(),
+                     m_data.size(),
+                     mean);
 }
 
 ////////////////////////////////////////////////////////////
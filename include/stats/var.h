@@ -25,6 +25,8 @@
 
 #include <common/common.h>
 
+#include <stats/reduce.h>
+
 #include <gsl/gsl_statistics.h>
 
 IEXP_NS_BEGIN
@@ -44,22 +46,25 @@ namespace stats {
 // ========================================
 
 template <typename T>
-inline double var_impl(const T data[], size_t n)
+inline double var_impl(const T data[], size_t stride, size_t n)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
-inline double var_impl(const double data[], size_t n)
+inline double var_impl(const double data[], size_t stride, size_t n)
 {
-    return gsl_stats_variance(data, 1, n);
+    if (reduce::enabled(n)) {
+        return reduce::m2(data, stride, n) / (n - 1);
+    }
+    return gsl_stats_variance(data, stride, n);
 }
 
 #define DEFINE_VAR(type, name)                                                 \
     template <>                                                                \
-    inline double var_impl(const type data[], size_t n)                        \
+    inline double var_impl(const type data[], size_t stride, size_t n)         \
     {                                                                          \
-        return gsl_stats_##name##_variance(data, 1, n);                        \
+        return gsl_stats_##name##_variance(data, stride, n);                   \
     }
 DEFINE_VAR(char, char)
 DEFINE_VAR(unsigned char, uchar)
@@ -76,8 +81,8 @@ inline double var(const DenseBase<T> &data)
 {
     eigen_assert(IS_VEC(data));
 
-    typename type_eval<T>::type m_data(data.eval());
-    return var_impl(m_data.data(), m_data.size());
+    stride_eval<T> m_data(data);
+    return var_impl(m_data.data(), m_data.stride(), m_data.size());
 }
 
 // ========================================
@@ -85,22 +90,31 @@ inline double var(const DenseBase<T> &data)
 // ========================================
 
 template <typename T>
-inline double var_m_impl(const T data[], size_t n, double mean)
+inline double var_m_impl(const T data[], size_t stride, size_t n, double mean)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
-inline double var_m_impl(const double data[], size_t n, double mean)
+inline double var_m_impl(const double data[],
+                         size_t stride,
+                         size_t n,
+                         double mean)
 {
-    return gsl_stats_variance_m(data, 1, n, mean);
+    if (reduce::enabled(n)) {
+        return reduce::dev(data, stride, n, mean, 2) / (n - 1);
+    }
+    return gsl_stats_variance_m(data, stride, n, mean);
 }
 
 #define DEFINE_VAR_M(type, name)                                               \
     template <>                                                                \
-    inline double var_m_impl(const type data[], size_t n, double mean)         \
+    inline double var_m_impl(const type data[],                                \
+                             size_t stride,                                    \
+                             size_t n,                                         \
+                             double mean)                                      \
     {                                                                          \
-        return gsl_stats_##name##_variance_m(data, 1, n, mean);                \
+        return gsl_stats_##name##_variance_m(data, stride, n, mean);           \
     }
 DEFINE_VAR_M(char, char)
 DEFINE_VAR_M(unsigned char, uchar)
@@ -115,8 +129,8 @@ DEFINE_VAR_M(long double, long_double)
 template <typename T>
 inline double var(const DenseBase<T> &data, double mean)
 {
-    typename type_eval<T>::type m_data(data.eval());
-    return var_m_impl(m_data.data(), m_data.size(), mean);
+    stride_eval<T> m_data(data);
+    return var_m_impl(m_data.data(), m_data.stride(), m_data.size(), mean);
 }
 
 // ========================================
@@ -124,22 +138,31 @@ inline double var(const DenseBase<T> &data, double mean)
 // ========================================
 
 template <typename T>
-inline double uvar_impl(const T data[], size_t n, double mean)
+inline double uvar_impl(const T data[], size_t stride, size_t n, double mean)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
-inline double uvar_impl(const double data[], size_t n, double mean)
+inline double uvar_impl(const double data[],
+                        size_t stride,
+                        size_t n,
+                        double mean)
 {
-    return gsl_stats_variance_with_fixed_mean(data, 1, n, mean);
+    return gsl_stats_variance_with_fixed_mean(data, stride, n, mean);
 }
 
 #define DEFINE_UVAR_M(type, name)                                              \
     template <>                                                                \
-    inline double uvar_impl(const type data[], size_t n, double mean)          \
+    inline double uvar_impl(const type data[],                                 \
+                            size_t stride,                                     \
+                            size_t n,                                          \
+                            double mean)                                       \
     {                                                                          \
-        return gsl_stats_##name##_variance_with_fixed_mean(data, 1, n, mean);  \
+        return gsl_stats_##name##_variance_with_fixed_mean(data,               \
+                                                           stride,             \
+                                                           n,                  \
+                                                           mean);              \
     }
 DEFINE_UVAR_M(char, char)
 DEFINE_UVAR_M(unsigned char, uchar)
@@ -154,8 +177,8 @@ DEFINE_UVAR_M(long double, long_double)
 template <typename T>
 inline double uvar(const DenseBase<T> &data, double mean)
 {
-    typename type_eval<T>::type m_data(data.eval());
-    return uvar_impl(m_data.data(), m_data.size(), mean);
+    stride_eval<T> m_data(data);
+    return uvar_impl(m_data.data(), m_data.stride(), m_data.size(), mean);
 }
 
 // ========================================
@@ -163,15 +186,23 @@ inline double uvar(const DenseBase<T> &data, double mean)
 // ========================================
 
 template <typename T>
-inline double wvar_impl(const T data[], const T w[], size_t n)
+inline double wvar_impl(const T data[],
+                        size_t stride,
+                        const T w[],
+                        size_t wstride,
+                        size_t n)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
-inline double wvar_impl(const double data[], const double w[], size_t n)
+inline double wvar_impl(const double data[],
+                        size_t stride,
+                        const double w[],
+                        size_t wstride,
+                        size_t n)
 {
-    return gsl_stats_wvariance(w, 1, data, 1, n);
+    return gsl_stats_wvariance(w, wstride, data, stride, n);
 }
 
 template <typename T>
@@ -179,8 +210,12 @@ inline double wvar(const DenseBase<T> &data, const DenseBase<T> &weight)
 {
     eigen_assert(data.size() == weight.size());
 
-    typename type_eval<T>::type m_data(data.eval()), m_w(weight.eval());
-    return wvar_impl(m_data.data(), m_w.data(), m_data.size());
+    stride_eval<T> m_data(data), m_w(weight);
+    return wvar_impl(m_data.data(),
+                     m_data.stride(),
+                     m_w.data(),
+                     m_w.stride(),
+                     m_data.size());
 }
 
 // ========================================
@@ -188,18 +223,25 @@ inline double wvar(const DenseBase<T> &data, const DenseBase<T> &weight)
 // ========================================
 
 template <typename T>
-inline double wvar_impl(const T data[], const T w[], size_t n, double mean)
+inline double wvar_impl(const T data[],
+                        size_t stride,
+                        const T w[],
+                        size_t wstride,
+                        size_t n,
+                        double mean)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
 inline double wvar_impl(const double data[],
+                        size_t stride,
                         const double w[],
+                        size_t wstride,
                         size_t n,
                         double mean)
 {
-    return gsl_stats_wvariance_m(w, 1, data, 1, n, mean);
+    return gsl_stats_wvariance_m(w, wstride, data, stride, n, mean);
 }
 
 template <typename T>
@@ -209,8 +251,13 @@ inline double wvar(const DenseBase<T> &data,
 {
     eigen_assert(data.size() == weight.size());
 
-    typename type_eval<T>::type m_data(data.eval()), m_w(weight.eval());
-    return wvar_impl(m_data.data(), m_w.data(), m_data.size(), mean);
+    stride_eval<T> m_data(data), m_w(weight);
+    return wvar_impl(m_data.data(),
+                     m_data.stride(),
+                     m_w.data(),
+                     m_w.stride(),
+                     m_data.size(),
+                     mean);
 }
 
 // ========================================
@@ -218,18 +265,30 @@ inline double wvar(const DenseBase<T> &data,
 // ========================================
 
 template <typename T>
-inline double wuvar_impl(const T data[], const T w[], size_t n, double mean)
+inline double wuvar_impl(const T data[],
+                         size_t stride,
+                         const T w[],
+                         size_t wstride,
+                         size_t n,
+                         double mean)
 {
     UNSUPPORTED_TYPE(T);
 }
 
 template <>
 inline double wuvar_impl(const double data[],
+                         size_t stride,
                          const double w[],
+                         size_t wstride,
                          size_t n,
                          double mean)
 {
-    return gsl_stats_wvariance_with_fixed_mean(w, 1, data, 1, n, mean);
+    return gsl_stats_wvariance_with_fixed_mean(w,
+                                               wstride,
+                                               data,
+                                               stride,
+                                               n,
+                                               mean);
 }
 
 template <typename T>
@@ -239,8 +298,13 @@ inline double wuvar(const DenseBase<T> &data,
 {
     eigen_assert(data.size() == weight.size());
 
-    typename type_eval<T>::type m_data(data.eval()), m_w(weight.eval());
-    return wuvar_impl(m_data.data(), m_w.data(), m_data.size(), mean);
+    stride_eval<T> m_data(data), m_w(weight);
+    return wuvar_impl(m_data.data(),
+                      m_data.stride(),
+                      m_w.data(),
+                      m_w.stride(),
+                      m_data.size(),
+                      mean);
 }
 
 ////////////////////////////////////////////////////////////
@@ -1,10 +1,18 @@
 #include <../test/test_util.h>
 #include <catch.hpp>
+#include <histogram/concurrent.h>
+#include <histogram/hdr.h>
+#include <histogram/hist2alias.h>
 #include <histogram/hist.h>
 #include <histogram/hist2.h>
 #include <histogram/hist2pdf.h>
+#include <histogram/histalias.h>
+#include <histogram/histn.h>
+#include <histogram/kde.h>
 #include <histogram/histpdf.h>
 
+#include <thread>
+
 using namespace iexp;
 
 void test_empty(hist &h)
@@ -456,3 +464,484 @@ TEST_CASE("hist2_vec")
         hist h2(a + a);
     }
 }
+
+TEST_CASE("hist_uniform")
+{
+    // bin edges which are not exact in binary
+    hist h(7, 0.1, 0.8);
+    ArrayXd r(8);
+    for (size_t i = 0; i < h.size(); ++i) {
+        double low, up;
+        h.range(i, low, up);
+        r[i] = low;
+        r[i + 1] = up;
+
+        REQUIRE(h.find(low) == i);
+        REQUIRE(h.find(std::nextafter(up, low)) == i);
+        REQUIRE(h.find((low + up) / 2) == i);
+    }
+    REQUIRE(h.find(std::nextafter(0.1, 0.0)) == (size_t)-1);
+    REQUIRE(h.find(h.max()) == (size_t)-1);
+    REQUIRE(h.find(NAN) == (size_t)-1);
+
+    // same ranges, searched
+    hist hs(r);
+    ArrayXd x = ArrayXd::Random(10000) * 0.5 + 0.45;
+    h.add(x);
+    hs.add(x);
+    h << 0.1 << 0.8;
+    hs << 0.1 << 0.8;
+    for (size_t i = 0; i < h.size(); ++i) {
+        REQUIRE(h[i] == hs[i]);
+    }
+
+    hist2 h2(7, 0.1, 0.8, 3, -1, 2), h2s(r, Vector4d(-1, 0, 1, 2));
+    ArrayXd y = ArrayXd::Random(10000) * 2;
+    h2.add(x, y);
+    h2s.add(x, y);
+    for (size_t i = 0; i < h2.xsize(); ++i) {
+        for (size_t j = 0; j < h2.ysize(); ++j) {
+            REQUIRE(h2.get(i, j) == h2s.get(i, j));
+        }
+    }
+
+    size_t i, j;
+    REQUIRE(h2.find(0.1, 1.5, i, j));
+    REQUIRE((i == 0 && j == 2));
+    REQUIRE(!h2.find(0.1, 2, i, j));
+}
+
+TEST_CASE("hist_bulk")
+{
+    // enough samples to count in lanes, most of them in one bin
+    Matrix<double, Dynamic, Dynamic, RowMajor> x(300, 40);
+    x.setRandom();
+    x.topRows(200).setConstant(0.55);
+    MatrixXd w = MatrixXd::Random(300, 40);
+
+    hist h(20, -1, 1), hw(20, -1, 1), ref(20, -1, 1), refw(20, -1, 1);
+    h.add(x);
+    hw.add(x, w);
+    for (Index i = 0; i < x.rows(); ++i) {
+        for (Index j = 0; j < x.cols(); ++j) {
+            ref.add(x(i, j));
+            refw.add(x(i, j), w(i, j));
+        }
+    }
+    for (size_t i = 0; i < h.size(); ++i) {
+        REQUIRE(h[i] == ref[i]);
+        REQUIRE(__D_EQ9(hw[i], refw[i]));
+    }
+    REQUIRE(h.sum() == x.size());
+
+    // strided input, a row of a column major matrix
+    hist hr({-1, -0.5, 0, 0.2, 1}), hrref({-1, -0.5, 0, 0.2, 1});
+    hr.add(w.row(3));
+    for (Index j = 0; j < w.cols(); ++j) {
+        hrref << w(3, j);
+    }
+    for (size_t i = 0; i < hr.size(); ++i) {
+        REQUIRE(hr[i] == hrref[i]);
+    }
+
+    hist2 h2(8, -1, 1, 5, -1, 1), h2ref(8, -1, 1, 5, -1, 1);
+    h2.add(x, w, w.array().abs());
+    for (Index i = 0; i < x.rows(); ++i) {
+        for (Index j = 0; j < x.cols(); ++j) {
+            h2ref.add(x(i, j), w(i, j), std::abs(w(i, j)));
+        }
+    }
+    for (size_t i = 0; i < h2.xsize(); ++i) {
+        for (size_t j = 0; j < h2.ysize(); ++j) {
+            REQUIRE(__D_EQ9(h2.get(i, j), h2ref.get(i, j)));
+        }
+    }
+}
+
+TEST_CASE("hist_parallel")
+{
+    ArrayXd x = ArrayXd::Random(300000), y = ArrayXd::Random(300000);
+    ArrayXd w = y.abs();
+
+    hist h(50, -1, 1), hp(50, -1, 1);
+    h.add(x, w);
+    hp.add_parallel(x, w, 4);
+    for (size_t i = 0; i < h.size(); ++i) {
+        REQUIRE(__D_EQ9(h[i], hp[i]));
+    }
+    hp.reset();
+    hp.add_parallel(x);
+    REQUIRE(hp.sum() == x.size());
+
+    hist2 h2(10, -1, 1, 20, -1, 1), h2p(10, -1, 1, 20, -1, 1);
+    h2.add(x, y);
+    h2p.add_parallel(x, y, 3);
+    REQUIRE(h2p.sum() == x.size());
+    for (size_t i = 0; i < h2.xsize(); ++i) {
+        for (size_t j = 0; j < h2.ysize(); ++j) {
+            REQUIRE(h2.get(i, j) == h2p.get(i, j));
+        }
+    }
+
+    // producers pushing to one accumulator
+    concurrent_hist c(hist(50, -1, 1));
+    concurrent_hist2 c2(h2);
+    std::vector<std::thread> producer;
+    for (int t = 0; t < 4; ++t) {
+        producer.emplace_back([&, t]() {
+            for (Index i = t; i < x.size(); i += 4) {
+                c << x[i];
+                c2.add(x[i], y[i]);
+            }
+        });
+    }
+    for (auto &p : producer) {
+        p.join();
+    }
+
+    hist hc = c.get();
+    h.reset();
+    h.add(x);
+    for (size_t i = 0; i < h.size(); ++i) {
+        REQUIRE(hc[i] == h[i]);
+    }
+    hist2 hc2 = c2.get();
+    for (size_t i = 0; i < h2.xsize(); ++i) {
+        for (size_t j = 0; j < h2.ysize(); ++j) {
+            REQUIRE(hc2.get(i, j) == h2.get(i, j));
+        }
+    }
+
+    c.reset();
+    REQUIRE(c.get().sum() == 0);
+}
+
+TEST_CASE("histn")
+{
+    // 6 axes of 100 bins, points on a thin curve
+    std::vector<hist_range> axis(5, hist_range(100, -1, 1));
+    axis.push_back(hist_range({-1, -0.5, 0, 0.1, 0.2, 1}));
+    histn h(axis);
+    REQUIRE(h.dim() == 6);
+    REQUIRE(h.size() == 0);
+
+    ArrayXd t = ArrayXd::Random(20000);
+    MatrixXd p(t.size(), 6);
+    for (Index c = 0; c < 6; ++c) {
+        p.col(c) = (t * (c + 1)).sin();
+    }
+    p(0, 2) = 3;
+    h.add(p);
+    REQUIRE(h.sum() == t.size() - 1);
+    REQUIRE(h.size() < 2000);
+
+    // single points and lookups
+    double x[6] = {0.005, -0.5, 0.999, -1, 0, 0.15};
+    size_t idx[6];
+    REQUIRE(h.find(x, idx));
+    REQUIRE((idx[0] == 50 && idx[1] == 25 && idx[2] == 99 && idx[3] == 0));
+    REQUIRE((idx[4] == 50 && idx[5] == 3));
+    double before = h.get(idx);
+    h.add(x, 2.5);
+    REQUIRE(h.get(idx) == before + 2.5);
+    REQUIRE(h.get({1, 2, 3, 4, 5, 0}) == 0);
+
+    // marginals match direct histograms
+    hist m0 = h.project(0), d0(100, -1, 1);
+    d0.add(p.col(0));
+    d0.add(0.005, 2.5);
+    m0.add(p(0, 0), 1);
+    for (size_t i = 0; i < d0.size(); ++i) {
+        REQUIRE(m0[i] == d0[i]);
+    }
+    hist m5 = h.project(5);
+    REQUIRE(m5.size() == 5);
+
+    hist2 m13 = h.project(1, 3), d13(100, -1, 1, 100, -1, 1);
+    d13.add(p.col(1).tail(t.size() - 1), p.col(3).tail(t.size() - 1));
+    d13.add(-0.5, -1, 2.5);
+    for (size_t i = 0; i < d13.xsize(); ++i) {
+        for (size_t j = 0; j < d13.ysize(); ++j) {
+            REQUIRE(m13.get(i, j) == d13.get(i, j));
+        }
+    }
+
+    // merge of halves, weighted
+    VectorXd w = VectorXd::Constant(t.size(), 0.5);
+    histn a(axis), b(axis);
+    a.add(p.topRows(10000), w.head(10000));
+    b.add(p.bottomRows(10000), w.tail(10000));
+    a += b;
+    a += a;
+    REQUIRE(__D_EQ9(a.sum(), t.size() - 1));
+
+    double s = 0;
+    size_t n = 0;
+    h.each([&](const size_t i[], double v) {
+        s += v;
+        n += (i[5] < 5);
+    });
+    REQUIRE(s == h.sum());
+    REQUIRE(n == h.size());
+
+    h.reset();
+    REQUIRE(h.size() == 0);
+    REQUIRE(h.sum() == 0);
+
+    // radices beyond 2^53 stay exact
+    std::vector<hist_range> big(3, hist_range(1000004, 0, 1));
+    big.insert(big.begin(), hist_range(7, 0, 1));
+    histn g(big);
+    double y[4] = {0.01, 1 - 1e-9, 1 - 1e-9, 1 - 1e-9};
+    g.add(y);
+    g.each([&](const size_t i[], double) {
+        REQUIRE((i[0] == 0 && i[1] == 1000003 && i[2] == 1000003));
+        REQUIRE(i[3] == 1000003);
+    });
+    REQUIRE(g.get({0, 1000003, 1000003, 1000003}) == 1);
+}
+
+TEST_CASE("hdr_hist")
+{
+    // 1us to 100s
+    ArrayXd u = (ArrayXd::Random(100000) + 1) / 2;
+    ArrayXd x = 1e-6 * (u * 8 * std::log(10.0)).exp();
+
+    hdr_hist h(1e-6, 100, 3);
+    REQUIRE(std::abs(h.size() - 1024 * std::log2(1e8)) < 1024);
+    REQUIRE(h.find(100) == h.size() - 1);
+    REQUIRE(std::isnan(h.percentile(50)));
+    h.add(x);
+    REQUIRE(h.count() == (uint64_t)x.size());
+    REQUIRE(h.min() == x.minCoeff());
+    REQUIRE(h.max() == x.maxCoeff());
+
+    // bins are at most 1e-3 wide relatively
+    for (size_t i = 0; i < h.size(); i += 97) {
+        double lower, upper;
+        h.range(i, lower, upper);
+        REQUIRE(upper > lower);
+        REQUIRE((upper - lower) / lower <= 1e-3);
+        REQUIRE(h.find(lower) == i);
+        REQUIRE(h.find((lower + upper) / 2) == i);
+    }
+
+    std::vector<double> s(x.data(), x.data() + x.size());
+    std::sort(s.begin(), s.end());
+    VectorXd p(7), r;
+    p << 99.9, 0, 50, 90, 99, 99.99, 100;
+    r = h.percentile(p);
+    for (Index k = 0; k < p.size(); ++k) {
+        size_t n = std::max<size_t>(1, std::ceil(p[k] / 100 * s.size()));
+        double v = s[n - 1];
+        REQUIRE(r[k] >= v);
+        REQUIRE(r[k] <= v * (1 + 1e-3));
+        REQUIRE(r[k] == h.percentile(p[k]));
+    }
+    REQUIRE(h.median() == h.percentile(50));
+    REQUIRE(std::abs(h.mean() / x.mean() - 1) < 1e-3);
+
+    // out of range values
+    hdr_hist o(1, 1000, 2);
+    o << 0.5 << 5000 << NAN;
+    REQUIRE(o.count() == 2);
+    REQUIRE(o.get(0) == 1);
+    REQUIRE(o.get(o.size() - 1) == 1);
+    REQUIRE(o.min() == 0.5);
+    REQUIRE(o.max() == 5000);
+    REQUIRE(o.percentile(100) == 5000);
+
+    // concurrent recording and merge
+    hdr_hist c(1e-6, 100, 3), a(1e-6, 100, 3), b(1e-6, 100, 3);
+    std::vector<std::thread> producer;
+    for (int t = 0; t < 4; ++t) {
+        producer.emplace_back([&, t]() {
+            for (Index i = t; i < x.size(); i += 4) {
+                c.record(x[i]);
+            }
+        });
+    }
+    for (auto &t : producer) {
+        t.join();
+    }
+    a.add(x.head(30000));
+    b.add(x.tail(x.size() - 30000));
+    a += b;
+    for (size_t i = 0; i < h.size(); ++i) {
+        REQUIRE(c.get(i) == h.get(i));
+        REQUIRE(a.get(i) == h.get(i));
+    }
+    REQUIRE(a.min() == h.min());
+    REQUIRE(a.max() == h.max());
+
+    hdr_hist d(a);
+    REQUIRE(d.percentile(99) == h.percentile(99));
+    d.reset();
+    REQUIRE(d.count() == 0);
+    d = h;
+    REQUIRE(d.count() == h.count());
+    const hdr_hist &dr = d;
+    d = dr;
+    REQUIRE(d.count() == h.count());
+    REQUIRE(d.min() == h.min());
+    REQUIRE(d.max() == h.max());
+    for (size_t i = 0; i < h.size(); ++i) {
+        REQUIRE(d.get(i) == h.get(i));
+    }
+
+    // other bins
+    o = h;
+    REQUIRE(o.size() == h.size());
+    REQUIRE(o.lowest() == h.lowest());
+    REQUIRE(o.digits() == h.digits());
+    REQUIRE(o.count() == h.count());
+    for (size_t i = 0; i < h.size(); ++i) {
+        REQUIRE(o.get(i) == h.get(i));
+    }
+    REQUIRE(o.percentile(99) == h.percentile(99));
+}
+
+TEST_CASE("hist_alias")
+{
+    double range[] = {0, 1, 3, 4, 8, 9};
+    hist h(range, 6);
+    h.add(0.5, 1).add(1.5, 4).add(3.5, 0).add(5, 2.5).add(8.5, 0.5);
+
+    histalias a(h, DEFAULT_RNG_TYPE, 7);
+    VectorXd x(200000);
+    a.fill(x);
+    REQUIRE(x.minCoeff() >= 0);
+    REQUIRE(x.maxCoeff() < 9);
+
+    // bin frequencies and uniformity inside the bins
+    hist c(range, 6), f(18, 0, 9);
+    c.add(x);
+    f.add(x);
+    REQUIRE(c[2] == 0);
+    for (size_t i = 0; i < c.size(); ++i) {
+        double p = h[i] / h.sum();
+        REQUIRE(std::abs(c[i] / x.size() - p) < 5e-3);
+    }
+    for (size_t i = 2; i < 6; ++i) {
+        REQUIRE(std::abs(f[i] / f[2] - 1) < 0.05);
+    }
+
+    // fill and next draw the same uniforms
+    histalias b(h, DEFAULT_RNG_TYPE, 7);
+    for (Index i = 0; i < 100; ++i) {
+        REQUIRE(b.next() == x[i]);
+    }
+    b.seed(7);
+    Matrix<double, 2, 3> m;
+    b.next(m);
+    REQUIRE(m(0, 1) == x[1]);
+
+    hist z(range, 6);
+    REQUIRE_THROWS(histalias(z, DEFAULT_RNG_TYPE));
+    z.add(0.5, -1);
+    REQUIRE_THROWS(histalias(z, DEFAULT_RNG_TYPE));
+
+    // 2d
+    hist2 h2(3, 0, 3, 2, 0, 1);
+    h2.add(0.5, 0.5, 1).add(1.5, 0.2, 3).add(2.5, 0.7, 2).add(2.5, 0.2, 2);
+    hist2alias a2(h2);
+    ArrayXXd x2(400, 500), y2(400, 500);
+    a2.fill(x2, y2);
+    hist2 c2(3, 0, 3, 2, 0, 1);
+    c2.add(x2, y2);
+    REQUIRE(c2.sum() == x2.size());
+    for (size_t i = 0; i < h2.xsize(); ++i) {
+        for (size_t j = 0; j < h2.ysize(); ++j) {
+            double p = h2.get(i, j) / h2.sum();
+            REQUIRE(std::abs(c2.get(i, j) / x2.size() - p) < 5e-3);
+        }
+    }
+    double x1, y1;
+    a2.next(x1, y1);
+    REQUIRE((x1 >= 0 && x1 < 3 && y1 >= 0 && y1 < 1));
+}
+
+TEST_CASE("kde")
+{
+    // normal samples by box muller
+    ArrayXd u1 = (ArrayXd::Random(100000) + 1) / 2 + 1e-12;
+    ArrayXd u2 = (ArrayXd::Random(100000) + 1) / 2;
+    ArrayXd x = (-2 * u1.log()).sqrt() * (2 * M_PI * u2).cos();
+    ArrayXd y = (-2 * u1.log()).sqrt() * (2 * M_PI * u2).sin();
+    double n = x.size();
+
+    kde k(401, -6, 6);
+    k.add(x);
+    REQUIRE(__D_EQ9(k.binned().sum(), n));
+    double h = k.bandwidth();
+    REQUIRE(std::abs(h / (0.9 * std::pow(n, -0.2)) - 1) < 0.05);
+
+    VectorXd p = k.points(), d = k.density();
+    REQUIRE(p[0] == -6);
+    REQUIRE(__D_EQ9(p[400], 6));
+    REQUIRE(std::abs(d.sum() * 0.03 - 1) < 1e-6);
+    ArrayXd e = (-p.array().square() / 2).exp() / std::sqrt(2 * M_PI);
+    REQUIRE((d.array() - e).abs().maxCoeff() < 0.02);
+
+    // convolution by fft equals the direct sum
+    kde s(37, -1, 2);
+    s.add(x.head(1000));
+    hist b = s.binned();
+    double step = 3.0 / 36, bw = 0.2, norm = 0;
+    for (int j = -36; j <= 36; ++j) {
+        norm += std::exp(-0.5 * std::pow(j * step / bw, 2));
+    }
+    VectorXd ds = s.density(bw);
+    for (size_t i = 0; i < s.size(); ++i) {
+        double v = 0;
+        for (size_t j = 0; j < s.size(); ++j) {
+            double t = ((double)i - (double)j) * step / bw;
+            v += b[j] * std::exp(-0.5 * t * t);
+        }
+        REQUIRE(std::abs(ds[i] - v / (norm * step * b.sum())) < 1e-6);
+    }
+
+    // plug-in bandwidth is close to the amise optimum of a normal, and
+    // below the rule of thumb on bimodal data
+    double sj = k.bandwidth(kde::bw::SHEATHER_JONES);
+    REQUIRE(std::abs(sj / (1.06 * std::pow(n, -0.2)) - 1) < 0.15);
+    kde m(401, -8, 8);
+    m.add(x.head(50000) - 3);
+    m.add(x.tail(50000) + 3);
+    REQUIRE(m.bandwidth(kde::bw::SHEATHER_JONES) <
+            0.5 * m.bandwidth(kde::bw::SILVERMAN));
+
+    // from bins, and in parallel
+    hist hb(100, -5, 5);
+    hb.add(x);
+    kde kb(hb);
+    REQUIRE(__D_EQ9(kb.points()[0], -4.95));
+    REQUIRE(std::abs(kb.density().sum() * 0.1 - 1) < 1e-3);
+    kde kp(401, -6, 6);
+    kp.add_parallel(x, 3);
+    hist bp = kp.binned(), bk = k.binned();
+    for (size_t i = 0; i < kp.size(); ++i) {
+        REQUIRE(__D_EQ9(bp[i], bk[i]));
+    }
+
+    // 2d
+    kde2 k2(65, -4, 4, 81, -5, 5);
+    k2.add(x, y);
+    double hx, hy;
+    k2.bandwidth(hx, hy);
+    REQUIRE(std::abs(hx / std::pow(n, -1.0 / 6) - 1) < 0.05);
+    REQUIRE(std::abs(hy / std::pow(n, -1.0 / 6) - 1) < 0.05);
+    MatrixXd d2 = k2.density();
+    REQUIRE(d2.rows() == 65);
+    REQUIRE(d2.cols() == 81);
+    REQUIRE(std::abs(d2.sum() * 0.125 * 0.125 - 1) < 1e-3);
+    VectorXd px = k2.xpoints(), py = k2.ypoints();
+    for (Index i = 0; i < d2.rows(); i += 4) {
+        for (Index j = 0; j < d2.cols(); j += 4) {
+            double t = px[i] * px[i] + py[j] * py[j];
+            REQUIRE(std::abs(d2(i, j) - std::exp(-t / 2) / (2 * M_PI)) < 0.01);
+        }
+    }
+    k2.bandwidth(hx, hy, kde::bw::SHEATHER_JONES);
+    REQUIRE((hx > 0 && hy > 0));
+}
@@ -3,20 +3,24 @@
 #include <integral/cquad.h>
 #include <integral/fixed.h>
 #include <integral/glfixed.h>
+#include <integral/map.h>
 #include <integral/miser.h>
 #include <integral/monte.h>
 #include <integral/qag.h>
 #include <integral/qagi.h>
 #include <integral/qagp.h>
 #include <integral/qags.h>
+#include <integral/qagv.h>
 #include <integral/qawc.h>
 #include <integral/qawf.h>
 #include <integral/qawo.h>
 #include <integral/qaws.h>
 #include <integral/qng.h>
 #include <integral/vegas.h>
+#include <integral/workspace.h>
 #include <iostream>
 #include <test_util.h>
+#include <thread>
 
 using namespace iexp;
 using namespace std;
@@ -122,6 +126,54 @@ TEST_CASE("integral_qag")
     REQUIRE(__D_EQ_IN(result, -7.716049382715854665E-02, 1E-15));
 }
 
+TEST_CASE("integral_qagv")
+{
+    double result, abserr;
+    size_t ncall = 0, neval = 0;
+    auto f = [&](const double *x, double *y, size_t n, void *) {
+        ++ncall;
+        neval += n;
+        Map<const ArrayXd> m_x(x, n);
+        Map<ArrayXd>(y, n) = m_x.pow(2.6) * (1 / m_x).log();
+    };
+
+    integral::qagv q(0.0, 1e-10, integral::qagv::key::GAUSS15, 1000);
+    result = q(f, 0.0, 1.0, nullptr, &abserr);
+    REQUIRE(__D_EQ_IN(result, 7.716049382715854665E-02, 1E-15));
+    REQUIRE(std::abs(abserr / 6.679384885865053037E-12 - 1) < 1e-6);
+    // 15 points first, then 30 per bisection
+    REQUIRE(neval == 15 + 30 * (ncall - 1));
+
+    REQUIRE(q.epsabs() == 0.0);
+    REQUIRE(q.epsrel() == 1e-10);
+    REQUIRE(q.key() == integral::qagv::key::GAUSS15);
+
+    result = q(f, 1.0, 0.0, nullptr, &abserr);
+    REQUIRE(__D_EQ_IN(result, -7.716049382715854665E-02, 1E-15));
+    REQUIRE(std::abs(abserr / 6.679384885865053037E-12 - 1) < 1e-6);
+
+    // rule of 2n + 1 points is exact up to degree 3n + 1
+    auto poly = [](const double *x, double *y, size_t n, void *) {
+        for (size_t i = 0; i < n; ++i) {
+            y[i] = std::pow(x[i], 46) + 1;
+        }
+    };
+    q.key(integral::qagv::key::GAUSS31).limit(1);
+    result = q(poly, -1.0, 1.0);
+    REQUIRE(__D_EQ_IN(result, 2.0 / 47 + 2, 1E-14));
+
+    enum integral::qagv::key k[] = {integral::qagv::key::GAUSS21,
+                               integral::qagv::key::GAUSS41,
+                               integral::qagv::key::GAUSS51,
+                               integral::qagv::key::GAUSS61};
+    for (auto i : k) {
+        q.key(i).limit(1000);
+        result = q(f, 0.0, 1.0, nullptr, &abserr);
+        REQUIRE(std::abs(result - 7.716049382715854665E-02) < abserr);
+        REQUIRE(abserr < 1e-10 * result);
+    }
+}
+
 TEST_CASE("integral_qags")
 {
     double result, abserr;
@@ -820,6 +872,136 @@ TEST_CASE("integral_cquad")
     // integral::cquad qq2(q);
 }
 
+TEST_CASE("integral_map")
+{
+    VectorXd p = VectorXd::LinSpaced(200, 0, 20), e;
+
+    // int(x^p, 0, 1) = 1 / (p + 1)
+    VectorXd r = integral::map(integral::qags(0.0, 1e-10, 1000),
+                               p,
+                               [](double x, double p) { return pow(x, p); },
+                               0.0,
+                               1.0,
+                               &e);
+    REQUIRE(r.size() == 200);
+    REQUIRE(e.size() == 200);
+    for (Index i = 0; i < p.size(); ++i) {
+        REQUIRE(__D_EQ_IN(r[i], 1 / (p[i] + 1), 1E-9));
+        REQUIRE(e[i] < 1E-9);
+    }
+
+    // integer bounds
+    VectorXd r0 = integral::map(integral::qags(0.0, 1e-10, 1000),
+                                p,
+                                [](double x, double p) { return pow(x, p); },
+                                0,
+                                1);
+    REQUIRE(r0 == r);
+
+    // int(x^p * log(1 / x), 0, 1) = 1 / (p + 1)^2
+    auto fn = [](integral::qagv &q, double k, double *abserr) {
+        return q(
+            [k](const double *x, double *y, size_t n, void *) {
+                Map<const ArrayXd> m_x(x, n);
+                Map<ArrayXd>(y, n) = m_x.pow(k) * (1 / m_x).log();
+            },
+            0.0,
+            1.0,
+            nullptr,
+            abserr);
+    };
+    integral::qagv q(0.0, 1e-10, integral::qagv::key::GAUSS21, 1000);
+    VectorXd r1 = integral::map(q, p, fn, nullptr, 1);
+    r = integral::map(q, p, fn, &e, 4);
+    REQUIRE(r == r1);
+    for (Index i = 0; i < p.size(); ++i) {
+        REQUIRE(__D_EQ_IN(r[i], 1 / ((p[i] + 1) * (p[i] + 1)), 1E-9));
+        REQUIRE(e[i] < 1E-9);
+    }
+
+    REQUIRE_THROWS(integral::map(q,
+                                 p,
+                                 [](integral::qagv &, double k, double *) {
+                                     if (k > 10) {
+                                         throw std::runtime_error("map");
+                                     }
+                                     return k;
+                                 },
+                                 nullptr,
+                                 4));
+}
+
+TEST_CASE("integral_workspace_pool")
+{
+    auto fn = [](double x, void *) { return pow(x, 2.6); };
+
+    integral::workspace_pool::clear();
+    integral::workspace_stats s0 = integral::workspace_pool::stats();
+    REQUIRE(s0.cached == 0);
+
+    // temporary integrators reuse one workspace
+    for (int i = 0; i < 100; ++i) {
+        integral::qags q(0.0, 1e-10, 1000);
+        double r = q(fn, 0.0, 1.0);
+        REQUIRE(__D_EQ_IN(r, 1 / 3.6, 1E-10));
+    }
+    integral::workspace_stats s = integral::workspace_pool::stats();
+    REQUIRE(s.miss - s0.miss == 1);
+    REQUIRE(s.hit - s0.hit == 99);
+    REQUIRE(s.release - s0.release == 100);
+    REQUIRE(s.cached == 1);
+
+    // keyed by limit
+    {
+        integral::qags q(0.0, 1e-10, 500);
+        q(fn, 0.0, 1.0);
+        s = integral::workspace_pool::stats();
+        REQUIRE(s.miss - s0.miss == 2);
+        REQUIRE(s.cached == 1);
+
+        q.limit(1000);
+        s = integral::workspace_pool::stats();
+        REQUIRE(s.cached == 2);
+        q(fn, 0.0, 1.0);
+        s = integral::workspace_pool::stats();
+        REQUIRE(s.hit - s0.hit == 100);
+        REQUIRE(s.cached == 1);
+    }
+    s = integral::workspace_pool::stats();
+    REQUIRE(s.cached == 2);
+
+    // full list frees
+    {
+        std::vector<std::unique_ptr<integral::qags>> q;
+        for (int i = 0; i < integral::workspace_pool::CAPACITY + 2; ++i) {
+            q.emplace_back(new integral::qags(0.0, 1e-10, 1000));
+            (*q.back())(fn, 0.0, 1.0);
+        }
+    }
+    s = integral::workspace_pool::stats();
+    REQUIRE(s.cached == integral::workspace_pool::CAPACITY);
+    REQUIRE(s.drop - s0.drop == 3);
+
+    // other threads have their own lists
+    // catch assertions are not thread safe, check after join
+    size_t before = 1, after = 0;
+    std::thread t([&]() {
+        before = integral::workspace_pool::stats().cached;
+        integral::workspace_pool::release(
+            integral::workspace_pool::acquire(1000),
+            1000);
+        after = integral::workspace_pool::stats().cached;
+    });
+    t.join();
+    REQUIRE(before == 0);
+    REQUIRE(after == 1);
+    REQUIRE(integral::workspace_pool::stats().cached ==
+            integral::workspace_pool::CAPACITY);
+
+    integral::workspace_pool::clear();
+    REQUIRE(integral::workspace_pool::stats().cached == 0);
+}
+
 TEST_CASE("integral_glfixed")
 {
     double result;
@@ -0,0 +1,103 @@
+#include <../test/test_util.h>
+#include <catch.hpp>
+#include <movstat/movstat.h>
+
+#include <algorithm>
+
+using namespace iexp;
+
+TEST_CASE("movstat")
+{
+    // integers so that the window has ties
+    ArrayXd x = (ArrayXd::Random(2000) * 20).round();
+    size_t w = 37;
+
+    VectorXd mean = movstat::mean(x, w);
+    VectorXd var = movstat::var(x, w);
+    VectorXd min = movstat::min(x, w);
+    VectorXd max = movstat::max(x, w);
+    VectorXd med = movstat::median(x, w);
+    VectorXd q = movstat::quantile(x.matrix().transpose(), w, 0.9);
+    REQUIRE(mean.size() == x.size());
+
+    for (Index i = 0; i < x.size(); ++i) {
+        Index b = std::max<Index>(0, i - (Index)w + 1), n = i - b + 1;
+        ArrayXd s = x.segment(b, n);
+        std::sort(s.data(), s.data() + n);
+
+        double m = s.mean();
+        REQUIRE(__D_EQ_IN(mean[i], m, 1e-9));
+        if (n > 1) {
+            double v = (s - m).square().sum() / (n - 1);
+            REQUIRE(__D_EQ_IN(var[i], v, 1e-9));
+        }
+        REQUIRE(min[i] == s[0]);
+        REQUIRE(max[i] == s[n - 1]);
+
+        double f = 0.5 * (n - 1);
+        Index lhs = (Index)f;
+        double e = lhs == n - 1 ? s[lhs]
+                                : s[lhs] + (f - lhs) * (s[lhs + 1] - s[lhs]);
+        REQUIRE(__D_EQ_IN(med[i], e, 1e-9));
+
+        f = 0.9 * (n - 1);
+        lhs = (Index)f;
+        e = lhs == n - 1 ? s[lhs] : s[lhs] + (f - lhs) * (s[lhs + 1] - s[lhs]);
+        REQUIRE(__D_EQ_IN(q[i], e, 1e-9));
+    }
+
+    // small ranks, where evictions may empty the lower set
+    double fw[][2] = {{37, 0}, {37, 0.02}, {5, 0.2}, {2, 0}, {2, 0.5}, {2, 1}};
+    for (auto &c : fw) {
+        Index cw = (Index)c[0];
+        VectorXd cq = movstat::quantile(x, cw, c[1]);
+        for (Index i = 0; i < x.size(); ++i) {
+            Index b = std::max<Index>(0, i - cw + 1), n = i - b + 1;
+            ArrayXd s = x.segment(b, n);
+            std::sort(s.data(), s.data() + n);
+
+            double f = c[1] * (n - 1);
+            Index lhs = (Index)f;
+            double e = lhs == n - 1
+                           ? s[lhs]
+                           : s[lhs] + (f - lhs) * (s[lhs + 1] - s[lhs]);
+            REQUIRE(__D_EQ_IN(cq[i], e, 1e-9));
+        }
+    }
+
+    movstat::order o2(2, 0.0);
+    o2.push(1).push(5).push(10);
+    REQUIRE(o2.get() == 5);
+
+    VectorXd y(6);
+    y << 3, 1, 7, 9, 2, 8;
+    REQUIRE(__D_EQ9(movstat::quantile(y, 4, 0.2)[5], 5.0));
+
+    // streaming
+    movstat::moments mo(3);
+    movstat::minmax mm(3);
+    movstat::order o(3);
+    REQUIRE(std::isnan(mo.mean()));
+    REQUIRE(std::isnan(mm.min()));
+    REQUIRE(std::isnan(o.get()));
+
+    double d[] = {5, 1, 4, 2, 8};
+    for (double v : d) {
+        mo.push(v);
+        mm.push(v);
+        o.push(v);
+    }
+    REQUIRE(mo.size() == 3);
+    REQUIRE(__D_EQ9(mo.mean(), 14.0 / 3));
+    REQUIRE(__D_EQ9(mo.var(), 28.0 / 3));
+    REQUIRE(mm.min() == 2);
+    REQUIRE(mm.max() == 8);
+    REQUIRE(o.get() == 4);
+
+    mo.reset();
+    mm.reset();
+    o.reset();
+    REQUIRE(mo.size() == 0);
+    REQUIRE(mm.size() == 0);
+    REQUIRE(o.size() == 0);
+}
@@ -1,4 +1,6 @@
 #include <catch.hpp>
+#include <algorithm>
+#include <functional>
 #include <iostream>
 #include <math/constant.h>
 #include <rand/beta.h>
@@ -20,6 +22,7 @@
 #include <rand/gumbel1.h>
 #include <rand/gumbel2.h>
 #include <rand/hyper_geometric.h>
+#include <rand/invcdf.h>
 #include <rand/landau.h>
 #include <rand/landau.h>
 #include <rand/laplace.h>
@@ -39,12 +42,14 @@
 #include <rand/rand.h>
 #include <rand/rayleigh.h>
 #include <rand/rayleigh_tail.h>
+#include <rand/reservoir.h>
 #include <rand/sample.h>
 #include <rand/shuffle.h>
 #include <rand/spherical.h>
 #include <rand/t.h>
 #include <rand/weibull.h>
 #include <test_util.h>
+#include <vector>
 
 using namespace std;
 using namespace iexp;
@@ -1027,6 +1032,18 @@ TEST_CASE("test_gamma_rand")
     iexp::MatrixXd &wr = rand::gamma::fill(w, 2, 3);
     REQUIRE(&wr == &w);
 
+    {
+        VectorXd m(100000);
+        rand::gamma::fill(m, 2.5, 1.5, 1);
+        REQUIRE(m.minCoeff() > 0);
+        REQUIRE(__D_EQ_IN(m.mean(), 3.75, 0.05));
+        REQUIRE(__D_EQ_IN((m.array() - m.mean()).square().mean(), 5.625, 0.2));
+
+        rand::gamma::fill(m, 0.3, 2, 1);
+        REQUIRE(m.minCoeff() >= 0);
+        REQUIRE(__D_EQ_IN(m.mean(), 0.6, 0.02));
+    }
+
 #if 0 // #ifdef IEXP_MGL2
     VectorXd v1(100);
     rand::gamma::fill(v1, 2, 1);
@@ -1088,6 +1105,17 @@ TEST_CASE("test_beta")
         iexp::MatrixXd &wr = rand::beta::fill(w, 2, 3);
         REQUIRE(&wr == &w);
 
+        VectorXd m(100000);
+        rand::beta::fill(m, 2, 3, 1);
+        REQUIRE((m.minCoeff() > 0 && m.maxCoeff() < 1));
+        REQUIRE(__D_EQ_IN(m.mean(), 0.4, 0.01));
+
+        // both gamma draws underflow to 0 for tiny a and b
+        rand::beta::fill(m, 1e-3, 1e-3, 1);
+        REQUIRE(!m.hasNaN());
+        REQUIRE((m.minCoeff() >= 0 && m.maxCoeff() <= 1));
+        REQUIRE(__D_EQ_IN(m.mean(), 0.5, 0.02));
+
 #if 0 // #ifdef IEXP_MGL2
         VectorXd v1(100);
         rand::beta::fill(v1, 2, 2);
@@ -1770,6 +1798,11 @@ TEST_CASE("test_drch_rand")
         iexp::MatrixXd &wr = rand::drch::fill(w, 6, alpha);
         REQUIRE(&wr == &w);
 
+        MatrixXd m(6, 10000);
+        rand::drch::fill(m, 6, alpha, 1);
+        REQUIRE(((m.colwise().sum().array() - 1).abs() < 1e-9).all());
+        REQUIRE(__D_EQ_IN(m.row(5).mean(), 0.5 / 2.0, 0.02));
+
 #if 0 // #ifdef IEXP_MGL2
         MatrixXd v1(2, 100);
         rand::drch::fill(v1, 2, alpha);
@@ -2371,6 +2404,32 @@ TEST_CASE("test_shuffle")
 
     iexp::MatrixXd &wr = rand::shuffle(w);
     REQUIRE(&wr == &w);
+
+    // several blocks and merge levels, independent of thread count
+    VectorXi p(300001), p2(300001);
+    parallel::concurrency(4);
+    rand::permutation(p, 7);
+    parallel::concurrency(1);
+    rand::permutation(p2, 7);
+    parallel::concurrency(0);
+    REQUIRE(p == p2);
+    std::sort(p2.data(), p2.data() + p2.size());
+    REQUIRE(p2 == VectorXi::LinSpaced(300001, 0, 300000));
+
+    rand::permutation(p2, 8);
+    REQUIRE(p != p2);
+
+    // final position of the first item is uniform
+    double pos = 0;
+    for (unsigned long s = 1; s <= 200; ++s) {
+        Matrix<Index, Dynamic, 1> q = rand::permutation(200000, s);
+        Index i = 0;
+        while (q[i] != 0) {
+            ++i;
+        }
+        pos += i;
+    }
+    REQUIRE(std::fabs(pos / 200 - 100000) < 15000);
 }
 
 TEST_CASE("test_choose")
@@ -2402,3 +2461,179 @@ TEST_CASE("test_sample")
     v2 = rand::sample(rand::shuffle(v).array() + rand::shuffle(v).array(), 7);
     REQUIRE(v2.size() == 7);
 }
+
+TEST_CASE("test_pdf_packet")
+{
+    // odd size so that both packet and scalar tails are evaluated
+    ArrayXd x = ArrayXd::LinSpaced(101, -6, 6);
+    ArrayXXd xx = ArrayXXd::Random(7, 9) * 4;
+    ArrayXd y;
+
+    // vector expression and the scalar dist it must agree with
+    struct entry
+    {
+        std::function<ArrayXd(const ArrayXd &)> v;
+        std::function<double(double)> s;
+    };
+
+#define __PDF_ENTRY(d, f, ...)                                                 \
+    {                                                                          \
+        [](const ArrayXd &x) -> ArrayXd {                                      \
+            return rand::d::f(x, __VA_ARGS__);                                 \
+        },                                                                     \
+            [](double x) { return rand::d::dist(__VA_ARGS__).f(x); }           \
+    }
+#define __PDF_ENTRIES(d, ...)                                                  \
+    __PDF_ENTRY(d, pdf, __VA_ARGS__), __PDF_ENTRY(d, p, __VA_ARGS__),          \
+        __PDF_ENTRY(d, q, __VA_ARGS__)
+
+    std::vector<entry> table = {
+        __PDF_ENTRIES(gauss, 1.5),
+        __PDF_ENTRIES(exp, 2.0),
+        __PDF_ENTRIES(laplace, 0.7),
+        __PDF_ENTRIES(lgst, 1.2),
+        __PDF_ENTRIES(cauchy, 0.5),
+        __PDF_ENTRIES(cauchy, -0.5),
+        __PDF_ENTRIES(flat, -1.0, 3.0),
+        __PDF_ENTRY(rayl, pdf, 1.3),
+        __PDF_ENTRIES(lgnorm, 0.2, 0.8),
+    };
+
+#undef __PDF_ENTRIES
+#undef __PDF_ENTRY
+
+    for (const auto &e : table) {
+        y = e.v(x);
+        for (Index i = 0; i < x.size(); ++i) {
+            REQUIRE(__D_EQ9(y[i], e.s(x[i])));
+        }
+    }
+
+    // rayl::dist has no cdf
+    y = rand::rayl::q(x, 1.3) + rand::rayl::p(x, 1.3);
+    REQUIRE(((y - 1).abs() < 1e-12).all());
+
+    // a negative scale is taken by its absolute value, as in gsl
+    REQUIRE((rand::cauchy::pdf(x, -0.5) > 0).all());
+
+    // other scalars are evaluated in double
+    ArrayXi xi = ArrayXi::LinSpaced(13, -6, 6);
+    ArrayXf xf = x.cast<float>();
+    ArrayXd xid = xi.cast<double>(), xfd = xf.cast<double>();
+    REQUIRE((rand::gauss::pdf(xi, 1.5) == rand::gauss::pdf(xid, 1.5)).all());
+    REQUIRE((rand::flat::q(xi, -1.0, 3.0) == rand::flat::q(xid, -1.0, 3.0))
+                .all());
+    REQUIRE((rand::lgnorm::pdf(xf, 0.2, 0.8) ==
+             rand::lgnorm::pdf(xfd, 0.2, 0.8))
+                .all());
+    REQUIRE((rand::exp::p(xf, 2.0) == rand::exp::p(xfd, 2.0)).all());
+
+    // fused with surrounding expressions, 2d layout
+    double ll = rand::gauss::pdf(xx, 2.0).log().sum();
+    double ll2 = 0;
+    rand::gauss::dist gd2(2.0);
+    for (Index j = 0; j < xx.cols(); ++j) {
+        for (Index i = 0; i < xx.rows(); ++i) {
+            ll2 += std::log(gd2.pdf(xx(i, j)));
+        }
+    }
+    REQUIRE(__D_EQ9(ll, ll2));
+}
+
+TEST_CASE("test_invcdf")
+{
+    rand::gauss::dist gd(2.0);
+    rand::invcdf::table gt(gd, precision::SINGLE);
+    REQUIRE(gt.size() > rand::invcdf::table::INIT_NODE);
+
+    // the targeted error is met between nodes and in the tails
+    ArrayXd u = ArrayXd::LinSpaced(1001, 1e-9, 1 - 1e-9);
+    for (Index i = 0; i < u.size(); ++i) {
+        double x = gd.invp(u[i]);
+        REQUIRE(std::fabs(gt(u[i]) - x) <=
+                gt.tolerance() * (std::fabs(x) + 2.7));
+    }
+
+    // monotone
+    ArrayXd x = rand::invcdf::invp(u, gt);
+    REQUIRE(((x.tail(1000) - x.head(1000)) >= 0).all());
+
+    rand::gamma::dist gmd(2.5, 1.5);
+    rand::invcdf::table gmt(
+        [&gmd](double u) { return gmd.invp(u); }, precision::APPROX);
+    for (Index i = 0; i < u.size(); ++i) {
+        double x = gmd.invp(u[i]);
+        REQUIRE(std::fabs(gmt(u[i]) - x) <=
+                gmt.tolerance() * (std::fabs(x) + 3));
+    }
+
+    VectorXd v(100000);
+    rand::invcdf::fill(v, gmt, 1);
+    REQUIRE(std::fabs(v.mean() - 3.75) < 0.05);
+
+    rand::invcdf::rng r(gmt, DEFAULT_RNG_TYPE, 1);
+    VectorXd v2(100000);
+    rand::invcdf::fill(v2, r);
+    REQUIRE(v2 == v);
+}
+
+TEST_CASE("test_reservoir")
+{
+    // uniform: every item has inclusion probability k / n
+    VectorXd hit = VectorXd::Zero(100);
+    for (unsigned long s = 1; s <= 2000; ++s) {
+        rand::reservoir<int> r(10, s);
+        for (int i = 0; i < 100; ++i) {
+            r.add(i);
+        }
+        REQUIRE(r.size() == 10);
+        REQUIRE(r.count() == 100);
+        VectorXi v = r.sample();
+        for (Index i = 0; i < v.size(); ++i) {
+            hit[v[i]] += 1;
+        }
+    }
+    hit /= 2000;
+    REQUIRE(std::fabs(hit.head(50).mean() - 0.1) < 0.005);
+    REQUIRE(std::fabs(hit.tail(50).mean() - 0.1) < 0.005);
+
+    // weighted, k = 1: probability proportional to weight
+    VectorXd w(4), x(4), freq = VectorXd::Zero(4);
+    w << 1, 2, 3, 4;
+    x << 0, 1, 2, 3;
+    for (unsigned long s = 1; s <= 20000; ++s) {
+        rand::reservoir<> r(1, s);
+        r.add(x, w);
+        freq[(int)r.sample()[0]] += 1;
+    }
+    freq /= 20000;
+    for (int i = 0; i < 4; ++i) {
+        REQUIRE(std::fabs(freq[i] - w[i] / 10) < 0.015);
+    }
+
+    // merged reservoirs sample the concatenated stream
+    double first = 0;
+    for (unsigned long s = 1; s <= 1000; ++s) {
+        rand::reservoir<int> a(20, s), b(20, s + 100000);
+        for (int i = 0; i < 300; ++i) {
+            a.add(i);
+        }
+        for (int i = 300; i < 1200; ++i) {
+            b.add(i);
+        }
+        a.merge(b);
+        REQUIRE(a.size() == 20);
+        REQUIRE(a.count() == 1200);
+        first += (a.sample().array() < 300).count();
+    }
+    REQUIRE(std::fabs(first / 20000 - 0.25) < 0.02);
+
+    VectorXd v = VectorXd::LinSpaced(10, 0, 9);
+    VectorXd wv = VectorXd::Ones(10);
+    wv[3] = 0;
+    VectorXd vs = rand::wsample(v, wv, 9);
+    REQUIRE(vs.size() == 9);
+    REQUIRE((vs.array() != 3).all());
+    RowVectorXd vs2 = rand::wsample<true>(v, wv, 20);
+    REQUIRE(vs2.size() == 9);
+}
@@ -1,6 +1,10 @@
 #include <../test/test_util.h>
 #include <catch.hpp>
+#include <rstat/ewstat.h>
 #include <rstat/rstat.h>
+#include <rstat/tdigest.h>
+
+#include <numeric>
 
 using namespace iexp;
 
@@ -29,3 +33,231 @@ TEST_CASE("rstat")
     rs.reset();
     REQUIRE(rs.size() == 0);
 }
+
+TEST_CASE("rstat_merge")
+{
+    iexp::ArrayXd c = iexp::ArrayXd::Random(1000) * 5 + 3;
+
+    rstat all;
+    for (int i = 0; i < c.size(); ++i) {
+        all.add(c[i]);
+    }
+
+    // bulk add
+    rstat bulk;
+    bulk.add(c);
+    REQUIRE(bulk.size() == all.size());
+    REQUIRE(bulk.min() == all.min());
+    REQUIRE(bulk.max() == all.max());
+    REQUIRE(__D_EQ_IN(bulk.mean(), all.mean(), 1e-12));
+    REQUIRE(__D_EQ_IN(bulk.var(), all.var(), 1e-12));
+    REQUIRE(__D_EQ_IN(bulk.skewness(), all.skewness(), 1e-12));
+    REQUIRE(__D_EQ_IN(bulk.kurtosis(), all.kurtosis(), 1e-12));
+    REQUIRE(bulk.median() == all.median());
+
+    // shards merged
+    rstat a, b, e;
+    a.add(c.head(300));
+    b.add(c.segment(300, 697));
+    for (int i = 997; i < 1000; ++i) {
+        e.add(c[i]);
+    }
+    a.merge(b).merge(e);
+    REQUIRE(a.size() == all.size());
+    REQUIRE(a.min() == all.min());
+    REQUIRE(a.max() == all.max());
+    REQUIRE(__D_EQ_IN(a.mean(), all.mean(), 1e-12));
+    REQUIRE(__D_EQ_IN(a.var(), all.var(), 1e-12));
+    REQUIRE(__D_EQ_IN(a.std_mean(), all.std_mean(), 1e-12));
+    REQUIRE(__D_EQ_IN(a.skewness(), all.skewness(), 1e-12));
+    REQUIRE(__D_EQ_IN(a.kurtosis(), all.kurtosis(), 1e-12));
+    // approximate
+    REQUIRE(__D_EQ_IN(a.median(), all.median(), 0.5));
+
+    // small accumulators merge the median exactly
+    rstat s1, s2, s3;
+    s1.add(1).add(5).add(2);
+    s2.add(4).add(3);
+    s3.add(1).add(5).add(2).add(4).add(3);
+    s1.merge(s2);
+    REQUIRE(s1.median() == s3.median());
+
+    // merged with itself, small and large
+    rstat s4, s5;
+    s4.add(1).add(5).add(2);
+    s5.add(1).add(5).add(2).add(1).add(5).add(2);
+    s4.merge(s4);
+    REQUIRE(s4.size() == 6);
+    REQUIRE(__D_EQ_IN(s4.mean(), s5.mean(), 1e-12));
+    REQUIRE(__D_EQ_IN(s4.var(), s5.var(), 1e-12));
+    REQUIRE(s4.median() == s5.median());
+
+    rstat twice(all);
+    twice.merge(twice);
+    REQUIRE(twice.size() == 2 * all.size());
+    REQUIRE(twice.min() == all.min());
+    REQUIRE(twice.max() == all.max());
+    REQUIRE(__D_EQ_IN(twice.mean(), all.mean(), 1e-12));
+    REQUIRE(__D_EQ_IN(twice.var(), all.var() * 1998 / 1999, 1e-12));
+    REQUIRE(__D_EQ_IN(twice.median(), all.median(), 0.5));
+
+    // state round trip, then keep adding
+    rstat::state st = a.save();
+    rstat r(st), cp(a);
+    REQUIRE(r.size() == a.size());
+    REQUIRE(r.var() == a.var());
+    REQUIRE(r.median() == a.median());
+    r.add(100.0);
+    cp.add(100.0);
+    REQUIRE(r.max() == 100.0);
+    REQUIRE(r.kurtosis() == cp.kurtosis());
+    REQUIRE(r.median() == cp.median());
+}
+
+TEST_CASE("tdigest")
+{
+    // skewed samples, exact quantiles from the sorted copy
+    iexp::ArrayXd x = ((iexp::ArrayXd::Random(100000) + 1) * 3).exp();
+    std::vector<double> sorted(x.data(), x.data() + x.size());
+    std::sort(sorted.begin(), sorted.end());
+    auto rank = [&](double v) {
+        return (double)(std::upper_bound(sorted.begin(), sorted.end(), v) -
+                        sorted.begin()) /
+               sorted.size();
+    };
+
+    tdigest td;
+    REQUIRE(std::isnan(td.quantile(0.5)));
+
+    td.add(x);
+    REQUIRE(td.weight() == x.size());
+    REQUIRE(td.min() == sorted.front());
+    REQUIRE(td.max() == sorted.back());
+    REQUIRE(td.size() <= td.compression());
+    REQUIRE(td.quantile(0) == sorted.front());
+    REQUIRE(td.quantile(1) == sorted.back());
+
+    // rank error, much tighter at the tails
+    REQUIRE(__D_EQ_IN(rank(td.quantile(0.5)), 0.5, 5e-3));
+    REQUIRE(__D_EQ_IN(rank(td.quantile(0.25)), 0.25, 5e-3));
+    REQUIRE(__D_EQ_IN(rank(td.quantile(0.01)), 0.01, 1e-3));
+    REQUIRE(__D_EQ_IN(rank(td.quantile(0.99)), 0.99, 1e-3));
+    REQUIRE(__D_EQ_IN(rank(td.quantile(0.001)), 0.001, 5e-4));
+    REQUIRE(__D_EQ_IN(rank(td.quantile(0.999)), 0.999, 5e-4));
+
+    iexp::VectorXd f(3);
+    f << 0.1, 0.5, 0.9;
+    iexp::VectorXd q = td.quantile(f);
+    for (int i = 0; i < f.size(); ++i) {
+        REQUIRE(q[i] == td.quantile(f[i]));
+        REQUIRE(__D_EQ_IN(td.cdf(q[i]), f[i], 1e-6));
+    }
+    REQUIRE(td.cdf(sorted.front() - 1) == 0);
+    REQUIRE(td.cdf(sorted.back()) == 1);
+
+    // digests of parts, e.g. one per thread
+    tdigest part[4], all;
+    for (int i = 0; i < x.size(); ++i) {
+        part[i % 4].add(x[i]);
+    }
+    for (int i = 0; i < 4; ++i) {
+        all.merge(part[i]);
+    }
+    REQUIRE(all.weight() == x.size());
+    REQUIRE(all.size() <= all.compression());
+    REQUIRE(__D_EQ_IN(rank(all.quantile(0.5)), 0.5, 5e-3));
+    REQUIRE(__D_EQ_IN(rank(all.quantile(0.999)), 0.999, 5e-4));
+
+    // readers leave buffered samples alone, flush() merges them
+    double m = part[0].quantile(0.5);
+    REQUIRE(part[0].quantile(0.5) == m);
+    REQUIRE(part[0].flush().quantile(0.5) == m);
+
+    // self merge doubles the weight
+    part[1].merge(part[1]);
+    REQUIRE(part[1].weight() == 2 * part[2].weight());
+    REQUIRE(__D_EQ_IN(rank(part[1].quantile(0.5)), 0.5, 1e-2));
+
+    // weighted samples
+    tdigest w;
+    w.add(1, 3).add(2, 1);
+    REQUIRE(w.weight() == 4);
+    REQUIRE(w.quantile(0.25) <= 1.5);
+
+    td.reset();
+    REQUIRE(td.weight() == 0);
+    REQUIRE(td.size() == 0);
+}
+
+TEST_CASE("ewstat")
+{
+    // irregular timestamps
+    iexp::ArrayXd x = iexp::ArrayXd::Random(500) * 4 + 1;
+    iexp::ArrayXd dt = (iexp::ArrayXd::Random(500) + 1.1) / 2;
+    iexp::ArrayXd t(500);
+    std::partial_sum(dt.data(), dt.data() + dt.size(), t.data());
+
+    ewstat ew(10);
+    REQUIRE(std::isnan(ew.mean()));
+    for (int i = 0; i < x.size(); ++i) {
+        ew.add(x[i], t[i]);
+    }
+
+    // direct weighted formulas
+    iexp::ArrayXd w = (-(t[t.size() - 1] - t) / 10 * std::log(2.0)).exp();
+    double sw = w.sum(), sw2 = w.square().sum();
+    double m = (w * x).sum() / sw;
+    double v = (w * (x - m).square()).sum() * sw / (sw * sw - sw2);
+    REQUIRE(__D_EQ9(ew.mean(), m));
+    REQUIRE(__D_EQ9(ew.var(), v));
+    REQUIRE(__D_EQ9(ew.weight(), sw));
+    REQUIRE(__D_EQ9(ew.effective_size(), sw * sw / sw2));
+    REQUIRE(ew.time() == t[t.size() - 1]);
+
+    // bulk
+    ewstat bulk(10);
+    bulk.add(x, t);
+    REQUIRE(__D_EQ9(bulk.mean(), m));
+    REQUIRE(__D_EQ9(bulk.var(), v));
+
+    // interleaved streams of two threads
+    ewstat a(10), b(10);
+    for (int i = 0; i < x.size(); ++i) {
+        (i % 3 == 0 ? a : b).add(x[i], t[i]);
+    }
+    a.merge(b);
+    REQUIRE(__D_EQ9(a.mean(), m));
+    REQUIRE(__D_EQ9(a.var(), v));
+    REQUIRE(__D_EQ9(a.weight(), sw));
+
+    // regular stream, the state forgets old samples
+    ewstat r(5);
+    r.add(iexp::ArrayXd::Constant(100, 3));
+    r.add(iexp::ArrayXd::Constant(200, 7));
+    REQUIRE(__D_EQ6(r.mean(), 7));
+    REQUIRE(r.time() == 299);
+
+    ew.reset();
+    REQUIRE(ew.weight() == 0);
+}
+
+TEST_CASE("ewquantile")
+{
+    // the 0.9 quantile of uniform(-1, 1) is 0.8
+    iexp::ArrayXd x = iexp::ArrayXd::Random(100000);
+    ewquantile q(1000, 0.9), a(1000, 0.9), b(1000, 0.9);
+    REQUIRE(std::isnan(q.get()));
+
+    q.add(x);
+    REQUIRE(__D_EQ_IN(q.get(), 0.8, 0.03));
+    REQUIRE(__D_EQ_IN(q.stat().mean(), 0, 0.05));
+
+    // then the distribution shifts
+    q.add(iexp::ArrayXd(iexp::ArrayXd::Random(20000) + 10));
+    REQUIRE(__D_EQ_IN(q.get(), 10.8, 0.03));
+
+    a.add(x.head(50000));
+    b.add(x.tail(50000));
+    a.merge(b);
+    REQUIRE(__D_EQ_IN(a.get(), 0.8, 0.03));
+}
@@ -1,14 +1,20 @@
 #include <../test/test_util.h>
+#include <algorithm>
 #include <catch.hpp>
 #include <iostream>
 #include <sort/sort.h>
 #include <stats/autocorr.h>
+#include <stats/colwise.h>
 #include <stats/corrcoef.h>
 #include <stats/cov.h>
+#include <stats/cov_matrix.h>
 #include <stats/kurtosis.h>
 #include <stats/mean.h>
 #include <stats/median.h>
+#include <stats/moments.h>
 #include <stats/quantile.h>
+#include <stats/reduce.h>
+#include <stats/select.h>
 #include <stats/skewness.h>
 #include <stats/std.h>
 #include <stats/tss.h>
@@ -323,6 +329,155 @@ TEST_CASE("stat_kurtosis")
     v = iexp::stats::kurtosis(c + c2.cast<double>());
 }
 
+TEST_CASE("stat_moments")
+{
+    double g;
+
+    // offset data, a naive sum of squares would lose the variance
+    iexp::ArrayXd c = iexp::ArrayXd::Random(10007) * 3 + 1e6;
+    iexp::stats::summary s = iexp::stats::moments(c);
+    REQUIRE(s.size() == 10007);
+    REQUIRE(__D_EQ_IN(s.sum(), c.sum(), 1e-3));
+    REQUIRE(s.min() == c.minCoeff());
+    REQUIRE(s.max() == c.maxCoeff());
+
+    g = gsl_stats_mean(c.data(), 1, c.size());
+    REQUIRE(__D_EQ_IN(s.mean(), g, 1e-7));
+    g = gsl_stats_variance(c.data(), 1, c.size());
+    REQUIRE(__D_EQ_IN(s.var(), g, 1e-9));
+    g = gsl_stats_sd(c.data(), 1, c.size());
+    REQUIRE(__D_EQ_IN(s.std(), g, 1e-9));
+    g = gsl_stats_skew(c.data(), 1, c.size());
+    REQUIRE(__D_EQ_IN(s.skewness(), g, 1e-9));
+    g = gsl_stats_kurtosis(c.data(), 1, c.size());
+    REQUIRE(__D_EQ_IN(s.kurtosis(), g, 1e-9));
+
+    // merged halves
+    iexp::stats::summary s1 = iexp::stats::moments(c.head(3000));
+    s1.merge(iexp::stats::moments(c.tail(7007)));
+    REQUIRE(s1.size() == s.size());
+    REQUIRE(__D_EQ_IN(s1.var(), s.var(), 1e-9));
+    REQUIRE(__D_EQ_IN(s1.skewness(), s.skewness(), 1e-9));
+    REQUIRE(__D_EQ_IN(s1.kurtosis(), s.kurtosis(), 1e-9));
+
+    iexp::ArrayXi c2 = iexp::ArrayXi::Random(100);
+    s = iexp::stats::moments(c2);
+    g = gsl_stats_int_mean(c2.data(), 1, c2.size());
+    REQUIRE(__D_EQ_IN(s.mean(), g, 1e-3));
+
+    // compile
+    s = iexp::stats::moments(c + c2.cast<double>().sum());
+}
+
+TEST_CASE("stat_stride")
+{
+    double v, g;
+
+    // rows of a column major matrix are read in place with a stride
+    iexp::MatrixXd m = iexp::MatrixXd::Random(7, 11);
+    iexp::VectorXd r = m.row(3).transpose();
+    v = iexp::stats::mean(m.row(3));
+    g = gsl_stats_mean(r.data(), 1, r.size());
+    REQUIRE(__D_EQ_IN(v, g, 1e-12));
+    v = iexp::stats::var(m.row(3));
+    g = gsl_stats_variance(r.data(), 1, r.size());
+    REQUIRE(__D_EQ_IN(v, g, 1e-12));
+    v = iexp::stats::kurtosis(m.row(3));
+    g = gsl_stats_kurtosis(r.data(), 1, r.size());
+    REQUIRE(__D_EQ_IN(v, g, 1e-12));
+
+    iexp::VectorXd r2 = m.row(5).transpose();
+    v = iexp::stats::cov(m.row(3), m.row(5));
+    g = gsl_stats_covariance(r.data(), 1, r2.data(), 1, r.size());
+    REQUIRE(__D_EQ_IN(v, g, 1e-12));
+    v = iexp::stats::corrcoef(m.row(3), m.row(5));
+    g = gsl_stats_correlation(r.data(), 1, r2.data(), 1, r.size());
+    REQUIRE(__D_EQ_IN(v, g, 1e-12));
+    v = iexp::stats::wvar(m.row(3), m.row(5));
+    g = gsl_stats_wvariance(r2.data(), 1, r.data(), 1, r.size());
+    REQUIRE(__D_EQ_IN(v, g, 1e-12));
+
+    // strided map and segment
+    iexp::Map<iexp::VectorXd, 0, iexp::InnerStride<>> e(m.data(),
+                                                        38,
+                                                        iexp::InnerStride<>(2));
+    iexp::VectorXd ec = e;
+    v = iexp::stats::std(e);
+    g = gsl_stats_sd(ec.data(), 1, ec.size());
+    REQUIRE(__D_EQ_IN(v, g, 1e-12));
+    v = iexp::stats::tss(e.segment(3, 20));
+    g = gsl_stats_tss(ec.data() + 3, 1, 20);
+    REQUIRE(__D_EQ_IN(v, g, 1e-12));
+
+    // whole columns are contiguous, other blocks are copied
+    v = iexp::stats::mean(m.middleCols(2, 3));
+    g = gsl_stats_mean(m.data() + 14, 1, 21);
+    REQUIRE(__D_EQ_IN(v, g, 1e-12));
+    iexp::MatrixXd b = m.block(1, 1, 3, 4);
+    v = iexp::stats::skewness(m.block(1, 1, 3, 4));
+    g = gsl_stats_skew(b.data(), 1, b.size());
+    REQUIRE(__D_EQ_IN(v, g, 1e-12));
+}
+
+TEST_CASE("stat_colwise")
+{
+    // small column major, lines are contiguous
+    iexp::MatrixXd m = iexp::MatrixXd::Random(21, 6);
+    iexp::RowVectorXd c;
+    c = iexp::stats::colwise(m).mean();
+    REQUIRE(c.size() == 6);
+    for (int j = 0; j < 6; ++j) {
+        REQUIRE(__D_EQ_IN(c[j], iexp::stats::mean(m.col(j)), 1e-12));
+    }
+    c = iexp::stats::colwise(m).var();
+    for (int j = 0; j < 6; ++j) {
+        REQUIRE(__D_EQ_IN(c[j], iexp::stats::var(m.col(j)), 1e-12));
+    }
+    c = iexp::stats::colwise(m).median();
+    for (int j = 0; j < 6; ++j) {
+        iexp::VectorXd s = m.col(j);
+        std::sort(s.data(), s.data() + s.size());
+        REQUIRE(__D_EQ_IN(c[j], iexp::stats::median(s), 1e-12));
+        c[j] = iexp::stats::colwise(m).quantile(0.3)[j];
+        REQUIRE(__D_EQ_IN(c[j], iexp::stats::quantile(s, 0.3), 1e-12));
+    }
+
+    // row major and large enough to run in parallel: storage order walk
+    iexp::Matrix<double, iexp::Dynamic, iexp::Dynamic, iexp::RowMajor> r =
+        iexp::MatrixXd::Random(300, 517).array() * 2 + 1e3;
+    c = iexp::stats::colwise(r).std();
+    REQUIRE(c.size() == 517);
+    for (int j = 0; j < 517; j += 13) {
+        REQUIRE(__D_EQ_IN(c[j], iexp::stats::std(r.col(j)), 1e-9));
+    }
+    c = iexp::stats::colwise(r).quantile(0.3);
+    for (int j = 0; j < 517; j += 13) {
+        iexp::VectorXd s = r.col(j);
+        std::sort(s.data(), s.data() + s.size());
+        REQUIRE(__D_EQ_IN(c[j], iexp::stats::quantile(s, 0.3), 1e-12));
+    }
+    iexp::VectorXd v = iexp::stats::rowwise(r).mean();
+    REQUIRE(v.size() == 300);
+    for (int i = 0; i < 300; i += 7) {
+        REQUIRE(__D_EQ_IN(v[i], iexp::stats::mean(r.row(i)), 1e-9));
+    }
+    v = iexp::stats::rowwise(m.transpose()).median();
+    REQUIRE(__D_EQ_IN((v.transpose() - iexp::stats::colwise(m).median()).norm(),
+                      0,
+                      1e-15));
+
+    // expressions and blocks
+    c = iexp::stats::colwise(m.block(2, 1, 10, 3)).mean();
+    REQUIRE(__D_EQ_IN(c[1], iexp::stats::mean(m.col(2).segment(2, 10)), 1e-12));
+    c = iexp::stats::colwise(m * 2).var();
+    REQUIRE(__D_EQ_IN(c[3], 4 * iexp::stats::var(m.col(3)), 1e-12));
+
+    // the expression outlives the full expression that built it
+    auto cw = iexp::stats::colwise(m * 2);
+    c = cw.mean();
+    REQUIRE(__D_EQ_IN(c[3], 2 * iexp::stats::mean(m.col(3)), 1e-12));
+}
+
 TEST_CASE("stat_autocorr")
 {
     double v, g;
@@ -387,6 +542,75 @@ TEST_CASE("stat_cov")
     v = iexp::stats::cov(c + c2.cast<double>(), d + d2.cast<double>());
 }
 
+TEST_CASE("stat_cov_matrix")
+{
+    iexp::MatrixXd x = iexp::MatrixXd::Random(50, 6);
+    x.col(2) += x.col(0) * 0.5;
+    iexp::MatrixXd c = iexp::stats::cov_matrix(x);
+    iexp::MatrixXd r = iexp::stats::corr_matrix(x);
+    REQUIRE(c.rows() == 6);
+    REQUIRE(c.cols() == 6);
+    for (int i = 0; i < 6; ++i) {
+        for (int j = 0; j < 6; ++j) {
+            double g = iexp::stats::cov(x.col(i), x.col(j));
+            REQUIRE(__D_EQ_IN(c(i, j), g, 1e-12));
+            g = iexp::stats::corrcoef(x.col(i), x.col(j));
+            REQUIRE(__D_EQ_IN(r(i, j), g, 1e-12));
+        }
+    }
+
+    // weighted, the diagonal is gsl's weighted variance
+    iexp::VectorXd w = iexp::VectorXd::Random(50).cwiseAbs();
+    c = iexp::stats::cov_matrix(x, w);
+    for (int i = 0; i < 6; ++i) {
+        iexp::VectorXd xi = x.col(i);
+        REQUIRE(__D_EQ_IN(c(i, i), iexp::stats::wvar(xi, w), 1e-12));
+    }
+    r = iexp::stats::corr_matrix(x, w);
+    REQUIRE(__D_EQ_IN(r(1, 3), c(1, 3) / std::sqrt(c(1, 1) * c(3, 3)), 1e-12));
+
+    // pairwise complete
+    x(3, 1) = NAN;
+    x(7, 1) = NAN;
+    x(9, 4) = NAN;
+    c = iexp::stats::cov_matrix(x);
+    REQUIRE(std::isnan(c(1, 2)));
+    REQUIRE(!std::isnan(c(0, 2)));
+
+    c = iexp::stats::cov_matrix(x, iexp::stats::nan_mode::PAIRWISE);
+    r = iexp::stats::corr_matrix(x, iexp::stats::nan_mode::PAIRWISE);
+    for (int i = 0; i < 6; ++i) {
+        for (int j = 0; j < 6; ++j) {
+            std::vector<double> a, b;
+            for (int k = 0; k < 50; ++k) {
+                if (!std::isnan(x(k, i)) && !std::isnan(x(k, j))) {
+                    a.push_back(x(k, i));
+                    b.push_back(x(k, j));
+                }
+            }
+            double g = gsl_stats_covariance(a.data(), 1, b.data(), 1, a.size());
+            REQUIRE(__D_EQ_IN(c(i, j), g, 1e-12));
+            g = gsl_stats_correlation(a.data(), 1, b.data(), 1, a.size());
+            REQUIRE(__D_EQ_IN(r(i, j), g, 1e-12));
+        }
+    }
+
+    // the diagonal is 1 only for variables with a positive variance
+    r = iexp::stats::corr_matrix(x);
+    REQUIRE(std::isnan(r(1, 1)));
+    REQUIRE(r(0, 0) == 1);
+
+    x.col(5).setConstant(2);
+    x.col(3).setConstant(NAN);
+    x(0, 3) = 1;
+    r = iexp::stats::corr_matrix(x);
+    REQUIRE(std::isnan(r(5, 5)));
+    r = iexp::stats::corr_matrix(x, iexp::stats::nan_mode::PAIRWISE);
+    REQUIRE(std::isnan(r(5, 5)));
+    REQUIRE(std::isnan(r(3, 3)));
+    REQUIRE(r(1, 1) == 1);
+}
+
 TEST_CASE("stat_corrcoef")
 {
     double v, g;
@@ -462,3 +686,96 @@ TEST_CASE("stat_qunatile")
     g = gsl_stats_int_quantile_from_sorted_data(d2.data(), 1, d2.size(), 0.88);
     REQUIRE(__D_EQ_IN(v, g, 1e-9));
 }
+
+TEST_CASE("stat_select")
+{
+    double v, g;
+
+    for (int n : {1, 2, 7, 10, 1001}) {
+        iexp::ArrayXd c = iexp::ArrayXd::Random(n), s = c;
+        std::sort(s.data(), s.data() + s.size());
+
+        v = iexp::stats::median_select(c);
+        g = gsl_stats_median_from_sorted_data(s.data(), 1, s.size());
+        REQUIRE(__D_EQ_IN(v, g, 1e-15));
+
+        for (double f : {0.0, 0.01, 0.33, 0.9, 1.0}) {
+            v = iexp::stats::quantile_select(c, f);
+            g = gsl_stats_quantile_from_sorted_data(s.data(), 1, s.size(), f);
+            REQUIRE(__D_EQ_IN(v, g, 1e-15));
+        }
+
+        iexp::VectorXd f(7), q;
+        f << 0.01, 0.05, 0.25, 0.5, 0.75, 0.95, 0.99;
+        q = iexp::stats::quantiles(c, f);
+        REQUIRE(q.size() == 7);
+        for (int i = 0; i < 7; ++i) {
+            g = gsl_stats_quantile_from_sorted_data(s.data(),
+                                                    1,
+                                                    s.size(),
+                                                    f[i]);
+            REQUIRE(__D_EQ_IN(q[i], g, 1e-15));
+        }
+    }
+
+    // ties, integers and expressions
+    iexp::ArrayXi c2(6);
+    c2 << 3, 1, 3, 3, 2, 9;
+    REQUIRE(iexp::stats::median_select(c2) == 3);
+    REQUIRE(iexp::stats::quantile_select(c2, 0.1) == 1.5);
+    iexp::MatrixXd m = iexp::MatrixXd::Random(5, 4);
+    v = iexp::stats::median_select(m * 2);
+    REQUIRE(__D_EQ_IN(v, 2 * iexp::stats::median_select(m), 1e-15));
+}
+
+TEST_CASE("stat_reduce")
+{
+    double v, g;
+
+    // large enough for the parallel path, with an offset that a naive
+    // running sum would not survive
+    size_t n = iexp::stats::reduce::MIN_SIZE * 3 + 1234;
+    iexp::ArrayXd c = iexp::ArrayXd::Random(n) + 1e6;
+    iexp::ArrayXd d = iexp::ArrayXd::Random(n) * 3 - c * 0.5;
+
+    v = iexp::stats::mean(c);
+    g = gsl_stats_mean(c.data(), 1, n);
+    REQUIRE(__D_EQ_IN(v, g, 1e-9));
+    v = iexp::stats::var(c);
+    g = gsl_stats_variance(c.data(), 1, n);
+    REQUIRE(__D_EQ_IN(v, g, 1e-9));
+    v = iexp::stats::var(c, 1e6);
+    g = gsl_stats_variance_m(c.data(), 1, n, 1e6);
+    REQUIRE(__D_EQ_IN(v, g, 1e-9));
+    v = iexp::stats::std(c);
+    g = gsl_stats_sd(c.data(), 1, n);
+    REQUIRE(__D_EQ_IN(v, g, 1e-9));
+    v = iexp::stats::tss(c);
+    g = gsl_stats_tss(c.data(), 1, n);
+    REQUIRE(__D_EQ_IN(v / n, g / n, 1e-9));
+    v = iexp::stats::abstd(c);
+    g = gsl_stats_absdev(c.data(), 1, n);
+    REQUIRE(__D_EQ_IN(v, g, 1e-9));
+    v = iexp::stats::cov(c, d);
+    g = gsl_stats_covariance(c.data(), 1, d.data(), 1, n);
+    REQUIRE(__D_EQ_IN(v, g, 1e-9));
+    v = iexp::stats::cov(c, d, 1e6, -5e5);
+    g = gsl_stats_covariance_m(c.data(), 1, d.data(), 1, n, 1e6, -5e5);
+    REQUIRE(__D_EQ_IN(v, g, 1e-9));
+
+    // strided input
+    iexp::Map<iexp::ArrayXd, 0, iexp::InnerStride<>> e(c.data(),
+                                                       n / 2,
+                                                       iexp::InnerStride<>(2));
+    v = iexp::stats::var(e);
+    g = gsl_stats_variance(c.data(), 2, n / 2);
+    REQUIRE(__D_EQ_IN(v, g, 1e-9));
+
+    // same result whatever the number of threads
+    iexp::parallel::concurrency(1);
+    double v1 = iexp::stats::var(c), c1 = iexp::stats::cov(c, d);
+    iexp::parallel::concurrency(4);
+    REQUIRE(iexp::stats::var(c) == v1);
+    REQUIRE(iexp::stats::cov(c, d) == c1);
+    iexp::parallel::concurrency(0);
+}